@@ -1,4 +1,5 @@
 #include "AST.hpp"
+#include "utils/Literal2Cpp.hpp"
 
 #include <visitor/ASTBaseVisitor.hpp>
 
@@ -17,6 +18,10 @@ void StrLiteralNode::accept(ASTBaseVisitor &visitor) const
 {
     visitor.visit(*this);
 }
+auto BytesLiteralNode::decode() const -> std::vector<uint8_t>
+{
+    return Literal2Cpp::hexDigits2CppBytes(hex_digits_);
+}
 void BytesLiteralNode::accept(ASTBaseVisitor &visitor) const
 {
     visitor.visit(*this);
@@ -1,17 +1,18 @@
 #ifndef AST_HPP
 #define AST_HPP
 
+#include "utils/StringInterner.hpp"
 #include "visitor/ASTBaseVisitor.hpp"
 #include <cstdint>
-#include <memory>
 #include <string>
-#include <utility>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace sonnx
 {
 
-enum class NodeType
+enum class NodeType : uint8_t
 {
     MODEL,
     NODE_LIST,
@@ -45,28 +46,76 @@ enum class DataType
     UNDEFINED
 };
 
+// Nodes are allocated in an ASTArena and released with it in bulk; they are never destroyed one
+// by one, which is why the destructor is not virtual and every node must be trivially destructible.
+// Children are non-owning pointers into the same arena.
 class ASTNode
 {
   public:
-    ASTNode() = default;
-    virtual ~ASTNode() = default;
     ASTNode(const ASTNode &) = delete;
     auto operator=(const ASTNode &) -> ASTNode & = delete;
     ASTNode(ASTNode &&) = delete;
     auto operator=(ASTNode &&) -> ASTNode & = delete;
-    [[nodiscard]] virtual auto getASTNodeType() const -> NodeType = 0;
+    // The tag is stored in the node, so checking it needs no virtual call
+    [[nodiscard]] auto getASTNodeType() const -> NodeType
+    {
+        return node_type_;
+    }
     virtual void accept(class ASTBaseVisitor &visitor) const = 0;
+
+  protected:
+    explicit ASTNode(NodeType node_type) : node_type_(node_type)
+    {
+    }
+    ~ASTNode() = default;
+
+  private:
+    NodeType node_type_;
 };
 
-class U32LiteralNode final : public ASTNode
+// The children of a list node: a view of a pointer array allocated in the arena
+class ASTNodeList
 {
   public:
-    explicit U32LiteralNode(uint32_t value) : value_(value)
+    using iterator = const ASTNode *const *;
+
+    ASTNodeList() = default;
+    ASTNodeList(const ASTNode *const *data, size_t size) : data_(data), size_(size)
+    {
+    }
+    [[nodiscard]] auto begin() const -> iterator
     {
+        return data_;
     }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    [[nodiscard]] auto end() const -> iterator
+    {
+        return data_ + size_;
+    }
+    [[nodiscard]] auto size() const -> size_t
+    {
+        return size_;
+    }
+    [[nodiscard]] auto empty() const -> bool
+    {
+        return size_ == 0;
+    }
+    [[nodiscard]] auto operator[](size_t index) const -> const ASTNode *
+    {
+        return data_[index];
+    }
+
+  private:
+    const ASTNode *const *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+class U32LiteralNode final : public ASTNode
+{
+  public:
+    static constexpr NodeType TYPE = NodeType::U32_LITERAL;
+
+    explicit U32LiteralNode(uint32_t value) : ASTNode(TYPE), value_(value)
     {
-        return NodeType::U32_LITERAL;
     }
     void accept(ASTBaseVisitor &visitor) const override;
     [[nodiscard]] auto getValue() const -> uint32_t
@@ -81,12 +130,10 @@ class U32LiteralNode final : public ASTNode
 class U64LiteralNode final : public ASTNode
 {
   public:
-    explicit U64LiteralNode(uint64_t value) : value_(value)
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::U64_LITERAL;
+
+    explicit U64LiteralNode(uint64_t value) : ASTNode(TYPE), value_(value)
     {
-        return NodeType::U64_LITERAL;
     }
     void accept(ASTBaseVisitor &visitor) const override;
     [[nodiscard]] auto getValue() const -> uint64_t
@@ -98,55 +145,63 @@ class U64LiteralNode final : public ASTNode
     uint64_t value_;
 };
 
+// The text lives in the StringInterner; id is its symbol there
 class StrLiteralNode final : public ASTNode
 {
   public:
-    explicit StrLiteralNode(std::string value) : value_(std::move(value))
+    static constexpr NodeType TYPE = NodeType::STR_LITERAL;
+
+    // value must be the interner's own copy of the text behind id
+    StrLiteralNode(SymbolId id, std::string_view value) : ASTNode(TYPE), id_(id), value_(value)
     {
     }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    void accept(ASTBaseVisitor &visitor) const override;
+    [[nodiscard]] auto getId() const -> SymbolId
     {
-        return NodeType::STR_LITERAL;
+        return id_;
     }
-    void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getValue() const -> std::string
+    [[nodiscard]] auto getValue() const -> std::string_view
     {
         return value_;
     }
 
   private:
-    std::string value_;
+    SymbolId id_;
+    std::string_view value_;
 };
 
+// Holds the hex digits of a raw_data literal in place in the model source, without the trailing 'b'.
+// The bytes are only decoded when a consumer asks for them, so the source must outlive the AST.
 class BytesLiteralNode final : public ASTNode
 {
   public:
-    explicit BytesLiteralNode(std::vector<uint8_t> value) : value_(std::move(value))
+    static constexpr NodeType TYPE = NodeType::BYTES_LITERAL;
+
+    explicit BytesLiteralNode(std::string_view hex_digits) : ASTNode(TYPE), hex_digits_(hex_digits)
     {
     }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    void accept(ASTBaseVisitor &visitor) const override;
+    [[nodiscard]] auto getHexDigits() const -> std::string_view
     {
-        return NodeType::BYTES_LITERAL;
+        return hex_digits_;
     }
-    void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getValue() const -> const std::vector<uint8_t> &
+    [[nodiscard]] auto getByteCount() const -> size_t
     {
-        return value_;
+        return hex_digits_.size() / 2;
     }
+    [[nodiscard]] auto decode() const -> std::vector<uint8_t>;
 
   private:
-    std::vector<uint8_t> value_;
+    std::string_view hex_digits_;
 };
 
 class TypeEnumNode final : public ASTNode
 {
   public:
-    explicit TypeEnumNode(DataType type) : value_(type)
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::TYPE_ENUM;
+
+    explicit TypeEnumNode(DataType type) : ASTNode(TYPE), value_(type)
     {
-        return NodeType::TYPE_ENUM;
     }
     void accept(ASTBaseVisitor &visitor) const override;
     [[nodiscard]] auto getValue() const -> DataType
@@ -161,432 +216,426 @@ class TypeEnumNode final : public ASTNode
 class ModelNode final : public ASTNode
 {
   public:
-    ModelNode(std::unique_ptr<ASTNode> ir_version, std::unique_ptr<ASTNode> producer_name,
-              std::unique_ptr<ASTNode> producer_version, std::unique_ptr<ASTNode> model_domain,
-              std::unique_ptr<ASTNode> model_version, std::unique_ptr<ASTNode> doc_string,
-              std::unique_ptr<ASTNode> graph_name, std::unique_ptr<ASTNode> node_list,
-              std::unique_ptr<ASTNode> input_list, std::unique_ptr<ASTNode> output_list,
-              std::unique_ptr<ASTNode> initializer_list, std::unique_ptr<ASTNode> opset_domain,
-              std::unique_ptr<ASTNode> opset_version)
-        : ir_version_(std::move(ir_version)), producer_name_(std::move(producer_name)),
-          producer_version_(std::move(producer_version)), model_domain_(std::move(model_domain)),
-          model_version_(std::move(model_version)), doc_string_(std::move(doc_string)),
-          graph_name_(std::move(graph_name)), node_list_(std::move(node_list)), input_list_(std::move(input_list)),
-          output_list_(std::move(output_list)), initializer_list_(std::move(initializer_list)),
-          opset_domain_(std::move(opset_domain)), opset_version_(std::move(opset_version))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::MODEL;
+
+    ModelNode(const ASTNode *ir_version, const ASTNode *producer_name, const ASTNode *producer_version,
+              const ASTNode *model_domain, const ASTNode *model_version, const ASTNode *doc_string,
+              const ASTNode *graph_name, const ASTNode *node_list, const ASTNode *input_list,
+              const ASTNode *output_list, const ASTNode *initializer_list, const ASTNode *opset_domain,
+              const ASTNode *opset_version)
+        : ASTNode(TYPE), ir_version_(ir_version), producer_name_(producer_name), producer_version_(producer_version),
+          model_domain_(model_domain), model_version_(model_version), doc_string_(doc_string),
+          graph_name_(graph_name), node_list_(node_list), input_list_(input_list), output_list_(output_list),
+          initializer_list_(initializer_list), opset_domain_(opset_domain), opset_version_(opset_version)
     {
-        return NodeType::MODEL;
     }
     void accept(ASTBaseVisitor &visitor) const override;
 
     [[nodiscard]] auto getIrVersion() const -> const ASTNode *
     {
-        return ir_version_.get();
+        return ir_version_;
     }
     [[nodiscard]] auto getProducerName() const -> const ASTNode *
     {
-        return producer_name_.get();
+        return producer_name_;
     }
     [[nodiscard]] auto getProducerVersion() const -> const ASTNode *
     {
-        return producer_version_.get();
+        return producer_version_;
     }
     [[nodiscard]] auto getDomain() const -> const ASTNode *
     {
-        return model_domain_.get();
+        return model_domain_;
     }
     [[nodiscard]] auto getModelVersion() const -> const ASTNode *
     {
-        return model_version_.get();
+        return model_version_;
     }
     [[nodiscard]] auto getDocString() const -> const ASTNode *
     {
-        return doc_string_.get();
+        return doc_string_;
     }
     [[nodiscard]] auto getGraphName() const -> const ASTNode *
     {
-        return graph_name_.get();
+        return graph_name_;
     }
     [[nodiscard]] auto getNodeList() const -> const ASTNode *
     {
-        return node_list_.get();
+        return node_list_;
     }
     [[nodiscard]] auto getInputList() const -> const ASTNode *
     {
-        return input_list_.get();
+        return input_list_;
     }
     [[nodiscard]] auto getOutputList() const -> const ASTNode *
     {
-        return output_list_.get();
+        return output_list_;
     }
     [[nodiscard]] auto getInitializerList() const -> const ASTNode *
     {
-        return initializer_list_.get();
+        return initializer_list_;
     }
     [[nodiscard]] auto getOpsetDomain() const -> const ASTNode *
     {
-        return opset_domain_.get();
+        return opset_domain_;
     }
     [[nodiscard]] auto getOpsetVersion() const -> const ASTNode *
     {
-        return opset_version_.get();
+        return opset_version_;
     }
 
   private:
-    std::unique_ptr<ASTNode> ir_version_;
-    std::unique_ptr<ASTNode> producer_name_;
-    std::unique_ptr<ASTNode> producer_version_;
-    std::unique_ptr<ASTNode> model_domain_;
-    std::unique_ptr<ASTNode> model_version_;
-    std::unique_ptr<ASTNode> doc_string_;
-    std::unique_ptr<ASTNode> graph_name_;
-    std::unique_ptr<ASTNode> node_list_;
-    std::unique_ptr<ASTNode> input_list_;
-    std::unique_ptr<ASTNode> output_list_;
-    std::unique_ptr<ASTNode> initializer_list_;
-    std::unique_ptr<ASTNode> opset_domain_;
-    std::unique_ptr<ASTNode> opset_version_;
+    const ASTNode *ir_version_;
+    const ASTNode *producer_name_;
+    const ASTNode *producer_version_;
+    const ASTNode *model_domain_;
+    const ASTNode *model_version_;
+    const ASTNode *doc_string_;
+    const ASTNode *graph_name_;
+    const ASTNode *node_list_;
+    const ASTNode *input_list_;
+    const ASTNode *output_list_;
+    const ASTNode *initializer_list_;
+    const ASTNode *opset_domain_;
+    const ASTNode *opset_version_;
 };
 
 class NodeListNode final : public ASTNode
 {
   public:
-    explicit NodeListNode(std::vector<std::unique_ptr<ASTNode>> nodes) : nodes_(std::move(nodes))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::NODE_LIST;
+
+    explicit NodeListNode(ASTNodeList nodes) : ASTNode(TYPE), nodes_(nodes)
     {
-        return NodeType::NODE_LIST;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getNodes() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getNodes() const -> ASTNodeList
     {
         return nodes_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> nodes_;
+    ASTNodeList nodes_;
 };
 
 class InputListNode final : public ASTNode
 {
   public:
-    explicit InputListNode(std::vector<std::unique_ptr<ASTNode>> io_tensors) : io_tensors_(std::move(io_tensors))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::INPUT_LIST;
+
+    explicit InputListNode(ASTNodeList io_tensors) : ASTNode(TYPE), io_tensors_(io_tensors)
     {
-        return NodeType::INPUT_LIST;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getIOTensors() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getIOTensors() const -> ASTNodeList
     {
         return io_tensors_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> io_tensors_;
+    ASTNodeList io_tensors_;
 };
 
 class OutputListNode final : public ASTNode
 {
   public:
-    explicit OutputListNode(std::vector<std::unique_ptr<ASTNode>> io_tensors) : io_tensors_(std::move(io_tensors))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::OUTPUT_LIST;
+
+    explicit OutputListNode(ASTNodeList io_tensors) : ASTNode(TYPE), io_tensors_(io_tensors)
     {
-        return NodeType::OUTPUT_LIST;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getIOTensors() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getIOTensors() const -> ASTNodeList
     {
         return io_tensors_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> io_tensors_;
+    ASTNodeList io_tensors_;
 };
 
 class InitializerListNode final : public ASTNode
 {
   public:
-    explicit InitializerListNode(std::vector<std::unique_ptr<ASTNode>> init_tensors)
-        : init_tensors_(std::move(init_tensors))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::INITIALIZER_LIST;
+
+    explicit InitializerListNode(ASTNodeList init_tensors) : ASTNode(TYPE), init_tensors_(init_tensors)
     {
-        return NodeType::INITIALIZER_LIST;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getInitTensors() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getInitTensors() const -> ASTNodeList
     {
         return init_tensors_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> init_tensors_;
+    ASTNodeList init_tensors_;
 };
 
 class NodeNode final : public ASTNode
 {
   public:
-    NodeNode(std::unique_ptr<ASTNode> op_type, std::unique_ptr<ASTNode> name,
-             std::unique_ptr<ASTNode> input_list_or_array, std::unique_ptr<ASTNode> output_list_or_array,
-             std::unique_ptr<ASTNode> attribute_list)
-        : op_type_(std::move(op_type)), name_(std::move(name)), input_list_or_array_(std::move(input_list_or_array)),
-          output_list_or_array_(std::move(output_list_or_array)), attribute_list_(std::move(attribute_list))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::NODE;
+
+    NodeNode(const ASTNode *op_type, const ASTNode *name, const ASTNode *input_list_or_array,
+             const ASTNode *output_list_or_array, const ASTNode *attribute_list)
+        : ASTNode(TYPE), op_type_(op_type), name_(name), input_list_or_array_(input_list_or_array),
+          output_list_or_array_(output_list_or_array), attribute_list_(attribute_list)
     {
-        return NodeType::NODE;
     }
     void accept(ASTBaseVisitor &visitor) const override;
 
     [[nodiscard]] auto getOpType() const -> const ASTNode *
     {
-        return op_type_.get();
+        return op_type_;
     }
     [[nodiscard]] auto getName() const -> const ASTNode *
     {
-        return name_.get();
+        return name_;
     }
     [[nodiscard]] auto getInputListOrArray() const -> const ASTNode *
     {
-        return input_list_or_array_.get();
+        return input_list_or_array_;
     }
     [[nodiscard]] auto getOutputListOrArray() const -> const ASTNode *
     {
-        return output_list_or_array_.get();
+        return output_list_or_array_;
     }
     [[nodiscard]] auto getAttributeList() const -> const ASTNode *
     {
-        return attribute_list_.get();
+        return attribute_list_;
     }
 
   private:
-    std::unique_ptr<ASTNode> op_type_;
-    std::unique_ptr<ASTNode> name_;
-    std::unique_ptr<ASTNode> input_list_or_array_;
-    std::unique_ptr<ASTNode> output_list_or_array_;
-    std::unique_ptr<ASTNode> attribute_list_;
+    const ASTNode *op_type_;
+    const ASTNode *name_;
+    const ASTNode *input_list_or_array_;
+    const ASTNode *output_list_or_array_;
+    const ASTNode *attribute_list_;
 };
 
 class InputArrNode final : public ASTNode
 {
   public:
-    explicit InputArrNode(std::vector<std::unique_ptr<ASTNode>> input_elements)
-        : input_elements_(std::move(input_elements))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::INPUT_ARR;
+
+    explicit InputArrNode(ASTNodeList input_elements) : ASTNode(TYPE), input_elements_(input_elements)
     {
-        return NodeType::INPUT_ARR;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getInputElements() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getInputElements() const -> ASTNodeList
     {
         return input_elements_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> input_elements_;
+    ASTNodeList input_elements_;
 };
 
 class OutputArrNode final : public ASTNode
 {
   public:
-    explicit OutputArrNode(std::vector<std::unique_ptr<ASTNode>> output_elements)
-        : output_elements_(std::move(output_elements))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::OUTPUT_ARR;
+
+    explicit OutputArrNode(ASTNodeList output_elements) : ASTNode(TYPE), output_elements_(output_elements)
     {
-        return NodeType::OUTPUT_ARR;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getOutputElements() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getOutputElements() const -> ASTNodeList
     {
         return output_elements_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> output_elements_;
+    ASTNodeList output_elements_;
 };
 
 class AttributeListNode final : public ASTNode
 {
   public:
-    explicit AttributeListNode(std::vector<std::unique_ptr<ASTNode>> attributes) : attributes_(std::move(attributes))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::ATTRIBUTE_LIST;
+
+    explicit AttributeListNode(ASTNodeList attributes) : ASTNode(TYPE), attributes_(attributes)
     {
-        return NodeType::ATTRIBUTE_LIST;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getAttributes() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getAttributes() const -> ASTNodeList
     {
         return attributes_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> attributes_;
+    ASTNodeList attributes_;
 };
 
 class AttributeNode final : public ASTNode
 {
   public:
-    AttributeNode(std::unique_ptr<ASTNode> name, std::unique_ptr<ASTNode> value)
-        : name_(std::move(name)), value_(std::move(value))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::ATTRIBUTE;
+
+    AttributeNode(const ASTNode *name, const ASTNode *value) : ASTNode(TYPE), name_(name), value_(value)
     {
-        return NodeType::ATTRIBUTE;
     }
     void accept(ASTBaseVisitor &visitor) const override;
 
     [[nodiscard]] auto getName() const -> const ASTNode *
     {
-        return name_.get();
+        return name_;
     }
     [[nodiscard]] auto getValue() const -> const ASTNode *
     {
-        return value_.get();
+        return value_;
     }
 
   private:
-    std::unique_ptr<ASTNode> name_;
-    std::unique_ptr<ASTNode> value_;
+    const ASTNode *name_;
+    const ASTNode *value_;
 };
 
 class IOTensorNode final : public ASTNode
 {
   public:
-    IOTensorNode(std::unique_ptr<ASTNode> name, std::unique_ptr<ASTNode> type, std::unique_ptr<ASTNode> io_shape)
-        : name_(std::move(name)), type_(std::move(type)), io_shape_(std::move(io_shape))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::IO_TENSOR;
+
+    IOTensorNode(const ASTNode *name, const ASTNode *type, const ASTNode *io_shape)
+        : ASTNode(TYPE), name_(name), type_(type), io_shape_(io_shape)
     {
-        return NodeType::IO_TENSOR;
     }
     void accept(ASTBaseVisitor &visitor) const override;
 
     [[nodiscard]] auto getName() const -> const ASTNode *
     {
-        return name_.get();
+        return name_;
     }
     [[nodiscard]] auto getType() const -> const ASTNode *
     {
-        return type_.get();
+        return type_;
     }
     [[nodiscard]] auto getIOShape() const -> const ASTNode *
     {
-        return io_shape_.get();
+        return io_shape_;
     }
 
   private:
-    std::unique_ptr<ASTNode> name_;
-    std::unique_ptr<ASTNode> type_;
-    std::unique_ptr<ASTNode> io_shape_;
+    const ASTNode *name_;
+    const ASTNode *type_;
+    const ASTNode *io_shape_;
 };
 
 class IOShapeNode final : public ASTNode
 {
   public:
-    explicit IOShapeNode(std::vector<std::unique_ptr<ASTNode>> io_dims) : io_dims_(std::move(io_dims))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::IO_SHAPE;
+
+    explicit IOShapeNode(ASTNodeList io_dims) : ASTNode(TYPE), io_dims_(io_dims)
     {
-        return NodeType::IO_SHAPE;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getIODims() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getIODims() const -> ASTNodeList
     {
         return io_dims_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> io_dims_;
+    ASTNodeList io_dims_;
 };
 
 class InitTensorNode final : public ASTNode
 {
   public:
-    InitTensorNode(std::unique_ptr<ASTNode> name, std::unique_ptr<ASTNode> type, std::unique_ptr<ASTNode> init_shape,
-                   std::unique_ptr<ASTNode> raw_data)
-        : name_(std::move(name)), type_(std::move(type)), init_shape_(std::move(init_shape)),
-          raw_data_(std::move(raw_data))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::INIT_TENSOR;
+
+    InitTensorNode(const ASTNode *name, const ASTNode *type, const ASTNode *init_shape, const ASTNode *raw_data)
+        : ASTNode(TYPE), name_(name), type_(type), init_shape_(init_shape), raw_data_(raw_data)
     {
-        return NodeType::INIT_TENSOR;
     }
     void accept(ASTBaseVisitor &visitor) const override;
 
     [[nodiscard]] auto getName() const -> const ASTNode *
     {
-        return name_.get();
+        return name_;
     }
     [[nodiscard]] auto getType() const -> const ASTNode *
     {
-        return type_.get();
+        return type_;
     }
     [[nodiscard]] auto getInitShape() const -> const ASTNode *
     {
-        return init_shape_.get();
+        return init_shape_;
     }
     [[nodiscard]] auto getRawData() const -> const ASTNode *
     {
-        return raw_data_.get();
+        return raw_data_;
     }
 
   private:
-    std::unique_ptr<ASTNode> name_;
-    std::unique_ptr<ASTNode> type_;
-    std::unique_ptr<ASTNode> init_shape_;
-    std::unique_ptr<ASTNode> raw_data_;
+    const ASTNode *name_;
+    const ASTNode *type_;
+    const ASTNode *init_shape_;
+    const ASTNode *raw_data_;
 };
 
 class InitShapeNode final : public ASTNode
 {
   public:
-    explicit InitShapeNode(std::vector<std::unique_ptr<ASTNode>> dim_values) : dim_values_(std::move(dim_values))
-    {
-    }
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::INIT_SHAPE;
+
+    explicit InitShapeNode(ASTNodeList dim_values) : ASTNode(TYPE), dim_values_(dim_values)
     {
-        return NodeType::INIT_SHAPE;
     }
     void accept(ASTBaseVisitor &visitor) const override;
-    [[nodiscard]] auto getDimValues() const -> const std::vector<std::unique_ptr<ASTNode>> &
+    [[nodiscard]] auto getDimValues() const -> ASTNodeList
     {
         return dim_values_;
     }
 
   private:
-    std::vector<std::unique_ptr<ASTNode>> dim_values_;
+    ASTNodeList dim_values_;
 };
 
 class ErrorNode final : public ASTNode
 {
   public:
-    [[nodiscard]] auto getASTNodeType() const -> NodeType override
+    static constexpr NodeType TYPE = NodeType::ERROR_NODE;
+
+    ErrorNode() : ASTNode(TYPE)
     {
-        return NodeType::ERROR_NODE;
     }
     void accept(ASTBaseVisitor &visitor) const override;
 };
 
+// Every concrete node class with its tag (IO_DIM has no class of its own). The static visitor and
+// any other per-class table are expanded from this list, so adding a node class means adding it here.
+#define SONNX_AST_NODE_CLASSES(X)                                                                                      \
+    X(U32_LITERAL, U32LiteralNode)                                                                                     \
+    X(U64_LITERAL, U64LiteralNode)                                                                                     \
+    X(STR_LITERAL, StrLiteralNode)                                                                                     \
+    X(BYTES_LITERAL, BytesLiteralNode)                                                                                 \
+    X(TYPE_ENUM, TypeEnumNode)                                                                                         \
+    X(MODEL, ModelNode)                                                                                                \
+    X(NODE_LIST, NodeListNode)                                                                                         \
+    X(INPUT_LIST, InputListNode)                                                                                       \
+    X(OUTPUT_LIST, OutputListNode)                                                                                     \
+    X(INITIALIZER_LIST, InitializerListNode)                                                                           \
+    X(NODE, NodeNode)                                                                                                  \
+    X(INPUT_ARR, InputArrNode)                                                                                         \
+    X(OUTPUT_ARR, OutputArrNode)                                                                                       \
+    X(ATTRIBUTE_LIST, AttributeListNode)                                                                               \
+    X(ATTRIBUTE, AttributeNode)                                                                                        \
+    X(IO_TENSOR, IOTensorNode)                                                                                         \
+    X(IO_SHAPE, IOShapeNode)                                                                                           \
+    X(INIT_TENSOR, InitTensorNode)                                                                                     \
+    X(INIT_SHAPE, InitShapeNode)                                                                                       \
+    X(ERROR_NODE, ErrorNode)
+
+// Checked downcast: a tag compare and a static_cast instead of a dynamic_cast; null if node is null or of
+// another class
+template <typename T> auto astCast(const ASTNode *node) -> const T *
+{
+    static_assert(std::is_base_of_v<ASTNode, T>, "astCast only casts to AST node classes");
+    return node != nullptr && node->getASTNodeType() == T::TYPE ? static_cast<const T *>(node) : nullptr;
+}
+
 } // namespace sonnx
 
 #endif // AST_HPP
@@ -0,0 +1,31 @@
+#include "ASTArena.hpp"
+#include <algorithm>
+
+namespace sonnx
+{
+
+auto ASTArena::makeList(const std::vector<ASTNode *> &nodes) -> ASTNodeList
+{
+    if (nodes.empty())
+    {
+        return {};
+    }
+    auto *data = static_cast<const ASTNode **>(allocate(nodes.size() * sizeof(ASTNode *), alignof(ASTNode *)));
+    std::copy(nodes.begin(), nodes.end(), data);
+    return {data, nodes.size()};
+}
+
+auto ASTArena::allocateInNewChunk(size_t size, size_t alignment) -> void *
+{
+    // Chunks grow geometrically so small models stay small and large ones need few chunks;
+    // an oversized request gets a chunk of its own size
+    const auto chunk_size = std::max(next_chunk_size_, size + alignment);
+    next_chunk_size_ = std::min(next_chunk_size_ * 2, MAX_CHUNK_SIZE);
+    // Not value-initialized: every byte handed out is constructed over
+    chunks_.emplace_back(new std::byte[chunk_size]);
+    cursor_ = chunks_.back().get();
+    limit_ = cursor_ + chunk_size;
+    return allocate(size, alignment);
+}
+
+} // namespace sonnx
@@ -0,0 +1,81 @@
+#ifndef AST_ARENA_HPP
+#define AST_ARENA_HPP
+
+#include "AST.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sonnx
+{
+
+// Bump allocator that owns every node and child list of one AST (names live in the StringInterner).
+// Allocation is a pointer increment inside the current chunk; nothing is freed until the
+// arena itself goes away, at which point all chunks are released without visiting a single node.
+class ASTArena
+{
+  public:
+    ASTArena() = default;
+    ASTArena(const ASTArena &) = delete;
+    auto operator=(const ASTArena &) -> ASTArena & = delete;
+    ASTArena(ASTArena &&) = delete;
+    auto operator=(ASTArena &&) -> ASTArena & = delete;
+    ~ASTArena() = default;
+
+    template <typename T, typename... Args> auto make(Args &&...args) -> T *
+    {
+        static_assert(std::is_base_of_v<ASTNode, T>, "the arena only holds AST nodes");
+        static_assert(std::is_trivially_destructible_v<T>, "arena nodes are released without running destructors");
+        ++node_count_;
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copies the children into the arena
+    auto makeList(const std::vector<ASTNode *> &nodes) -> ASTNodeList;
+
+    [[nodiscard]] auto getNodeCount() const -> size_t
+    {
+        return node_count_;
+    }
+    [[nodiscard]] auto getChunkCount() const -> size_t
+    {
+        return chunks_.size();
+    }
+    [[nodiscard]] auto getBytesAllocated() const -> size_t
+    {
+        return bytes_allocated_;
+    }
+
+  private:
+    static constexpr size_t FIRST_CHUNK_SIZE = 16 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::byte *cursor_ = nullptr;
+    std::byte *limit_ = nullptr;
+    size_t next_chunk_size_ = FIRST_CHUNK_SIZE;
+    size_t node_count_ = 0;
+    size_t bytes_allocated_ = 0;
+
+    auto allocate(size_t size, size_t alignment) -> void *
+    {
+        const auto address = reinterpret_cast<uintptr_t>(cursor_);
+        const auto aligned = (address + alignment - 1) & ~(alignment - 1);
+        if (aligned + size > reinterpret_cast<uintptr_t>(limit_))
+        {
+            return allocateInNewChunk(size, alignment);
+        }
+        cursor_ += aligned - address + size;
+        bytes_allocated_ += size;
+        return reinterpret_cast<void *>(aligned);
+    }
+    auto allocateInNewChunk(size_t size, size_t alignment) -> void *;
+};
+
+} // namespace sonnx
+
+#endif // AST_ARENA_HPP
@@ -0,0 +1,104 @@
+#ifndef AST_BUILDER_HPP
+#define AST_BUILDER_HPP
+
+#include "ASTArena.hpp"
+#include "FlatAST.hpp"
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sonnx
+{
+
+// Where the parsers put the AST. Both builders take the same calls, children before their parent:
+// make<X>(args...) with the arguments of X's constructor, and makeList<X>(children) for the list classes.
+// A parser templated on the builder therefore produces either representation in the same single pass.
+
+// Pointer tree in an ASTArena
+class TreeBuilder
+{
+  public:
+    using Ref = ASTNode *;
+    // An optional child that is absent
+    static constexpr Ref NONE = nullptr;
+
+    explicit TreeBuilder(ASTArena &arena) : arena_(arena)
+    {
+    }
+
+    template <typename T, typename... Args> auto make(Args &&...args) -> Ref
+    {
+        return arena_.make<T>(std::forward<Args>(args)...);
+    }
+    template <typename T> auto makeList(const std::vector<Ref> &children) -> Ref
+    {
+        return arena_.make<T>(arena_.makeList(children));
+    }
+
+  private:
+    ASTArena &arena_;
+};
+
+// FlatAST, appended in post-order, so the result is the same as FlatAST::fromTree on the tree
+class FlatBuilder
+{
+  public:
+    using Ref = FlatAST::Index;
+    static constexpr Ref NONE = FlatAST::NONE;
+
+    explicit FlatBuilder(FlatAST &flat) : flat_(flat)
+    {
+    }
+
+    template <typename T, typename... Args> auto make(Args &&...args) -> Ref
+    {
+        if constexpr (std::is_same_v<T, U32LiteralNode>)
+        {
+            return flat_.addU32(args...);
+        }
+        else if constexpr (std::is_same_v<T, U64LiteralNode>)
+        {
+            return flat_.addU64(args...);
+        }
+        else if constexpr (std::is_same_v<T, StrLiteralNode>)
+        {
+            // The text is the interner's; the flat form only keeps the id
+            return addStr(args...);
+        }
+        else if constexpr (std::is_same_v<T, BytesLiteralNode>)
+        {
+            return flat_.addBytes(args...);
+        }
+        else if constexpr (std::is_same_v<T, TypeEnumNode>)
+        {
+            return flat_.addTypeEnum(args...);
+        }
+        else if constexpr (std::is_same_v<T, ErrorNode>)
+        {
+            return flat_.addError();
+        }
+        else
+        {
+            children_.assign({static_cast<Ref>(args)...});
+            return flat_.addNode(T::TYPE, children_);
+        }
+    }
+    template <typename T> auto makeList(const std::vector<Ref> &children) -> Ref
+    {
+        return flat_.addNode(T::TYPE, children);
+    }
+
+  private:
+    FlatAST &flat_;
+    std::vector<Ref> children_;
+
+    auto addStr(SymbolId id, std::string_view) -> Ref
+    {
+        return flat_.addStr(id);
+    }
+};
+
+} // namespace sonnx
+
+#endif // AST_BUILDER_HPP
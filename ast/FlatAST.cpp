@@ -0,0 +1,202 @@
+#include "FlatAST.hpp"
+#include "visitor/ASTStaticVisitor.hpp"
+#include <stdexcept>
+
+namespace sonnx
+{
+
+namespace
+{
+
+// Appends every node after its children, mirroring the order in which the parsers build the tree
+class Flattener final : public ASTStaticVisitor<Flattener>
+{
+  public:
+    explicit Flattener(FlatAST &flat) : flat_(flat)
+    {
+    }
+
+    auto flatten(const ASTNode *node) -> FlatAST::Index
+    {
+        if (node == nullptr)
+        {
+            return FlatAST::NONE;
+        }
+        dispatch(*node);
+        return last_;
+    }
+
+    void visit(const U32LiteralNode &node)
+    {
+        last_ = flat_.addU32(node.getValue());
+    }
+    void visit(const U64LiteralNode &node)
+    {
+        last_ = flat_.addU64(node.getValue());
+    }
+    void visit(const StrLiteralNode &node)
+    {
+        last_ = flat_.addStr(node.getId());
+    }
+    void visit(const BytesLiteralNode &node)
+    {
+        last_ = flat_.addBytes(node.getHexDigits());
+    }
+    void visit(const TypeEnumNode &node)
+    {
+        last_ = flat_.addTypeEnum(node.getValue());
+    }
+    void visit(const ErrorNode &)
+    {
+        last_ = flat_.addError();
+    }
+    void visit(const ModelNode &node)
+    {
+        addNode(node, {node.getIrVersion(), node.getProducerName(), node.getProducerVersion(), node.getDomain(),
+                       node.getModelVersion(), node.getDocString(), node.getGraphName(), node.getNodeList(),
+                       node.getInputList(), node.getOutputList(), node.getInitializerList(), node.getOpsetDomain(),
+                       node.getOpsetVersion()});
+    }
+    void visit(const NodeNode &node)
+    {
+        addNode(node, {node.getOpType(), node.getName(), node.getInputListOrArray(), node.getOutputListOrArray(),
+                       node.getAttributeList()});
+    }
+    void visit(const AttributeNode &node)
+    {
+        addNode(node, {node.getName(), node.getValue()});
+    }
+    void visit(const IOTensorNode &node)
+    {
+        addNode(node, {node.getName(), node.getType(), node.getIOShape()});
+    }
+    void visit(const InitTensorNode &node)
+    {
+        addNode(node, {node.getName(), node.getType(), node.getInitShape(), node.getRawData()});
+    }
+    void visit(const NodeListNode &node)
+    {
+        addList(node, node.getNodes());
+    }
+    void visit(const InputListNode &node)
+    {
+        addList(node, node.getIOTensors());
+    }
+    void visit(const OutputListNode &node)
+    {
+        addList(node, node.getIOTensors());
+    }
+    void visit(const InitializerListNode &node)
+    {
+        addList(node, node.getInitTensors());
+    }
+    void visit(const InputArrNode &node)
+    {
+        addList(node, node.getInputElements());
+    }
+    void visit(const OutputArrNode &node)
+    {
+        addList(node, node.getOutputElements());
+    }
+    void visit(const AttributeListNode &node)
+    {
+        addList(node, node.getAttributes());
+    }
+    void visit(const IOShapeNode &node)
+    {
+        addList(node, node.getIODims());
+    }
+    void visit(const InitShapeNode &node)
+    {
+        addList(node, node.getDimValues());
+    }
+
+  private:
+    FlatAST &flat_;
+    FlatAST::Index last_ = FlatAST::NONE;
+
+    void addNode(const ASTNode &node, std::initializer_list<const ASTNode *> children)
+    {
+        std::vector<FlatAST::Index> indices;
+        indices.reserve(children.size());
+        for (const auto *child : children)
+        {
+            indices.push_back(flatten(child));
+        }
+        last_ = flat_.addNode(node.getASTNodeType(), indices);
+    }
+    void addList(const ASTNode &node, ASTNodeList children)
+    {
+        std::vector<FlatAST::Index> indices;
+        indices.reserve(children.size());
+        for (const auto *child : children)
+        {
+            indices.push_back(flatten(child));
+        }
+        last_ = flat_.addNode(node.getASTNodeType(), indices);
+    }
+};
+
+} // namespace
+
+auto FlatAST::fromTree(const ASTNode &root) -> FlatAST
+{
+    FlatAST flat;
+    Flattener(flat).flatten(&root);
+    return flat;
+}
+
+auto FlatAST::addLeaf(NodeType kind, uint32_t payload) -> Index
+{
+    if (kinds_.size() >= NONE)
+    {
+        throw std::length_error("AST too large for 32-bit node indices");
+    }
+    kinds_.push_back(kind);
+    first_child_.push_back(static_cast<uint32_t>(children_.size()));
+    child_count_.push_back(0);
+    payload_.push_back(payload);
+    return static_cast<Index>(kinds_.size() - 1);
+}
+
+auto FlatAST::addU32(uint32_t value) -> Index
+{
+    return addLeaf(NodeType::U32_LITERAL, value);
+}
+
+auto FlatAST::addU64(uint64_t value) -> Index
+{
+    integers_.push_back(value);
+    return addLeaf(NodeType::U64_LITERAL, static_cast<uint32_t>(integers_.size() - 1));
+}
+
+auto FlatAST::addStr(SymbolId id) -> Index
+{
+    return addLeaf(NodeType::STR_LITERAL, id);
+}
+
+auto FlatAST::addBytes(std::string_view hex_digits) -> Index
+{
+    hex_digits_.push_back(hex_digits);
+    return addLeaf(NodeType::BYTES_LITERAL, static_cast<uint32_t>(hex_digits_.size() - 1));
+}
+
+auto FlatAST::addTypeEnum(DataType type) -> Index
+{
+    return addLeaf(NodeType::TYPE_ENUM, static_cast<uint32_t>(type));
+}
+
+auto FlatAST::addError() -> Index
+{
+    return addLeaf(NodeType::ERROR_NODE, 0);
+}
+
+auto FlatAST::addNode(NodeType kind, const std::vector<Index> &children) -> Index
+{
+    const auto node = addLeaf(kind, 0);
+    child_count_[node] = static_cast<uint32_t>(children.size());
+    children_.insert(children_.end(), children.begin(), children.end());
+    return node;
+}
+
+} // namespace sonnx
@@ -0,0 +1,144 @@
+#ifndef FLAT_AST_HPP
+#define FLAT_AST_HPP
+
+#include "AST.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sonnx
+{
+
+// Structure-of-arrays encoding of an AST. Node i is described by kinds_[i], first_child_[i],
+// child_count_[i] and payload_[i]; the children of a node are a contiguous run of children_, and
+// literal values live in side tables reached through the payload. Nodes are stored in post-order,
+// so the root is the last node and walking a node list is a scan over consecutive entries of children_
+// instead of a pointer hop per element.
+class FlatAST
+{
+  public:
+    using Index = uint32_t;
+    // Child slot of an optional child that is absent (no initializer list, no attribute list)
+    static constexpr Index NONE = UINT32_MAX;
+
+    // Child positions of the fixed-arity kinds, in constructor order of the tree nodes
+    static constexpr size_t MODEL_NODE_LIST = 7;
+    static constexpr size_t MODEL_INPUT_LIST = 8;
+    static constexpr size_t MODEL_OUTPUT_LIST = 9;
+    static constexpr size_t MODEL_INITIALIZER_LIST = 10;
+    static constexpr size_t NODE_OP_TYPE = 0;
+    static constexpr size_t NODE_NAME = 1;
+    static constexpr size_t NODE_INPUT = 2;
+    static constexpr size_t NODE_OUTPUT = 3;
+    static constexpr size_t NODE_ATTRIBUTE_LIST = 4;
+    static constexpr size_t ATTRIBUTE_NAME = 0;
+    static constexpr size_t ATTRIBUTE_VALUE = 1;
+    static constexpr size_t TENSOR_NAME = 0;
+    static constexpr size_t TENSOR_TYPE = 1;
+    static constexpr size_t TENSOR_SHAPE = 2;
+    static constexpr size_t TENSOR_RAW_DATA = 3;
+
+    // The children of one node, as indices of other nodes
+    class Children
+    {
+      public:
+        Children(const Index *data, size_t size) : data_(data), size_(size)
+        {
+        }
+        [[nodiscard]] auto begin() const -> const Index *
+        {
+            return data_;
+        }
+        [[nodiscard]] auto end() const -> const Index *
+        {
+            return data_ + size_;
+        }
+        [[nodiscard]] auto size() const -> size_t
+        {
+            return size_;
+        }
+        [[nodiscard]] auto operator[](size_t position) const -> Index
+        {
+            return position < size_ ? data_[position] : NONE;
+        }
+
+      private:
+        const Index *data_;
+        size_t size_;
+    };
+
+    // One linear post-order pass over a tree that was built anyway (parser comparison, AST dump); the parsers
+    // emit the flat form directly through FlatBuilder otherwise
+    static auto fromTree(const ASTNode &root) -> FlatAST;
+
+    // Building, children first; every child index must already exist or be NONE
+    auto addU32(uint32_t value) -> Index;
+    auto addU64(uint64_t value) -> Index;
+    auto addStr(SymbolId id) -> Index;
+    auto addBytes(std::string_view hex_digits) -> Index;
+    auto addTypeEnum(DataType type) -> Index;
+    auto addError() -> Index;
+    auto addNode(NodeType kind, const std::vector<Index> &children) -> Index;
+
+    [[nodiscard]] auto size() const -> size_t
+    {
+        return kinds_.size();
+    }
+    [[nodiscard]] auto getRoot() const -> Index
+    {
+        return kinds_.empty() ? NONE : static_cast<Index>(kinds_.size() - 1);
+    }
+    // NodeType::ERROR_NODE for NONE, so absent children need no separate check
+    [[nodiscard]] auto getKind(Index node) const -> NodeType
+    {
+        return node == NONE ? NodeType::ERROR_NODE : kinds_[node];
+    }
+    [[nodiscard]] auto getChildren(Index node) const -> Children
+    {
+        if (node == NONE)
+        {
+            return {nullptr, 0};
+        }
+        return {children_.data() + first_child_[node], child_count_[node]};
+    }
+    [[nodiscard]] auto getChild(Index node, size_t position) const -> Index
+    {
+        return getChildren(node)[position];
+    }
+
+    // Payload accessors; each one is only meaningful for the kinds named
+    [[nodiscard]] auto getInteger(Index node) const -> uint64_t // U32_LITERAL, U64_LITERAL
+    {
+        return kinds_[node] == NodeType::U32_LITERAL ? payload_[node] : integers_[payload_[node]];
+    }
+    [[nodiscard]] auto getSymbol(Index node) const -> SymbolId // STR_LITERAL
+    {
+        return payload_[node];
+    }
+    [[nodiscard]] auto getHexDigits(Index node) const -> std::string_view // BYTES_LITERAL
+    {
+        return hex_digits_[payload_[node]];
+    }
+    [[nodiscard]] auto getDataType(Index node) const -> DataType // TYPE_ENUM
+    {
+        return static_cast<DataType>(payload_[node]);
+    }
+
+  private:
+    std::vector<NodeType> kinds_;
+    std::vector<uint32_t> first_child_;
+    std::vector<uint32_t> child_count_;
+    std::vector<uint32_t> payload_;
+    std::vector<Index> children_;
+
+    // Side tables for payloads that do not fit in 32 bits
+    std::vector<uint64_t> integers_;
+    std::vector<std::string_view> hex_digits_;
+
+    auto addLeaf(NodeType kind, uint32_t payload) -> Index;
+};
+
+} // namespace sonnx
+
+#endif // FLAT_AST_HPP
@@ -0,0 +1,74 @@
+// Reports what building and releasing an AST costs with the arena: heap allocations, chunks and bytes, per
+// model size. Usage: ast_arena_bench [node counts...]
+#include "SyntheticModel.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::atomic<size_t> heap_allocations{0};
+
+} // namespace
+
+// Every heap allocation of the process goes through here, so the count includes the arena's chunks and its
+// own bookkeeping, and nothing else while only the AST is being built
+auto operator new(size_t size) -> void *
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+auto main(int argc, char *argv[]) -> int
+{
+    std::vector<size_t> node_counts;
+    for (int i = 1; i < argc; ++i)
+    {
+        node_counts.push_back(std::stoul(argv[i]));
+    }
+    if (node_counts.empty())
+    {
+        node_counts = {1000, 10000, 100000, 1000000};
+    }
+
+    std::printf("%10s %10s %12s %8s %12s %10s %10s\n", "graph", "ast_nodes", "heap_allocs", "chunks", "bytes",
+                "build_ms", "free_ms");
+    for (const auto node_count : node_counts)
+    {
+        sonnx::StringInterner names;
+        const sonnx::bench::ChainNames ids(names, node_count);
+
+        auto arena = std::make_unique<sonnx::ASTArena>();
+        const auto before = heap_allocations.load();
+        const auto build_ms = sonnx::bench::timeMs([&] { sonnx::bench::buildChainModel(*arena, names, ids); });
+        const auto allocations = heap_allocations.load() - before;
+        const auto ast_nodes = arena->getNodeCount();
+        const auto chunks = arena->getChunkCount();
+        const auto bytes = arena->getBytesAllocated();
+        const auto free_ms = sonnx::bench::timeMs([&] { arena.reset(); });
+
+        // With one std::unique_ptr per node, heap_allocs would be at least ast_nodes
+        std::printf("%10zu %10zu %12zu %8zu %12zu %10.2f %10.2f\n", node_count, ast_nodes, allocations, chunks, bytes,
+                    build_ms, free_ms);
+    }
+    return 0;
+}
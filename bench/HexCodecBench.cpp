@@ -0,0 +1,113 @@
+// Throughput of every hex kernel this CPU can run against the scalar code, for decoding and encoding raw_data
+// payloads of a few MiB. Figures are GB/s of hex digits read (decode) or written (encode).
+// Usage: hex_codec_bench [payload sizes in MiB...]
+#include "SyntheticModel.hpp"
+#include "utils/HexCodec.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+using sonnx::HexCodec;
+
+constexpr std::string_view DECODERS[] = {"scalar", "sse4.1", "avx2", "avx512bw"};
+constexpr std::string_view ENCODERS[] = {"scalar", "ssse3", "avx2"};
+
+// Best of several runs, in GB/s of digits, so that a single descheduling does not decide the figure
+template <typename Fn> auto bestGbPerS(size_t digit_count, int repeats, Fn &&fn) -> double
+{
+    double best_ms = 0;
+    for (int i = 0; i < repeats; ++i)
+    {
+        const auto ms = sonnx::bench::timeMs(fn);
+        best_ms = i == 0 ? ms : std::min(best_ms, ms);
+    }
+    return static_cast<double>(digit_count) / (best_ms * 1e6);
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int
+{
+    std::vector<size_t> sizes_mib;
+    for (int i = 1; i < argc; ++i)
+    {
+        sizes_mib.push_back(std::stoul(argv[i]));
+    }
+    if (sizes_mib.empty())
+    {
+        sizes_mib = {1, 16, 64};
+    }
+    std::printf("selected kernels: decode %s, encode %s\n", HexCodec::decoderName(), HexCodec::encoderName());
+
+    std::printf("%8s %10s %10s %10s %9s\n", "MiB", "operation", "kernel", "GB/s", "speedup");
+    std::mt19937 random(42);
+    for (const auto size_mib : sizes_mib)
+    {
+        const auto byte_count = size_mib << 20;
+        std::vector<uint8_t> bytes(byte_count);
+        std::generate(bytes.begin(), bytes.end(), [&] { return static_cast<uint8_t>(random()); });
+        std::string digits(2 * byte_count, '0');
+        HexCodec::encodeScalar(bytes.data(), bytes.size(), digits.data());
+        const int repeats = static_cast<int>(std::clamp<size_t>(256 / size_mib, 3, 50));
+
+        std::vector<uint8_t> decoded(byte_count);
+        double scalar = 0;
+        for (const auto kernel : DECODERS)
+        {
+            size_t result = 0;
+            if (!HexCodec::decodeWith(kernel, digits, decoded.data(), result))
+            {
+                continue;
+            }
+            const auto gb_per_s = bestGbPerS(digits.size(), repeats, [&] {
+                HexCodec::decodeWith(kernel, digits, decoded.data(), result);
+            });
+            if (result != digits.size() || decoded != bytes)
+            {
+                std::fprintf(stderr, "the %.*s decoder got a %zu MiB payload wrong\n",
+                             static_cast<int>(kernel.size()), kernel.data(), size_mib);
+                return 1;
+            }
+            scalar = kernel == "scalar" ? gb_per_s : scalar;
+            std::printf("%8zu %10s %10.*s %10.2f %8.2fx\n", size_mib, "decode", static_cast<int>(kernel.size()),
+                        kernel.data(), gb_per_s, gb_per_s / scalar);
+        }
+        const auto decode_gb_per_s =
+            bestGbPerS(digits.size(), repeats, [&] { HexCodec::decode(digits, decoded.data()); });
+        std::printf("%8zu %10s %10s %10.2f %8.2fx\n", size_mib, "decode", "selected", decode_gb_per_s,
+                    decode_gb_per_s / scalar);
+
+        std::string encoded(digits.size(), '\0');
+        for (const auto kernel : ENCODERS)
+        {
+            if (!HexCodec::encodeWith(kernel, bytes.data(), bytes.size(), encoded.data()))
+            {
+                continue;
+            }
+            const auto gb_per_s = bestGbPerS(encoded.size(), repeats, [&] {
+                HexCodec::encodeWith(kernel, bytes.data(), bytes.size(), encoded.data());
+            });
+            if (encoded != digits)
+            {
+                std::fprintf(stderr, "the %.*s encoder got a %zu MiB payload wrong\n",
+                             static_cast<int>(kernel.size()), kernel.data(), size_mib);
+                return 1;
+            }
+            scalar = kernel == "scalar" ? gb_per_s : scalar;
+            std::printf("%8zu %10s %10.*s %10.2f %8.2fx\n", size_mib, "encode", static_cast<int>(kernel.size()),
+                        kernel.data(), gb_per_s, gb_per_s / scalar);
+        }
+        const auto encode_gb_per_s =
+            bestGbPerS(encoded.size(), repeats, [&] { HexCodec::encode(bytes.data(), bytes.size(), encoded.data()); });
+        std::printf("%8zu %10s %10s %10.2f %8.2fx\n", size_mib, "encode", "selected", encode_gb_per_s,
+                    encode_gb_per_s / scalar);
+    }
+    return 0;
+}
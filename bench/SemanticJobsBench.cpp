@@ -0,0 +1,76 @@
+// Times the two stages that --jobs parallelizes, semantic analysis and level computation, per number of jobs on
+// one large model whose 4096 parallel chains give frontiers wide enough to be split.
+// Usage: semantic_jobs_bench [node count] [jobs...]
+#include "SyntheticModel.hpp"
+#include "visitor/ASTSemanticVisitor.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+auto main(int argc, char *argv[]) -> int
+{
+    const size_t node_count = argc > 1 ? std::stoul(argv[1]) : 500000;
+    std::vector<unsigned> job_counts;
+    for (int i = 2; i < argc; ++i)
+    {
+        job_counts.push_back(static_cast<unsigned>(std::stoul(argv[i])));
+    }
+    if (job_counts.empty())
+    {
+        const auto cores = std::max(1U, std::thread::hardware_concurrency());
+        for (unsigned jobs = 1; jobs < cores; jobs *= 2)
+        {
+            job_counts.push_back(jobs);
+        }
+        job_counts.push_back(cores);
+    }
+
+    sonnx::StringInterner names;
+    const sonnx::bench::ChainNames ids(names, node_count);
+    sonnx::ASTArena arena;
+    const auto *model = sonnx::bench::buildChainModel(arena, names, ids, 4096);
+
+    std::printf("%10s %6s %12s %9s %12s %9s\n", "graph", "jobs", "semantic_ms", "speedup", "levels_ms", "speedup");
+    double semantic_base = 0;
+    double levels_base = 0;
+    size_t level_count = 0;
+    for (const auto jobs : job_counts)
+    {
+        // Best of three, so that a single descheduling does not decide the figure
+        double semantic_ms = 0;
+        double levels_ms = 0;
+        for (int repeat = 0; repeat < 3; ++repeat)
+        {
+            sonnx::ASTSemanticVisitor visitor(names, jobs);
+            const auto semantic = sonnx::bench::timeMs([&] { visitor.visit(*model); });
+            if (visitor.hasErrors())
+            {
+                std::fprintf(stderr, "semantic analysis failed: %s\n", visitor.getErrors().front().c_str());
+                return 1;
+            }
+            auto &symbol_table = visitor.getSymbolTable();
+            const auto levels = sonnx::bench::timeMs([&] { symbol_table.computeLevels(jobs); });
+            semantic_ms = repeat == 0 ? semantic : std::min(semantic_ms, semantic);
+            levels_ms = repeat == 0 ? levels : std::min(levels_ms, levels);
+
+            // The levels must not depend on the number of jobs
+            const auto count = symbol_table.getLevels().levelCount();
+            if (level_count != 0 && count != level_count)
+            {
+                std::fprintf(stderr, "%u jobs found %zu levels instead of %zu\n", jobs, count, level_count);
+                return 1;
+            }
+            level_count = count;
+        }
+        if (semantic_base == 0)
+        {
+            semantic_base = semantic_ms;
+            levels_base = levels_ms;
+        }
+        std::printf("%10zu %6u %12.2f %8.2fx %12.2f %8.2fx\n", node_count, jobs, semantic_ms,
+                    semantic_base / semantic_ms, levels_ms, levels_base / levels_ms);
+    }
+    return 0;
+}
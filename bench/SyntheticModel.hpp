@@ -0,0 +1,88 @@
+#ifndef SYNTHETIC_MODEL_HPP
+#define SYNTHETIC_MODEL_HPP
+
+#include "ast/ASTArena.hpp"
+#include "utils/StringInterner.hpp"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sonnx::bench
+{
+
+// Names of a chain model, interned up front so that building the AST allocates nothing but AST memory
+struct ChainNames
+{
+    std::vector<SymbolId> nodes;
+    std::vector<SymbolId> tensors;
+    SymbolId input, relu, add, alpha, alpha_value;
+
+    ChainNames(StringInterner &names, size_t node_count)
+    {
+        nodes.reserve(node_count);
+        tensors.reserve(node_count);
+        for (size_t i = 0; i < node_count; ++i)
+        {
+            nodes.push_back(names.intern("n" + std::to_string(i)));
+            tensors.push_back(names.intern("t" + std::to_string(i)));
+        }
+        input = names.intern("X");
+        relu = names.intern("Relu");
+        add = names.intern("Add");
+        alpha = names.intern("alpha");
+        alpha_value = names.intern("0.5");
+    }
+};
+
+// A model of node_count nodes in width interleaved chains, the way the parsers build it: node i reads the output
+// of node i - width (the first width nodes read the model input), every other node is an Add that also reads the
+// model input, and each carries one attribute. Types are left undefined, so the semantic checks pass without
+// declaring every tensor.
+inline auto buildChainModel(ASTArena &arena, const StringInterner &names, const ChainNames &ids, size_t width = 1)
+    -> const ModelNode *
+{
+    std::vector<ASTNode *> scratch;
+    const auto str = [&](SymbolId id) -> ASTNode * { return arena.make<StrLiteralNode>(id, names.view(id)); };
+    const auto list = [&](std::initializer_list<ASTNode *> children) {
+        scratch.assign(children);
+        return arena.makeList(scratch);
+    };
+
+    std::vector<ASTNode *> nodes;
+    nodes.reserve(ids.nodes.size());
+    for (size_t i = 0; i < ids.nodes.size(); ++i)
+    {
+        const bool is_add = i % 2 == 1;
+        auto *previous = str(i < width ? ids.input : ids.tensors[i - width]);
+        auto *inputs = is_add ? arena.make<InputArrNode>(list({previous, str(ids.input)}))
+                              : arena.make<InputArrNode>(list({previous}));
+        auto *outputs = arena.make<OutputArrNode>(list({str(ids.tensors[i])}));
+        auto *attributes =
+            arena.make<AttributeListNode>(list({arena.make<AttributeNode>(str(ids.alpha), str(ids.alpha_value))}));
+        nodes.push_back(
+            arena.make<NodeNode>(str(is_add ? ids.add : ids.relu), str(ids.nodes[i]), inputs, outputs, attributes));
+    }
+
+    auto *shape = arena.make<IOShapeNode>(list({arena.make<U32LiteralNode>(1), arena.make<U32LiteralNode>(64)}));
+    auto *input = arena.make<IOTensorNode>(str(ids.input), arena.make<TypeEnumNode>(DataType::UNDEFINED), shape);
+    auto *output = arena.make<IOTensorNode>(str(ids.tensors.back()), arena.make<TypeEnumNode>(DataType::UNDEFINED),
+                                            nullptr);
+    auto *node_list = arena.make<NodeListNode>(arena.makeList(nodes));
+    auto *input_list = arena.make<InputListNode>(list({input}));
+    auto *output_list = arena.make<OutputListNode>(list({output}));
+    return arena.make<ModelNode>(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, node_list, input_list,
+                                 output_list, nullptr, nullptr, nullptr);
+}
+
+// Wall time of fn in milliseconds
+template <typename Fn> auto timeMs(Fn &&fn) -> double
+{
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace sonnx::bench
+
+#endif // SYNTHETIC_MODEL_HPP
@@ -0,0 +1,71 @@
+// Times building the node graph and sorting it topologically, per model size and number of parallel chains.
+// Usage: topological_sort_bench [node counts...]
+#include "SyntheticModel.hpp"
+#include "visitor/ASTSemanticVisitor.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+auto main(int argc, char *argv[]) -> int
+{
+    std::vector<size_t> node_counts;
+    for (int i = 1; i < argc; ++i)
+    {
+        node_counts.push_back(std::stoul(argv[i]));
+    }
+    if (node_counts.empty())
+    {
+        node_counts = {1000, 10000, 100000, 1000000};
+    }
+
+    std::printf("%10s %7s %10s %10s %10s %12s\n", "graph", "width", "edges", "dag_ms", "sort_ms", "sort_ns/node");
+    for (const auto node_count : node_counts)
+    {
+        for (const size_t width : {size_t{1}, size_t{64}, size_t{4096}})
+        {
+            if (width > node_count)
+            {
+                continue;
+            }
+            sonnx::StringInterner names;
+            const sonnx::bench::ChainNames ids(names, node_count);
+            sonnx::ASTArena arena;
+            const auto *model = sonnx::bench::buildChainModel(arena, names, ids, width);
+            sonnx::ASTSemanticVisitor visitor(names);
+            visitor.visit(*model);
+            if (visitor.hasErrors())
+            {
+                std::fprintf(stderr, "semantic analysis failed: %s\n", visitor.getErrors().front().c_str());
+                return 1;
+            }
+
+            // Best of three, so that a single descheduling does not decide the figure
+            auto &symbol_table = visitor.getSymbolTable();
+            double dag_ms = 0;
+            double sort_ms = 0;
+            for (int repeat = 0; repeat < 3; ++repeat)
+            {
+                const auto dag = sonnx::bench::timeMs([&] { symbol_table.buildDAG(); });
+                const auto sort = sonnx::bench::timeMs([&] { symbol_table.performTopologicalSort(); });
+                dag_ms = repeat == 0 ? dag : std::min(dag_ms, dag);
+                sort_ms = repeat == 0 ? sort : std::min(sort_ms, sort);
+            }
+
+            // Every node comes after its producer in source order, so the sort must keep the source order
+            const auto &order = symbol_table.getTopologicalOrder();
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                if (order.size() != node_count || order[i]->getIndex() != i)
+                {
+                    std::fprintf(stderr, "the topological order of a %zu-node graph is not its source order\n",
+                                 node_count);
+                    return 1;
+                }
+            }
+            std::printf("%10zu %7zu %10zu %10.2f %10.2f %12.1f\n", node_count, width,
+                        symbol_table.getGraph().edgeCount(), dag_ms, sort_ms, sort_ms * 1e6 / node_count);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,264 @@
+// Compares walking the AST with accept() and virtual visits against ASTStaticVisitor's switch dispatch. Both
+// walkers do the same work per node, so the difference is the cost of dispatch.
+// Usage: visitor_dispatch_bench [node counts...]
+#include "SyntheticModel.hpp"
+#include "visitor/ASTStaticVisitor.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using namespace sonnx;
+
+// What a walker does at each node: count it, fold its payload into a checksum and walk its children through
+// self.go(), which is where the two walkers differ
+struct WalkState
+{
+    size_t nodes = 0;
+    uint64_t checksum = 0;
+
+    void mix(uint64_t value)
+    {
+        ++nodes;
+        checksum = checksum * 31 + value;
+    }
+};
+
+template <typename Self> void walkList(Self &self, ASTNodeList children)
+{
+    for (const auto *child : children)
+    {
+        self.go(child);
+    }
+}
+
+template <typename Self> void walk(Self &self, const U32LiteralNode &node)
+{
+    self.state.mix(node.getValue());
+}
+
+template <typename Self> void walk(Self &self, const U64LiteralNode &node)
+{
+    self.state.mix(node.getValue());
+}
+
+template <typename Self> void walk(Self &self, const StrLiteralNode &node)
+{
+    self.state.mix(node.getId());
+}
+
+template <typename Self> void walk(Self &self, const BytesLiteralNode &node)
+{
+    self.state.mix(node.getByteCount());
+}
+
+template <typename Self> void walk(Self &self, const TypeEnumNode &node)
+{
+    self.state.mix(static_cast<uint64_t>(node.getValue()));
+}
+
+template <typename Self> void walk(Self &self, const ModelNode &node)
+{
+    self.state.mix(0);
+    for (const auto *child :
+         {node.getIrVersion(), node.getProducerName(), node.getProducerVersion(), node.getDomain(),
+          node.getModelVersion(), node.getDocString(), node.getGraphName(), node.getNodeList(), node.getInputList(),
+          node.getOutputList(), node.getInitializerList(), node.getOpsetDomain(), node.getOpsetVersion()})
+    {
+        self.go(child);
+    }
+}
+
+template <typename Self> void walk(Self &self, const NodeListNode &node)
+{
+    self.state.mix(1);
+    walkList(self, node.getNodes());
+}
+
+template <typename Self> void walk(Self &self, const InputListNode &node)
+{
+    self.state.mix(2);
+    walkList(self, node.getIOTensors());
+}
+
+template <typename Self> void walk(Self &self, const OutputListNode &node)
+{
+    self.state.mix(3);
+    walkList(self, node.getIOTensors());
+}
+
+template <typename Self> void walk(Self &self, const InitializerListNode &node)
+{
+    self.state.mix(4);
+    walkList(self, node.getInitTensors());
+}
+
+template <typename Self> void walk(Self &self, const NodeNode &node)
+{
+    self.state.mix(5);
+    self.go(node.getOpType());
+    self.go(node.getName());
+    self.go(node.getInputListOrArray());
+    self.go(node.getOutputListOrArray());
+    self.go(node.getAttributeList());
+}
+
+template <typename Self> void walk(Self &self, const InputArrNode &node)
+{
+    self.state.mix(6);
+    walkList(self, node.getInputElements());
+}
+
+template <typename Self> void walk(Self &self, const OutputArrNode &node)
+{
+    self.state.mix(7);
+    walkList(self, node.getOutputElements());
+}
+
+template <typename Self> void walk(Self &self, const AttributeListNode &node)
+{
+    self.state.mix(8);
+    walkList(self, node.getAttributes());
+}
+
+template <typename Self> void walk(Self &self, const AttributeNode &node)
+{
+    self.state.mix(9);
+    self.go(node.getName());
+    self.go(node.getValue());
+}
+
+template <typename Self> void walk(Self &self, const IOTensorNode &node)
+{
+    self.state.mix(10);
+    self.go(node.getName());
+    self.go(node.getType());
+    self.go(node.getIOShape());
+}
+
+template <typename Self> void walk(Self &self, const IOShapeNode &node)
+{
+    self.state.mix(11);
+    walkList(self, node.getIODims());
+}
+
+template <typename Self> void walk(Self &self, const InitTensorNode &node)
+{
+    self.state.mix(12);
+    self.go(node.getName());
+    self.go(node.getType());
+    self.go(node.getInitShape());
+    self.go(node.getRawData());
+}
+
+template <typename Self> void walk(Self &self, const InitShapeNode &node)
+{
+    self.state.mix(13);
+    walkList(self, node.getDimValues());
+}
+
+template <typename Self> void walk(Self &self, const ErrorNode &)
+{
+    self.state.mix(14);
+}
+
+class VirtualWalker final : public ASTBaseVisitor
+{
+  public:
+    WalkState state;
+
+    void go(const ASTNode *node)
+    {
+        if (node != nullptr)
+        {
+            node->accept(*this);
+        }
+    }
+
+#define SONNX_VIRTUAL_VISIT(TAG, CLASS)                                                                                \
+    void visit(const CLASS &node) override                                                                             \
+    {                                                                                                                  \
+        walk(*this, node);                                                                                             \
+    }
+    SONNX_AST_NODE_CLASSES(SONNX_VIRTUAL_VISIT)
+#undef SONNX_VIRTUAL_VISIT
+};
+
+class StaticWalker final : public ASTStaticVisitor<StaticWalker>
+{
+  public:
+    WalkState state;
+
+    void go(const ASTNode *node)
+    {
+        if (node != nullptr)
+        {
+            dispatch(*node);
+        }
+    }
+
+#define SONNX_STATIC_VISIT(TAG, CLASS)                                                                                 \
+    void visit(const CLASS &node)                                                                                      \
+    {                                                                                                                  \
+        walk(*this, node);                                                                                             \
+    }
+    SONNX_AST_NODE_CLASSES(SONNX_STATIC_VISIT)
+#undef SONNX_STATIC_VISIT
+};
+
+// Best of several walks, in milliseconds, so that a single descheduling does not decide the comparison
+template <typename Walker> auto bestWalkMs(const ModelNode &model, int repeats, WalkState &state) -> double
+{
+    double best = 0;
+    for (int i = 0; i < repeats; ++i)
+    {
+        Walker walker;
+        const auto ms = bench::timeMs([&] { walker.go(&model); });
+        best = i == 0 ? ms : std::min(best, ms);
+        state = walker.state;
+    }
+    return best;
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int
+{
+    std::vector<size_t> node_counts;
+    for (int i = 1; i < argc; ++i)
+    {
+        node_counts.push_back(std::stoul(argv[i]));
+    }
+    if (node_counts.empty())
+    {
+        node_counts = {1000, 10000, 100000, 1000000};
+    }
+
+    std::printf("%10s %10s %12s %12s %9s\n", "graph", "ast_nodes", "virtual_ms", "static_ms", "speedup");
+    for (const auto node_count : node_counts)
+    {
+        StringInterner names;
+        const bench::ChainNames ids(names, node_count);
+        ASTArena arena;
+        const auto *model = bench::buildChainModel(arena, names, ids);
+
+        // Enough repeats that the small graphs are not timed in the clock's noise
+        const int repeats = static_cast<int>(std::clamp<size_t>(10000000 / (node_count * 12), 5, 1000));
+        WalkState virtual_state;
+        WalkState static_state;
+        const auto virtual_ms = bestWalkMs<VirtualWalker>(*model, repeats, virtual_state);
+        const auto static_ms = bestWalkMs<StaticWalker>(*model, repeats, static_state);
+        if (virtual_state.nodes != static_state.nodes || virtual_state.checksum != static_state.checksum)
+        {
+            std::fprintf(stderr, "the walkers disagree on a %zu-node graph\n", node_count);
+            return 1;
+        }
+        std::printf("%10zu %10zu %12.3f %12.3f %8.2fx\n", node_count, static_state.nodes, virtual_ms, static_ms,
+                    virtual_ms / static_ms);
+    }
+    return 0;
+}
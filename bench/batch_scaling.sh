@@ -0,0 +1,73 @@
+#!/usr/bin/env bash
+# Measures how --batch throughput scales with --jobs.
+#
+# Usage: bench/batch_scaling.sh <path-to-sonnxc> [models] [nodes-per-model] [jobs...]
+#
+# Generates <models> chain models of <nodes-per-model> nodes each (defaults: 64 and 20000) in a temporary
+# directory, then compiles all of them once per jobs value (default: 1, 2, 4, ... up to nproc) with the cache
+# off and prints the wall time and the speedup over one job. Nothing but the generated models is compiled, so
+# the numbers can be reproduced on any machine.
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+  sed -n '4p' "$0" >&2
+  exit 1
+fi
+
+SONNXC="$1"
+MODELS="${2:-64}"
+NODES="${3:-20000}"
+shift $(($# < 3 ? $# : 3))
+JOBS=("$@")
+if [ ${#JOBS[@]} -eq 0 ]; then
+  for ((j = 1; j <= $(nproc); j *= 2)); do
+    JOBS+=("$j")
+  done
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+# Each node reads the previous node's output. Every tensor is declared as a FLOAT model output, so all tensors
+# a node touches have the same type.
+generate_model() {
+  local path="$1"
+  {
+    echo 'ModelProto {'
+    echo '  ir_version = 8 producer_name = "batch_scaling" producer_version = "1" domain = ""'
+    echo '  model_version = 1 doc_string = ""'
+    echo '  graph {'
+    echo '    name = "chain"'
+    awk -v n="${NODES}" 'BEGIN {
+      print "    node { op_type = \"Relu\" name = \"n0\" input = [\"X\"] output = [\"T0\"] }"
+      for (i = 1; i < n; ++i)
+        printf "    node { op_type = \"Relu\" name = \"n%d\" input = [\"T%d\"] output = [\"T%d\"] }\n", i, i - 1, i
+      shape = "shape { dim { dim_value = 1 } dim { dim_value = 64 } }"
+      print "    input { name = \"X\" type { tensor_type { elem_type = FLOAT " shape " } } }"
+      for (i = 0; i < n; ++i)
+        printf "    output { name = \"T%d\" type { tensor_type { elem_type = FLOAT %s } } }\n", i, shape
+    }'
+    echo '  }'
+    echo '  opset_import { domain = "" version = 13 }'
+    echo '}'
+  } >"${path}"
+}
+
+mkdir -p "${WORK_DIR}/models" "${WORK_DIR}/out"
+generate_model "${WORK_DIR}/models/model0.sonnx"
+for ((i = 1; i < MODELS; ++i)); do
+  cp "${WORK_DIR}/models/model0.sonnx" "${WORK_DIR}/models/model${i}.sonnx"
+done
+
+echo "sonnxc batch scaling: ${MODELS} models x ${NODES} nodes, $(nproc) hardware threads"
+printf '%6s %12s %9s\n' jobs wall_ms speedup
+baseline=""
+for jobs in "${JOBS[@]}"; do
+  start=$(date +%s%N)
+  "${SONNXC}" --batch --no-cache --jobs="${jobs}" --output-dir="${WORK_DIR}/out" "${WORK_DIR}"/models/*.sonnx \
+    2>"${WORK_DIR}/summary.txt"
+  wall_ms=$((($(date +%s%N) - start) / 1000000))
+  baseline="${baseline:-${wall_ms}}"
+  printf '%6d %12d %9s\n' "${jobs}" "${wall_ms}" "$(awk -v b="${baseline}" -v w="${wall_ms}" \
+    'BEGIN { printf "%.2fx", b / (w > 0 ? w : 1) }')"
+done
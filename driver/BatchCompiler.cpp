@@ -0,0 +1,157 @@
+#include "BatchCompiler.hpp"
+#include "utils/ParallelFor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace sonnx
+{
+
+BatchCompiler::BatchCompiler(CompileOptions options, std::optional<CompileCache> cache, const unsigned jobs,
+                             std::string output_dir)
+    : options_(options), cache_(std::move(cache)), jobs_(jobs), output_dir_(std::move(output_dir))
+{
+}
+
+auto BatchCompiler::readManifest(const std::string &manifest_path) -> std::vector<std::string>
+{
+    std::ifstream in(manifest_path);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open manifest '" + manifest_path + "'");
+    }
+    const auto base = fs::path(manifest_path).parent_path();
+    std::vector<std::string> model_paths;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+        const auto last = line.find_last_not_of(" \t\r");
+        const fs::path path = line.substr(first, last - first + 1);
+        model_paths.push_back(path.is_absolute() ? path.string() : (base / path).string());
+    }
+    return model_paths;
+}
+
+auto BatchCompiler::outputPathFor(const std::string &model_path) const -> std::string
+{
+    auto path = fs::path(model_path);
+    if (!output_dir_.empty())
+    {
+        path = fs::path(output_dir_) / path.filename();
+    }
+    return path.replace_extension(".tac").string();
+}
+
+auto BatchCompiler::run(const std::vector<std::string> &model_paths) const -> std::vector<BatchEntry>
+{
+    std::vector<BatchEntry> entries(model_paths.size());
+    std::unordered_map<std::string, const std::string *> claimed_outputs;
+    for (size_t i = 0; i < model_paths.size(); ++i)
+    {
+        entries[i].model_path = model_paths[i];
+        entries[i].output_path = outputPathFor(model_paths[i]);
+        const auto [it, inserted] = claimed_outputs.emplace(
+            fs::absolute(entries[i].output_path).lexically_normal().string(), &model_paths[i]);
+        if (!inserted)
+        {
+            throw std::runtime_error("Models '" + *it->second + "' and '" + model_paths[i] + "' would both write '" +
+                                     entries[i].output_path + "'");
+        }
+    }
+    if (!output_dir_.empty())
+    {
+        fs::create_directories(output_dir_);
+    }
+
+    parallelFor(entries.size(), jobs_, [&](const size_t i) { compileOne(entries[i]); });
+    return entries;
+}
+
+void BatchCompiler::compileOne(BatchEntry &entry) const
+{
+    const auto start = std::chrono::steady_clock::now();
+    CompileResult result;
+    try
+    {
+        const auto source = MappedCharStream::fromFile(entry.model_path);
+        result = cache_ ? cache_->compile(*source, options_) : compile(*source, options_);
+        if (result.exit_code == 0)
+        {
+            std::ofstream out(entry.output_path, std::ios::binary | std::ios::trunc);
+            if (!(out << result.output) || !out.flush())
+            {
+                result.exit_code = 1;
+                result.diagnostics += "Cannot write '" + entry.output_path + "'\n";
+            }
+        }
+        else
+        {
+            // Do not leave a previous run's TAC behind for a model that no longer compiles
+            std::error_code ignored;
+            fs::remove(entry.output_path, ignored);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        result.exit_code = 1;
+        result.diagnostics += std::string("Unexpected error: ") + e.what() + "\n";
+    }
+    entry.exit_code = result.exit_code;
+    entry.diagnostics = std::move(result.diagnostics);
+    entry.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BatchCompiler::printSummary(const std::vector<BatchEntry> &entries, const double wall_milliseconds,
+                                 std::ostream &out) const
+{
+    size_t width = 5;
+    for (const auto &entry : entries)
+    {
+        width = std::max(width, entry.model_path.size());
+    }
+
+    size_t failures = 0;
+    out << std::left << std::setw(static_cast<int>(width)) << "Model" << "  Status  " << std::right << std::setw(10)
+        << "Time (ms)" << '\n';
+    out << std::fixed << std::setprecision(2);
+    for (const auto &entry : entries)
+    {
+        failures += entry.exit_code != 0;
+        out << std::left << std::setw(static_cast<int>(width)) << entry.model_path << "  "
+            << (entry.exit_code == 0 ? "ok    " : "FAILED") << "  " << std::right << std::setw(10)
+            << entry.milliseconds << '\n';
+    }
+
+    for (const auto &entry : entries)
+    {
+        if (!entry.diagnostics.empty())
+        {
+            out << "\n" << entry.model_path << ":\n" << entry.diagnostics;
+        }
+    }
+
+    const auto seconds = wall_milliseconds / 1000;
+    const auto workers = std::min<size_t>(jobs_, std::max<size_t>(entries.size(), 1));
+    out << '\n'
+        << entries.size() << " models, " << failures << " failed, " << wall_milliseconds << " ms on " << workers
+        << (workers == 1 ? " worker" : " workers");
+    if (seconds > 0)
+    {
+        out << " (" << static_cast<double>(entries.size()) / seconds << " models/s)";
+    }
+    out << std::defaultfloat << '\n';
+}
+
+} // namespace sonnx
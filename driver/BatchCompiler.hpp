@@ -0,0 +1,55 @@
+#ifndef BATCH_COMPILER_HPP
+#define BATCH_COMPILER_HPP
+
+#include "CompileCache.hpp"
+#include "Compiler.hpp"
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sonnx
+{
+
+// Outcome of one model in a batch
+struct BatchEntry
+{
+    std::string model_path;
+    std::string output_path;
+    int exit_code = 0;
+    double milliseconds = 0;
+    std::string diagnostics;
+};
+
+// Compiles many models concurrently. Every model gets a full pipeline of its own (lexer, parser,
+// visitors, symbol table), so workers share nothing but the read-only ANTLR tables and the cache.
+// Each model's TAC goes to its own file: <output_dir>/<stem>.tac, or next to the model if no
+// output directory is given.
+class BatchCompiler
+{
+  public:
+    BatchCompiler(CompileOptions options, std::optional<CompileCache> cache, unsigned jobs, std::string output_dir);
+
+    // One model path per line; blank lines and lines starting with '#' are skipped, and
+    // relative paths are taken relative to the manifest's directory
+    static auto readManifest(const std::string &manifest_path) -> std::vector<std::string>;
+
+    // Throws if two models would write the same output file
+    auto run(const std::vector<std::string> &model_paths) const -> std::vector<BatchEntry>;
+
+    // Per-model status and timing, each model's diagnostics, and the overall throughput
+    void printSummary(const std::vector<BatchEntry> &entries, double wall_milliseconds, std::ostream &out) const;
+
+  private:
+    CompileOptions options_;
+    std::optional<CompileCache> cache_;
+    unsigned jobs_;
+    std::string output_dir_;
+
+    [[nodiscard]] auto outputPathFor(const std::string &model_path) const -> std::string;
+    void compileOne(BatchEntry &entry) const;
+};
+
+} // namespace sonnx
+
+#endif // BATCH_COMPILER_HPP
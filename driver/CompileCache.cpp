@@ -0,0 +1,428 @@
+#include "CompileCache.hpp"
+#include "utils/Sha256.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <streambuf>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace sonnx
+{
+
+namespace
+{
+
+constexpr std::string_view ENTRY_MAGIC = "sonnxc-cache 1\n";
+constexpr std::string_view ENTRY_EXTENSION = ".tac";
+constexpr std::string_view TEMP_PREFIX = ".tmp.";
+// Temporaries this old were left behind by a compiler that died before renaming them
+constexpr auto STALE_TEMP_AGE = std::chrono::hours(1);
+
+auto uniqueTempName(const std::string &key) -> std::string
+{
+    static std::atomic<unsigned> counter{0};
+    return std::string(TEMP_PREFIX) + std::to_string(::getpid()) + "." + std::to_string(counter++) + "." + key;
+}
+
+// "<exit code> <output size> <diagnostics size>" line. The sizes have a fixed width, so that an entry written
+// while the compiler streams its output can start with a placeholder that is overwritten at the end.
+auto formatHeader(int exit_code, uint64_t output_size, uint64_t diagnostics_size) -> std::string
+{
+    std::ostringstream header;
+    header << exit_code << ' ' << std::setfill('0') << std::setw(20) << output_size << ' ' << std::setw(20)
+           << diagnostics_size << '\n';
+    return header.str();
+}
+
+auto copyBytes(std::istream &in, std::ostream &out, uint64_t count) -> bool
+{
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    std::vector<char> buffer(std::min<uint64_t>(count, CHUNK_SIZE));
+    while (count > 0)
+    {
+        const auto chunk = static_cast<std::streamsize>(std::min<uint64_t>(count, CHUNK_SIZE));
+        if (!in.read(buffer.data(), chunk) || !out.write(buffer.data(), chunk))
+        {
+            return false;
+        }
+        count -= static_cast<uint64_t>(chunk);
+    }
+    return true;
+}
+
+// Passes everything written to it on to primary, and copies it to secondary until secondary fails or the copy
+// would grow past limit bytes; from then on only primary is written
+class TeeBuffer final : public std::streambuf
+{
+  public:
+    TeeBuffer(std::streambuf *primary, std::streambuf *secondary, uint64_t limit)
+        : primary_(primary), secondary_(secondary), limit_(limit)
+    {
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+    TeeBuffer(const TeeBuffer &) = delete;
+    auto operator=(const TeeBuffer &) -> TeeBuffer & = delete;
+
+    // Everything written so far reached secondary
+    [[nodiscard]] auto complete() const -> bool
+    {
+        return secondary_ != nullptr;
+    }
+    [[nodiscard]] auto copied() const -> uint64_t
+    {
+        return copied_;
+    }
+
+  protected:
+    auto overflow(int_type character) -> int_type override
+    {
+        if (!drain())
+        {
+            return traits_type::eof();
+        }
+        if (traits_type::eq_int_type(character, traits_type::eof()))
+        {
+            return traits_type::not_eof(character);
+        }
+        *pptr() = traits_type::to_char_type(character);
+        pbump(1);
+        return character;
+    }
+
+    auto xsputn(const char *data, std::streamsize count) -> std::streamsize override
+    {
+        // Large blocks such as raw_data go straight through rather than via the buffer
+        if (count < epptr() - pptr())
+        {
+            std::copy(data, data + count, pptr());
+            pbump(static_cast<int>(count));
+            return count;
+        }
+        return drain() && forward(data, count) ? count : 0;
+    }
+
+    auto sync() -> int override
+    {
+        const bool drained = drain();
+        if (secondary_ != nullptr && secondary_->pubsync() != 0)
+        {
+            secondary_ = nullptr;
+        }
+        return drained && primary_->pubsync() == 0 ? 0 : -1;
+    }
+
+  private:
+    std::streambuf *primary_;
+    std::streambuf *secondary_;
+    uint64_t limit_;
+    uint64_t copied_ = 0;
+    std::array<char, 16 * 1024> buffer_;
+
+    auto drain() -> bool
+    {
+        const auto pending = pptr() - pbase();
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        return pending == 0 || forward(buffer_.data(), pending);
+    }
+
+    auto forward(const char *data, std::streamsize count) -> bool
+    {
+        if (secondary_ != nullptr)
+        {
+            if (copied_ + static_cast<uint64_t>(count) > limit_ || secondary_->sputn(data, count) != count)
+            {
+                secondary_ = nullptr;
+            }
+            else
+            {
+                copied_ += static_cast<uint64_t>(count);
+            }
+        }
+        return primary_->sputn(data, count) == count;
+    }
+};
+
+} // namespace
+
+CompileCache::CompileCache(fs::path directory, const uint64_t max_size)
+    : directory_(std::move(directory)), max_size_(max_size)
+{
+}
+
+auto CompileCache::defaultDirectory() -> fs::path
+{
+    if (const char *xdg_cache_home = std::getenv("XDG_CACHE_HOME"); xdg_cache_home && *xdg_cache_home)
+    {
+        return fs::path(xdg_cache_home) / "sonnxc";
+    }
+    if (const char *home = std::getenv("HOME"); home && *home)
+    {
+        return fs::path(home) / ".cache" / "sonnxc";
+    }
+    return {};
+}
+
+auto CompileCache::computeKey(std::string_view source, const CompileOptions &options) -> std::string
+{
+    Sha256 hash;
+    hash.update(SONNXC_VERSION);
+    hash.update(std::string_view("\0", 1));
+    hash.update(options.toString());
+    hash.update(std::string_view("\0", 1));
+    hash.update(source);
+    return hash.hexDigest();
+}
+
+auto CompileCache::entryPath(const std::string &key) const -> fs::path
+{
+    return directory_ / (key + std::string(ENTRY_EXTENSION));
+}
+
+auto CompileCache::replay(const std::string &key, std::ostream &output, std::ostream &diagnostics) const
+    -> std::optional<int>
+{
+    const auto path = entryPath(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+
+    // Layout: magic line, "<exit code> <output size> <diagnostics size>" line, then both payloads. The sizes are
+    // checked against the file before anything is written, so a damaged entry is a miss rather than half a result.
+    std::string magic(ENTRY_MAGIC.size(), '\0');
+    int exit_code = 0;
+    uint64_t output_size = 0;
+    uint64_t diagnostics_size = 0;
+    if (!in.read(magic.data(), static_cast<std::streamsize>(magic.size())) || magic != ENTRY_MAGIC ||
+        !(in >> exit_code >> output_size >> diagnostics_size) || in.get() != '\n')
+    {
+        return std::nullopt;
+    }
+    std::error_code error;
+    const auto file_size = fs::file_size(path, error);
+    const auto payload_offset = static_cast<uint64_t>(in.tellg());
+    if (error || file_size < payload_offset || file_size - payload_offset != output_size + diagnostics_size)
+    {
+        return std::nullopt;
+    }
+    if (!copyBytes(in, output, output_size) || !copyBytes(in, diagnostics, diagnostics_size))
+    {
+        diagnostics << "Unexpected error: cannot read compile cache entry " << path.string() << '\n';
+        return 1;
+    }
+
+    // Bump the modification time so eviction sees this entry as recently used
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return exit_code;
+}
+
+auto CompileCache::lookup(const std::string &key) const -> std::optional<CompileResult>
+{
+    std::ostringstream output;
+    std::ostringstream diagnostics;
+    const auto exit_code = replay(key, output, diagnostics);
+    if (!exit_code)
+    {
+        return std::nullopt;
+    }
+    return CompileResult{*exit_code, output.str(), diagnostics.str()};
+}
+
+void CompileCache::store(const std::string &key, const CompileResult &result) const
+{
+    // An entry larger than the whole cache would only evict every other entry and then itself
+    if (result.output.size() + result.diagnostics.size() > max_size_)
+    {
+        return;
+    }
+
+    std::error_code error;
+    fs::create_directories(directory_, error);
+    if (error)
+    {
+        return;
+    }
+
+    const auto temp_path = directory_ / uniqueTempName(key);
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out << ENTRY_MAGIC << formatHeader(result.exit_code, result.output.size(), result.diagnostics.size())
+            << result.output << result.diagnostics;
+        if (!out.flush())
+        {
+            out.close();
+            fs::remove(temp_path, error);
+            return;
+        }
+    }
+    // rename(2) replaces the destination atomically; a racing writer of the same key stores the same bytes
+    const auto path = entryPath(key);
+    fs::rename(temp_path, path, error);
+    if (error)
+    {
+        fs::remove(temp_path, error);
+        return;
+    }
+    evict(path);
+}
+
+auto CompileCache::compile(MappedCharStream &source, const CompileOptions &options) const -> CompileResult
+{
+    const auto key = computeKey(source.getView(), options);
+    if (auto cached = lookup(key))
+    {
+        return std::move(*cached);
+    }
+    auto result = sonnx::compile(source, options);
+    // Failures are not cached, so a fixed environment (or a transient error) never sticks
+    if (result.exit_code == 0)
+    {
+        store(key, result);
+    }
+    return result;
+}
+
+auto CompileCache::compile(MappedCharStream &source, const CompileOptions &options, std::ostream &output,
+                           std::ostream &diagnostics) const -> int
+{
+    const auto key = computeKey(source.getView(), options);
+    if (const auto exit_code = replay(key, output, diagnostics))
+    {
+        return *exit_code;
+    }
+
+    std::error_code error;
+    fs::create_directories(directory_, error);
+    const auto temp_path = directory_ / uniqueTempName(key);
+    std::ofstream entry;
+    if (!error)
+    {
+        entry.open(temp_path, std::ios::binary | std::ios::trunc);
+    }
+    if (!entry)
+    {
+        return sonnx::compile(source, options, output, diagnostics);
+    }
+
+    // The TAC goes to output and the entry as it is generated; the sizes are filled in once it is complete
+    entry << ENTRY_MAGIC << formatHeader(0, 0, 0);
+    std::ostringstream kept_diagnostics;
+    TeeBuffer output_tee(output.rdbuf(), entry.rdbuf(), max_size_);
+    TeeBuffer diagnostics_tee(diagnostics.rdbuf(), kept_diagnostics.rdbuf(), max_size_);
+    std::ostream tee_output(&output_tee);
+    std::ostream tee_diagnostics(&diagnostics_tee);
+    const auto exit_code = sonnx::compile(source, options, tee_output, tee_diagnostics);
+    tee_output.flush();
+    tee_diagnostics.flush();
+    if (!tee_output)
+    {
+        output.setstate(std::ios::badbit);
+    }
+
+    // As in store(): only successes are kept, and nothing larger than the whole cache
+    const auto kept = kept_diagnostics.str();
+    if (exit_code == 0 && output_tee.complete() && diagnostics_tee.complete() &&
+        output_tee.copied() + kept.size() <= max_size_)
+    {
+        entry << kept;
+        entry.seekp(static_cast<std::streamoff>(ENTRY_MAGIC.size()));
+        entry << formatHeader(0, output_tee.copied(), kept.size());
+        entry.close();
+        const auto path = entryPath(key);
+        if (entry)
+        {
+            fs::rename(temp_path, path, error);
+            if (!error)
+            {
+                evict(path);
+                return exit_code;
+            }
+        }
+    }
+    else
+    {
+        entry.close();
+    }
+    fs::remove(temp_path, error);
+    return exit_code;
+}
+
+void CompileCache::evict(const fs::path &keep) const
+{
+    struct Entry
+    {
+        fs::path path;
+        fs::file_time_type last_used;
+        uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total_size = 0;
+    const auto now = fs::file_time_type::clock::now();
+
+    std::error_code error;
+    for (fs::directory_iterator it(directory_, error), end; !error && it != end; it.increment(error))
+    {
+        std::error_code entry_error;
+        const auto &path = it->path();
+        const auto name = path.filename().string();
+        const auto last_used = it->last_write_time(entry_error);
+        if (entry_error)
+        {
+            continue;
+        }
+        if (name.rfind(TEMP_PREFIX, 0) == 0)
+        {
+            if (now - last_used > STALE_TEMP_AGE)
+            {
+                fs::remove(path, entry_error);
+            }
+            continue;
+        }
+        // The entry just stored is never a candidate, even when it alone is at the limit
+        if (path.extension() != ENTRY_EXTENSION || path == keep)
+        {
+            continue;
+        }
+        const auto size = it->file_size(entry_error);
+        if (entry_error)
+        {
+            continue;
+        }
+        entries.push_back({path, last_used, size});
+        total_size += size;
+    }
+    std::error_code keep_error;
+    if (const auto keep_size = fs::file_size(keep, keep_error); !keep_error)
+    {
+        total_size += keep_size;
+    }
+    if (total_size <= max_size_)
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &lhs, const Entry &rhs) { return lhs.last_used < rhs.last_used; });
+    for (const auto &entry : entries)
+    {
+        if (total_size <= max_size_)
+        {
+            break;
+        }
+        // Another process may be evicting the same entry; either way it no longer counts
+        fs::remove(entry.path, error);
+        total_size -= entry.size;
+    }
+}
+
+} // namespace sonnx
@@ -0,0 +1,57 @@
+#ifndef COMPILE_CACHE_HPP
+#define COMPILE_CACHE_HPP
+
+#include "Compiler.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace sonnx
+{
+
+// Content-addressed store of compile results, one file per key.
+// Entries are written to a private temporary file and renamed into place, so concurrent
+// compilers sharing the directory only ever see complete entries; the least recently used
+// entries are evicted once the directory grows past max_size bytes.
+class CompileCache
+{
+  public:
+    static constexpr uint64_t DEFAULT_MAX_SIZE = 256ULL << 20;
+
+    CompileCache(std::filesystem::path directory, uint64_t max_size);
+
+    // $XDG_CACHE_HOME/sonnxc, falling back to $HOME/.cache/sonnxc; empty if neither is set
+    static auto defaultDirectory() -> std::filesystem::path;
+    // SHA-256 over the compiler version, the options and the model bytes, as hex digits
+    static auto computeKey(std::string_view source, const CompileOptions &options) -> std::string;
+
+    // Returns the stored result, or nothing on a miss or an unreadable entry
+    auto lookup(const std::string &key) const -> std::optional<CompileResult>;
+    // Best effort: a cache that cannot be written never fails the compilation. Results larger than max_size
+    // are not stored.
+    void store(const std::string &key, const CompileResult &result) const;
+    // Replays the cached result for source, or compiles it and caches the result if it succeeded
+    auto compile(MappedCharStream &source, const CompileOptions &options) const -> CompileResult;
+    // Same, but streams the result: a hit is copied from the entry, and on a miss the TAC is written to output
+    // and the new entry as it is generated, so it is never held in memory. Returns the exit code.
+    auto compile(MappedCharStream &source, const CompileOptions &options, std::ostream &output,
+                 std::ostream &diagnostics) const -> int;
+
+  private:
+    std::filesystem::path directory_;
+    uint64_t max_size_;
+
+    [[nodiscard]] auto entryPath(const std::string &key) const -> std::filesystem::path;
+    // Copies a stored result to the streams and returns its exit code; nothing on a miss or a damaged entry
+    auto replay(const std::string &key, std::ostream &output, std::ostream &diagnostics) const
+        -> std::optional<int>;
+    // Removes the least recently used entries other than keep until the directory fits in max_size
+    void evict(const std::filesystem::path &keep) const;
+};
+
+} // namespace sonnx
+
+#endif // COMPILE_CACHE_HPP
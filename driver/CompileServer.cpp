@@ -0,0 +1,294 @@
+#include "CompileServer.hpp"
+#include "S_ONNXLexer.h"
+#include "S_ONNXParser.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace sonnx
+{
+
+namespace
+{
+
+// Every message is a fixed sequence of frames, each a 4-byte little-endian length and its bytes.
+// Request: tag, options (one per line), "path" or "text", model. Response: exit code, output, diagnostics.
+constexpr std::string_view REQUEST_TAG = "sonnxc-request 1";
+constexpr uint32_t MAX_FRAME_SIZE = 1U << 30;
+
+auto writeAll(const int fd, const char *data, size_t size) -> bool
+{
+    while (size > 0)
+    {
+        // MSG_NOSIGNAL: a peer that went away must not kill the server with SIGPIPE
+        const auto written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+auto readAll(const int fd, char *data, size_t size) -> bool
+{
+    while (size > 0)
+    {
+        const auto count = ::read(fd, data, size);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+auto writeFrame(const int fd, std::string_view payload) -> bool
+{
+    const auto size = static_cast<uint32_t>(payload.size());
+    const char header[4] = {static_cast<char>(size), static_cast<char>(size >> 8), static_cast<char>(size >> 16),
+                            static_cast<char>(size >> 24)};
+    return writeAll(fd, header, sizeof(header)) && writeAll(fd, payload.data(), payload.size());
+}
+
+auto readFrame(const int fd, std::string &payload) -> bool
+{
+    unsigned char header[4];
+    if (!readAll(fd, reinterpret_cast<char *>(header), sizeof(header)))
+    {
+        return false;
+    }
+    const uint32_t size = header[0] | header[1] << 8 | header[2] << 16 | static_cast<uint32_t>(header[3]) << 24;
+    if (size > MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+    payload.resize(size);
+    return readAll(fd, payload.data(), size);
+}
+
+auto makeAddress(const std::string &socket_path) -> sockaddr_un
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Socket path too long: '" + socket_path + "'");
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    return address;
+}
+
+// Closes the descriptor when the owner leaves scope
+class FileDescriptor
+{
+  public:
+    explicit FileDescriptor(const int fd) : fd_(fd)
+    {
+    }
+    ~FileDescriptor()
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+    FileDescriptor(const FileDescriptor &) = delete;
+    auto operator=(const FileDescriptor &) -> FileDescriptor & = delete;
+
+    [[nodiscard]] auto get() const -> int
+    {
+        return fd_;
+    }
+
+  private:
+    int fd_;
+};
+
+// Removes the socket file of a server that is gone, which would make bind fail. Anything else at the path, a
+// regular file or the socket of a server that still accepts connections, is left alone and reported.
+void removeStaleSocket(const std::string &socket_path, const sockaddr_un &address)
+{
+    struct stat status{};
+    if (::lstat(socket_path.c_str(), &status) != 0)
+    {
+        if (errno == ENOENT)
+        {
+            return;
+        }
+        throw std::runtime_error("Cannot inspect '" + socket_path + "': " + std::strerror(errno));
+    }
+    if (!S_ISSOCK(status.st_mode))
+    {
+        throw std::runtime_error("Refusing to serve on '" + socket_path + "': the path exists and is not a socket");
+    }
+
+    const FileDescriptor probe(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (probe.get() < 0)
+    {
+        throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+    }
+    if (::connect(probe.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0)
+    {
+        throw std::runtime_error("Refusing to serve on '" + socket_path + "': another server is listening on it");
+    }
+    // Only a refused connection shows that nobody listens; any other failure leaves the question open
+    if (errno != ECONNREFUSED)
+    {
+        throw std::runtime_error("Cannot check whether a server is listening on '" + socket_path +
+                                 "': " + std::strerror(errno));
+    }
+    if (::unlink(socket_path.c_str()) != 0 && errno != ENOENT)
+    {
+        throw std::runtime_error("Cannot remove stale socket '" + socket_path + "': " + std::strerror(errno));
+    }
+}
+
+} // namespace
+
+CompileServer::CompileServer(std::string socket_path, std::optional<CompileCache> cache)
+    : socket_path_(std::move(socket_path)), cache_(std::move(cache))
+{
+}
+
+void CompileServer::run()
+{
+    // Pay for ATN deserialization once, before the first request arrives
+    antlr_sonnx::S_ONNXLexer::initialize();
+    antlr_sonnx::S_ONNXParser::initialize();
+
+    const auto address = makeAddress(socket_path_);
+    const FileDescriptor listener(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (listener.get() < 0)
+    {
+        throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+    }
+    removeStaleSocket(socket_path_, address);
+    if (::bind(listener.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(listener.get(), SOMAXCONN) != 0)
+    {
+        throw std::runtime_error("Cannot listen on '" + socket_path_ + "': " + std::strerror(errno));
+    }
+    std::cerr << "sonnxc " << SONNXC_VERSION << " serving on " << socket_path_ << std::endl;
+
+    while (true)
+    {
+        const int connection = ::accept4(listener.get(), nullptr, nullptr, SOCK_CLOEXEC);
+        if (connection < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            throw std::runtime_error(std::string("Cannot accept connection: ") + std::strerror(errno));
+        }
+        std::thread([this, connection] { serveConnection(connection); }).detach();
+    }
+}
+
+void CompileServer::serveConnection(const int fd) const
+{
+    const FileDescriptor connection(fd);
+    std::string tag;
+    std::string options;
+    std::string kind;
+    CompileRequest request;
+    while (readFrame(fd, tag) && tag == REQUEST_TAG && readFrame(fd, options) && readFrame(fd, kind) &&
+           readFrame(fd, request.model))
+    {
+        request.options.clear();
+        for (size_t start = 0; start < options.size();)
+        {
+            auto end = options.find('\n', start);
+            end = end == std::string::npos ? options.size() : end;
+            request.options.emplace_back(options, start, end - start);
+            start = end + 1;
+        }
+        request.inline_source = kind == "text";
+
+        const auto result = handle(request);
+        if (!writeFrame(fd, std::to_string(result.exit_code)) || !writeFrame(fd, result.output) ||
+            !writeFrame(fd, result.diagnostics))
+        {
+            return;
+        }
+    }
+}
+
+auto CompileServer::handle(const CompileRequest &request) const -> CompileResult
+{
+    CompileOptions options;
+    for (const auto &option : request.options)
+    {
+        if (!options.parseOption(option))
+        {
+            return {1, "", "Unknown compile option: '" + option + "'\n"};
+        }
+    }
+    try
+    {
+        const auto source = request.inline_source ? MappedCharStream::fromText(request.model, "<inline>")
+                                                  : MappedCharStream::fromFile(request.model);
+        return cache_ ? cache_->compile(*source, options) : sonnx::compile(*source, options);
+    }
+    catch (const std::exception &e)
+    {
+        return {1, "", std::string("Unexpected error: ") + e.what() + "\n"};
+    }
+}
+
+auto CompileClient::compile(const std::string &socket_path, const CompileRequest &request)
+    -> std::optional<CompileResult>
+{
+    const auto address = makeAddress(socket_path);
+    const FileDescriptor connection(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (connection.get() < 0 ||
+        ::connect(connection.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        return std::nullopt;
+    }
+
+    std::string options;
+    for (const auto &option : request.options)
+    {
+        options += option;
+        options += '\n';
+    }
+    const auto fd = connection.get();
+    if (!writeFrame(fd, REQUEST_TAG) || !writeFrame(fd, options) ||
+        !writeFrame(fd, request.inline_source ? "text" : "path") || !writeFrame(fd, request.model))
+    {
+        return std::nullopt;
+    }
+
+    std::string exit_code;
+    CompileResult result;
+    if (!readFrame(fd, exit_code) || !readFrame(fd, result.output) || !readFrame(fd, result.diagnostics))
+    {
+        return std::nullopt;
+    }
+    result.exit_code = std::atoi(exit_code.c_str());
+    return result;
+}
+
+} // namespace sonnx
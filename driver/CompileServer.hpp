@@ -0,0 +1,52 @@
+#ifndef COMPILE_SERVER_HPP
+#define COMPILE_SERVER_HPP
+
+#include "CompileCache.hpp"
+#include "Compiler.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sonnx
+{
+
+// One compilation as sent from --client to --serve: the command-line compile options and either
+// the path of the model (resolved by the server, so it should be absolute) or its text
+struct CompileRequest
+{
+    std::vector<std::string> options;
+    bool inline_source = false;
+    std::string model;
+};
+
+// Long-running compiler behind a Unix domain socket. Keeping the process alive keeps the
+// deserialized lexer/parser ATNs and the shared DFA caches warm across compilations.
+// Each connection is served on its own thread and may carry any number of requests.
+class CompileServer
+{
+  public:
+    CompileServer(std::string socket_path, std::optional<CompileCache> cache);
+
+    // Binds the socket and serves until the process is terminated. A socket file nobody listens on is replaced;
+    // any other file at the path, or a live server's socket, makes it throw instead.
+    void run();
+
+  private:
+    std::string socket_path_;
+    std::optional<CompileCache> cache_;
+
+    void serveConnection(int fd) const;
+    [[nodiscard]] auto handle(const CompileRequest &request) const -> CompileResult;
+};
+
+class CompileClient
+{
+  public:
+    // Sends one request to the server; returns nothing if the server cannot be reached
+    static auto compile(const std::string &socket_path, const CompileRequest &request)
+        -> std::optional<CompileResult>;
+};
+
+} // namespace sonnx
+
+#endif // COMPILE_SERVER_HPP
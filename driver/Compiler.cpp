@@ -0,0 +1,447 @@
+#include "Compiler.hpp"
+#include "S_ONNXLexer.h"
+#include "S_ONNXParser.h"
+#include "ast/ASTArena.hpp"
+#include "ast/ASTBuilder.hpp"
+#include "ast/FlatAST.hpp"
+#include "error_listener/LexicalErrorListener.hpp"
+#include "error_listener/ParserErrorListener.hpp"
+#include "error_listener/ParserErrorStrategy.hpp"
+#include "lexer/FastLexer.hpp"
+#include "parser/DirectParser.hpp"
+#include "utils/StringInterner.hpp"
+#include "visitor/ASTConstructionVisitor.hpp"
+#include "visitor/ASTOutputVisitor.hpp"
+#include "visitor/ASTSemanticVisitor.hpp"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+// #define OUTPUT_AST
+
+namespace sonnx
+{
+
+namespace
+{
+
+// Outcome of one lexer for the differential check: the tokens up to the end or to the first error, and the
+// diagnostic it aborted with
+struct LexOutcome
+{
+    std::vector<antlr4::Token *> tokens;
+    std::string error;
+};
+
+auto runLexer(antlr4::CommonTokenStream &token_stream) -> LexOutcome
+{
+    LexOutcome outcome;
+    try
+    {
+        token_stream.fill();
+    }
+    catch (const antlr4::ParseCancellationException &e)
+    {
+        outcome.error = e.what();
+    }
+    outcome.tokens = token_stream.getTokens();
+    return outcome;
+}
+
+// Differential check of the hand-written lexer against the generated one
+auto sameTokens(const LexOutcome &expected, const LexOutcome &actual, std::ostream &diagnostics) -> bool
+{
+    const auto count = std::min(expected.tokens.size(), actual.tokens.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto *lhs = expected.tokens[i];
+        const auto *rhs = actual.tokens[i];
+        if (lhs->getType() != rhs->getType() || lhs->getStartIndex() != rhs->getStartIndex() ||
+            lhs->getStopIndex() != rhs->getStopIndex() || lhs->getLine() != rhs->getLine() ||
+            lhs->getCharPositionInLine() != rhs->getCharPositionInLine())
+        {
+            diagnostics << "Lexer mismatch at token " << i << ": antlr " << lhs->toString() << ", fast "
+                        << rhs->toString() << '\n';
+            return false;
+        }
+    }
+    if (expected.tokens.size() != actual.tokens.size())
+    {
+        diagnostics << "Lexer mismatch: antlr produced " << expected.tokens.size() << " tokens, fast produced "
+                    << actual.tokens.size() << '\n';
+        return false;
+    }
+    if (expected.error != actual.error)
+    {
+        diagnostics << "Lexer mismatch: antlr reported '" << expected.error << "', fast reported '" << actual.error
+                    << "'\n";
+        return false;
+    }
+    diagnostics << "Lexers agree on " << expected.tokens.size() << " tokens"
+                << (expected.error.empty() ? "" : " and the diagnostic") << '\n';
+    return true;
+}
+
+template <typename Builder>
+auto buildASTWithAntlr(antlr4::TokenStream *token_stream, Builder &builder, StringInterner &names,
+                       std::string_view source) -> typename Builder::Ref
+{
+    auto parser = std::make_unique<antlr_sonnx::S_ONNXParser>(token_stream);
+    parser->removeErrorListeners();
+    auto parserErrorListener = std::make_unique<ParserErrorListener>();
+    auto errorStrategy = std::make_unique<ParserErrorStrategy>();
+    parser->addErrorListener(parserErrorListener.get());
+    parser->setErrorHandler(std::move(errorStrategy));
+
+    auto parseTree = parser->model();
+    auto visitor = std::make_unique<BasicASTConstructionVisitor<Builder>>(builder, names, source);
+    visitor->visit(parseTree);
+    return visitor->getTop();
+}
+
+// Outcome of one parser for the differential check: the AST dump, or the diagnostic it aborted with
+struct ParseOutcome
+{
+    const ASTNode *model = nullptr;
+    std::string dump;
+    std::string error;
+};
+
+template <typename BuildFn> auto runParser(BuildFn build) -> ParseOutcome
+{
+    ParseOutcome outcome;
+    try
+    {
+        outcome.model = build();
+    }
+    catch (const antlr4::ParseCancellationException &e)
+    {
+        outcome.error = e.what();
+        return outcome;
+    }
+    if (outcome.model)
+    {
+        ASTOutputVisitor ast_output_visitor;
+        ast_output_visitor.dispatch(*outcome.model);
+        outcome.dump = ast_output_visitor.getResult();
+    }
+    return outcome;
+}
+
+// Differential check of the recursive-descent parser against the generated parser and construction visitor
+auto sameAST(const ParseOutcome &expected, const ParseOutcome &actual, std::ostream &diagnostics) -> bool
+{
+    if (expected.error != actual.error)
+    {
+        diagnostics << "Parser mismatch: antlr reported '" << expected.error << "', direct reported '"
+                    << actual.error << "'\n";
+        return false;
+    }
+    if (expected.dump != actual.dump)
+    {
+        diagnostics << "Parser mismatch: ASTs differ\n--- antlr\n" << expected.dump << "--- direct\n" << actual.dump;
+        return false;
+    }
+    diagnostics << "Parsers agree" << (expected.error.empty() ? " on the AST" : " on the diagnostic") << '\n';
+    return true;
+}
+
+auto runPipeline(MappedCharStream &file_stream, const CompileOptions &options, std::ostream &output,
+                 std::ostream &diagnostics) -> int
+{
+    // The AST keeps views into the mapped source, so file_stream must outlive it
+    const auto source = file_stream.getView();
+    auto lexicalErrorListener = std::make_unique<LexicalErrorListener>();
+    std::unique_ptr<antlr4::TokenSource> lexer;
+    if (options.lexer == LexerKind::FAST)
+    {
+        auto fast_lexer = std::make_unique<FastLexer>(&file_stream);
+        fast_lexer->addErrorListener(lexicalErrorListener.get());
+        lexer = std::move(fast_lexer);
+    }
+    else
+    {
+        auto antlr_lexer = std::make_unique<antlr_sonnx::S_ONNXLexer>(&file_stream);
+        antlr_lexer->removeErrorListeners();
+        antlr_lexer->addErrorListener(lexicalErrorListener.get());
+        lexer = std::move(antlr_lexer);
+    }
+    auto token_stream = std::make_unique<antlr4::CommonTokenStream>(lexer.get());
+    if (options.lexer == LexerKind::COMPARE)
+    {
+        // Both lexers run before either error aborts the compilation, so that lexical errors are compared too
+        const auto expected = runLexer(*token_stream);
+        FastLexer fast_lexer(&file_stream);
+        fast_lexer.addErrorListener(lexicalErrorListener.get());
+        antlr4::CommonTokenStream fast_token_stream(&fast_lexer);
+        if (!sameTokens(expected, runLexer(fast_token_stream), diagnostics))
+        {
+            return 1;
+        }
+        if (!expected.error.empty())
+        {
+            throw antlr4::ParseCancellationException(expected.error);
+        }
+    }
+    else
+    {
+        token_stream->fill();
+    }
+
+    // Own every AST node and every name; released in one go when the compilation is done
+    ASTArena arena;
+    StringInterner names;
+    auto semantic_visitor = std::make_unique<ASTSemanticVisitor>(names, options.jobs);
+
+#ifdef OUTPUT_AST
+    constexpr bool dump_ast = true;
+#else
+    constexpr bool dump_ast = false;
+#endif
+    // The pointer tree is only needed to compare the parsers or to dump it; otherwise the flat form is built
+    // straight from the tokens
+    if (options.ast == ASTKind::FLAT && options.parser != ParserKind::COMPARE && !dump_ast)
+    {
+        FlatAST flat;
+        FlatBuilder builder(flat);
+        if (options.parser == ParserKind::DIRECT)
+        {
+            FlatDirectParser(token_stream.get(), builder, names, source).parseModel();
+        }
+        else
+        {
+            buildASTWithAntlr(token_stream.get(), builder, names, source);
+        }
+        if (flat.getKind(flat.getRoot()) != NodeType::MODEL)
+        {
+            diagnostics << "Error: Failed to cast to ModelNode!" << '\n';
+            return 1;
+        }
+        semantic_visitor->analyze(flat);
+    }
+    else
+    {
+        TreeBuilder builder(arena);
+        const ASTNode *model = nullptr;
+        if (options.parser == ParserKind::DIRECT)
+        {
+            model = DirectParser(token_stream.get(), builder, names, source).parseModel();
+        }
+        else if (options.parser == ParserKind::COMPARE)
+        {
+            auto expected = runParser([&] { return buildASTWithAntlr(token_stream.get(), builder, names, source); });
+            token_stream->seek(0);
+            auto actual =
+                runParser([&] { return DirectParser(token_stream.get(), builder, names, source).parseModel(); });
+            if (!sameAST(expected, actual, diagnostics))
+            {
+                return 1;
+            }
+            if (!expected.error.empty())
+            {
+                throw antlr4::ParseCancellationException(expected.error);
+            }
+            model = expected.model;
+        }
+        else
+        {
+            model = buildASTWithAntlr(token_stream.get(), builder, names, source);
+        }
+
+        if (!model)
+        {
+            diagnostics << "FATAL AST construction error: visitor returned null model" << std::endl;
+            return 1;
+        }
+
+        const auto *model_ptr = astCast<ModelNode>(model);
+        if (!model_ptr)
+        {
+            diagnostics << "Error: Failed to cast to ModelNode!" << '\n';
+            return 1;
+        }
+
+#ifdef OUTPUT_AST
+        auto ast_output_visitor = std::make_unique<ASTOutputVisitor>();
+        ast_output_visitor->visit(*model_ptr);
+        output << ast_output_visitor->getResult() << std::endl;
+#endif
+
+        if (options.ast == ASTKind::FLAT)
+        {
+            semantic_visitor->analyze(FlatAST::fromTree(*model_ptr));
+        }
+        else
+        {
+            semantic_visitor->visit(*model_ptr);
+        }
+    }
+
+    if (semantic_visitor->hasErrors())
+    {
+        diagnostics << "Semantic analysis failed with errors:\n";
+        for (const auto &error : semantic_visitor->getErrors())
+        {
+            diagnostics << "- " << error << '\n';
+        }
+        return 1;
+    }
+
+    auto &symbol_table = semantic_visitor->getSymbolTable();
+    if (symbol_table.hasCycle())
+    {
+        diagnostics << "Warning: Cycle detected in computation graph\n";
+    }
+
+    if (options.fold_constants)
+    {
+        symbol_table.foldConstants();
+    }
+    // Only the shape annotations and the memory planner read shapes. Inferred after folding, as folded values can
+    // settle shapes that depend on constant contents, such as the target of a Reshape.
+    if (options.tac_shapes || options.plan_memory)
+    {
+        symbol_table.inferShapes();
+    }
+    if (options.eliminate_common_subexpressions)
+    {
+        diagnostics << "Common subexpression elimination removed " << symbol_table.eliminateCommonSubexpressions()
+                    << " operations\n";
+    }
+    if (options.eliminate_dead_code)
+    {
+        const auto removed = symbol_table.eliminateDeadCode();
+        diagnostics << "Dead code elimination removed " << removed.operations << " operations and "
+                    << removed.initializers << " initializers (" << removed.initializer_bytes << " bytes)\n";
+    }
+    if (options.plan_memory)
+    {
+        const auto plan = symbol_table.planMemory();
+        diagnostics << "Memory planning placed " << plan.planned << " tensors in a " << plan.arena_bytes
+                    << "-byte arena; " << plan.unplanned << " tensors of unknown size were left out\n";
+    }
+
+    if (options.tac_levels)
+    {
+        symbol_table.computeLevels(options.jobs);
+    }
+
+    symbol_table.writeTACode(output, options.tac_levels, options.tac_shapes);
+    output << std::endl;
+    return 0;
+}
+
+} // namespace
+
+auto CompileOptions::parseOption(const std::string &argument) -> bool
+{
+    if (argument == "--lexer=antlr")
+    {
+        lexer = LexerKind::ANTLR;
+    }
+    else if (argument == "--lexer=fast")
+    {
+        lexer = LexerKind::FAST;
+    }
+    else if (argument == "--lexer=compare")
+    {
+        lexer = LexerKind::COMPARE;
+    }
+    else if (argument == "--parser=antlr")
+    {
+        parser = ParserKind::ANTLR;
+    }
+    else if (argument == "--parser=direct")
+    {
+        parser = ParserKind::DIRECT;
+    }
+    else if (argument == "--parser=compare")
+    {
+        parser = ParserKind::COMPARE;
+    }
+    else if (argument == "--ast=tree")
+    {
+        ast = ASTKind::TREE;
+    }
+    else if (argument == "--ast=flat")
+    {
+        ast = ASTKind::FLAT;
+    }
+    else if (argument == "--tac-levels")
+    {
+        tac_levels = true;
+    }
+    else if (argument == "--tac-shapes")
+    {
+        tac_shapes = true;
+    }
+    else if (argument == "--fold-constants")
+    {
+        fold_constants = true;
+    }
+    else if (argument == "--eliminate-common-subexpressions")
+    {
+        eliminate_common_subexpressions = true;
+    }
+    else if (argument == "--eliminate-dead-code")
+    {
+        eliminate_dead_code = true;
+    }
+    else if (argument == "--plan-memory")
+    {
+        plan_memory = true;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+auto CompileOptions::toString() const -> std::string
+{
+    static constexpr const char *LEXER_NAMES[] = {"antlr", "fast", "compare"};
+    static constexpr const char *PARSER_NAMES[] = {"antlr", "direct", "compare"};
+    static constexpr const char *AST_NAMES[] = {"tree", "flat"};
+    return std::string("--lexer=") + LEXER_NAMES[static_cast<int>(lexer)] + " --parser=" +
+           PARSER_NAMES[static_cast<int>(parser)] + " --ast=" + AST_NAMES[static_cast<int>(ast)] +
+           (tac_levels ? " --tac-levels" : "") + (tac_shapes ? " --tac-shapes" : "") +
+           (fold_constants ? " --fold-constants" : "") +
+           (eliminate_common_subexpressions ? " --eliminate-common-subexpressions" : "") +
+           (eliminate_dead_code ? " --eliminate-dead-code" : "") + (plan_memory ? " --plan-memory" : "");
+}
+
+auto compile(MappedCharStream &source, const CompileOptions &options, std::ostream &output,
+             std::ostream &diagnostics) -> int
+{
+    try
+    {
+        return runPipeline(source, options, output, diagnostics);
+    }
+    catch (const antlr4::ParseCancellationException &e)
+    {
+        diagnostics << "Compilation aborted: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception &e)
+    {
+        diagnostics << "Unexpected error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+auto compile(MappedCharStream &source, const CompileOptions &options) -> CompileResult
+{
+    std::ostringstream output;
+    std::ostringstream diagnostics;
+    CompileResult result;
+    result.exit_code = compile(source, options, output, diagnostics);
+    result.output = output.str();
+    result.diagnostics = diagnostics.str();
+    return result;
+}
+
+} // namespace sonnx
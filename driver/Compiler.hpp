@@ -0,0 +1,81 @@
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include "utils/MappedCharStream.hpp"
+#include <ostream>
+#include <string>
+
+#ifndef SONNXC_VERSION
+#define SONNXC_VERSION "dev"
+#endif
+
+namespace sonnx
+{
+
+enum class LexerKind
+{
+    ANTLR,
+    FAST,
+    COMPARE
+};
+
+enum class ParserKind
+{
+    ANTLR,
+    DIRECT,
+    COMPARE
+};
+
+// Form of the AST that semantic analysis walks
+enum class ASTKind
+{
+    TREE,
+    FLAT
+};
+
+// Everything that can change what a compilation prints
+struct CompileOptions
+{
+    LexerKind lexer = LexerKind::ANTLR;
+    ParserKind parser = ParserKind::ANTLR;
+    ASTKind ast = ASTKind::TREE;
+    // Annotate each TAC operation with its wavefront level and slack
+    bool tac_levels = false;
+    // Annotate each TAC operation with the inferred type and shape of its result
+    bool tac_shapes = false;
+    // Evaluate operations on initializers at compile time and emit their results as initializers
+    bool fold_constants = false;
+    // Compute operations that repeat an earlier one only once
+    bool eliminate_common_subexpressions = false;
+    // Leave operations and initializers no model output depends on out of the TAC
+    bool eliminate_dead_code = false;
+    // Place intermediate tensors in one activation arena and annotate the TAC with their offsets
+    bool plan_memory = false;
+    // Threads for the parallel phases of one compilation. The output does not depend on it, so it is set by the
+    // driver rather than parsed here, and is not part of toString().
+    unsigned jobs = 1;
+
+    // Applies a single command-line option; returns false if it is not a compile option
+    auto parseOption(const std::string &argument) -> bool;
+    // Canonical spelling of the options, part of the compile cache key
+    [[nodiscard]] auto toString() const -> std::string;
+};
+
+// What a compilation prints, split by stream, and the process exit code that goes with it
+struct CompileResult
+{
+    int exit_code = 0;
+    std::string output;
+    std::string diagnostics;
+};
+
+// Runs the whole pipeline (lex, parse, AST construction, semantic analysis, TAC generation) on source,
+// streaming the TAC to output and any errors or warnings to diagnostics; returns the exit code
+auto compile(MappedCharStream &source, const CompileOptions &options, std::ostream &output,
+             std::ostream &diagnostics) -> int;
+// Same, but collects both streams, for callers that keep or forward the result
+auto compile(MappedCharStream &source, const CompileOptions &options) -> CompileResult;
+
+} // namespace sonnx
+
+#endif // COMPILER_HPP
@@ -12,18 +12,26 @@ class ParserErrorListener final : public antlr4::BaseErrorListener
   public:
     void syntaxError(antlr4::Recognizer *recognizer, antlr4::Token *offendingSymbol, size_t line,
                      size_t charPositionInLine, const std::string &msg, std::exception_ptr e) override
+    {
+        const auto typeName = offendingSymbol != nullptr ? getTokenTypeName(recognizer, offendingSymbol) : "";
+
+        // Immediately throw - no recovery possible
+        throw antlr4::ParseCancellationException(
+            formatMessage(line, charPositionInLine, msg, offendingSymbol, typeName));
+    }
+
+    // Shared with DirectParser so both parsers report syntax errors identically
+    static std::string formatMessage(size_t line, size_t charPositionInLine, const std::string &msg,
+                                     antlr4::Token *offendingSymbol, const std::string &typeName)
     {
         std::ostringstream errorMsg;
         errorMsg << "FATAL Parser error at line " << line << ", column " << (charPositionInLine + 1) << ": " << msg;
 
         if (offendingSymbol != nullptr)
         {
-            errorMsg << " (unexpected token: '" << offendingSymbol->getText() << "' of type "
-                     << getTokenTypeName(recognizer, offendingSymbol) << ")";
+            errorMsg << " (unexpected token: '" << offendingSymbol->getText() << "' of type " << typeName << ")";
         }
-
-        // Immediately throw - no recovery possible
-        throw antlr4::ParseCancellationException(errorMsg.str());
+        return errorMsg.str();
     }
 
   private:
@@ -42,15 +42,19 @@ class ParserErrorStrategy final : public antlr4::BailErrorStrategy
 
     antlr4::Token *recoverInline(antlr4::Parser *recognizer) override
     {
-        auto currentToken = recognizer->getCurrentToken();
+        // Immediately throw - no recovery possible
+        throw antlr4::ParseCancellationException(formatMissingToken(recognizer->getCurrentToken()));
+    }
+
+    // Shared with DirectParser so both parsers report missing tokens identically
+    static std::string formatMissingToken(antlr4::Token *currentToken)
+    {
         std::ostringstream errorMsg;
 
         errorMsg << "FATAL Missing token at line " << currentToken->getLine() << ", column "
                  << (currentToken->getCharPositionInLine() + 1) << " (current token: '" << currentToken->getText()
                  << "')";
-
-        // Immediately throw - no recovery possible
-        throw antlr4::ParseCancellationException(errorMsg.str());
+        return errorMsg.str();
     }
 };
 
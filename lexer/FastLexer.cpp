@@ -0,0 +1,568 @@
+#include "FastLexer.hpp"
+#include "S_ONNXLexer.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sonnx
+{
+
+namespace
+{
+
+using Lexer = antlr_sonnx::S_ONNXLexer;
+
+// Character classes driving the first-character dispatch in nextToken()
+enum CharClass : uint8_t
+{
+    CC_NONE = 0,
+    CC_WHITESPACE = 1U << 0U,
+    CC_KEYWORD = 1U << 1U, // may appear in a keyword: [A-Za-z_]
+    CC_HEX = 1U << 2U,     // [0-9A-Fa-f]
+    CC_DIGIT = 1U << 3U,   // [0-9]
+    CC_QUOTE = 1U << 4U,
+    CC_PUNCT = 1U << 5U
+};
+
+constexpr auto buildCharClasses() -> std::array<uint8_t, 256>
+{
+    std::array<uint8_t, 256> classes{};
+    for (int c = 0; c < 256; ++c)
+    {
+        uint8_t cls = CC_NONE;
+        if (c == ' ' || c == '\r' || c == '\n' || c == '\t')
+        {
+            cls |= CC_WHITESPACE;
+        }
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_')
+        {
+            cls |= CC_KEYWORD;
+        }
+        if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f'))
+        {
+            cls |= CC_HEX;
+        }
+        if (c >= '0' && c <= '9')
+        {
+            cls |= CC_DIGIT;
+        }
+        if (c == '"')
+        {
+            cls |= CC_QUOTE;
+        }
+        if (c == '[' || c == ']' || c == '{' || c == '}' || c == ',' || c == '=')
+        {
+            cls |= CC_PUNCT;
+        }
+        classes[c] = cls;
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = buildCharClasses();
+
+auto charClass(char c) -> uint8_t
+{
+    return CHAR_CLASSES[static_cast<unsigned char>(c)];
+}
+
+auto punctuationType(char c) -> size_t
+{
+    switch (c)
+    {
+    case '[':
+        return Lexer::LBRACKET;
+    case ']':
+        return Lexer::RBRACKET;
+    case '{':
+        return Lexer::LBRACE;
+    case '}':
+        return Lexer::RBRACE;
+    case ',':
+        return Lexer::COMMA;
+    default:
+        return Lexer::ASSIGN;
+    }
+}
+
+struct Keyword
+{
+    std::string_view text; // lower case
+    size_t type;
+};
+
+constexpr std::array<Keyword, 32> KEYWORDS{{
+    {"modelproto", Lexer::MODELPROTO},
+    {"graph", Lexer::GRAPH},
+    {"name", Lexer::NAME},
+    {"node", Lexer::NODE},
+    {"input", Lexer::INPUT},
+    {"output", Lexer::OUTPUT},
+    {"op_type", Lexer::OP_TYPE},
+    {"attribute", Lexer::ATTRIBUTE},
+    {"initializer", Lexer::INITIALIZER},
+    {"doc_string", Lexer::DOC_STRING},
+    {"domain", Lexer::DOMAIN},
+    {"model_version", Lexer::MODEL_VERSION},
+    {"producer_name", Lexer::PRODUCER_NAME},
+    {"producer_version", Lexer::PRODUCER_VERSION},
+    {"type", Lexer::TYPE},
+    {"tensor_type", Lexer::TENSOR_TYPE},
+    {"ir_version", Lexer::IR_VERSION},
+    {"elem_type", Lexer::ELEM_TYPE},
+    {"shape", Lexer::SHAPE},
+    {"dim", Lexer::DIM},
+    {"dims", Lexer::DIMS},
+    {"raw_data", Lexer::RAW_DATA},
+    {"opset_import", Lexer::OPSET_IMPORT},
+    {"dim_value", Lexer::DIM_VALUE},
+    {"dim_param", Lexer::DIM_PARAM},
+    {"data_type", Lexer::DATA_TYPE},
+    {"version", Lexer::VERSION},
+    {"value", Lexer::VALUE},
+    {"int", Lexer::INT},
+    {"float", Lexer::FLOAT},
+    {"string", Lexer::STRING},
+    {"bool", Lexer::BOOL},
+}};
+
+constexpr size_t MIN_KEYWORD_LENGTH = 3;
+constexpr size_t MAX_KEYWORD_LENGTH = 16;
+constexpr size_t KEYWORD_TABLE_SIZE = 64;
+
+constexpr auto foldCase(char c) -> char
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Perfect for the 32 keywords above (verified by the static_assert below);
+// callers guarantee length >= MIN_KEYWORD_LENGTH
+constexpr auto keywordHash(const char *text, size_t length) -> size_t
+{
+    const auto first = static_cast<size_t>(static_cast<unsigned char>(foldCase(text[0])));
+    const auto third = static_cast<size_t>(static_cast<unsigned char>(foldCase(text[2])));
+    const auto last = static_cast<size_t>(static_cast<unsigned char>(foldCase(text[length - 1])));
+    return (length * 7 + first * 25 + last * 2 + third) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+constexpr auto buildKeywordTable() -> std::array<int8_t, KEYWORD_TABLE_SIZE>
+{
+    std::array<int8_t, KEYWORD_TABLE_SIZE> table{};
+    for (auto &slot : table)
+    {
+        slot = -1;
+    }
+    for (size_t i = 0; i < KEYWORDS.size(); ++i)
+    {
+        table[keywordHash(KEYWORDS[i].text.data(), KEYWORDS[i].text.size())] = static_cast<int8_t>(i);
+    }
+    return table;
+}
+
+constexpr std::array<int8_t, KEYWORD_TABLE_SIZE> KEYWORD_TABLE = buildKeywordTable();
+
+constexpr auto keywordTableIsPerfect() -> bool
+{
+    for (size_t i = 0; i < KEYWORDS.size(); ++i)
+    {
+        if (KEYWORDS[i].text.size() < MIN_KEYWORD_LENGTH || KEYWORDS[i].text.size() > MAX_KEYWORD_LENGTH ||
+            KEYWORD_TABLE[keywordHash(KEYWORDS[i].text.data(), KEYWORDS[i].text.size())] != static_cast<int8_t>(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(keywordTableIsPerfect(), "keyword hash has collisions");
+
+auto lookupKeyword(const char *text, size_t length) -> size_t
+{
+    const auto index = KEYWORD_TABLE[keywordHash(text, length)];
+    if (index < 0)
+    {
+        return antlr4::Token::INVALID_TYPE;
+    }
+    const auto &keyword = KEYWORDS[static_cast<size_t>(index)];
+    if (keyword.text.size() != length)
+    {
+        return antlr4::Token::INVALID_TYPE;
+    }
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (foldCase(text[i]) != keyword.text[i])
+        {
+            return antlr4::Token::INVALID_TYPE;
+        }
+    }
+    return keyword.type;
+}
+
+auto isEscapedCharacter(char c) -> bool
+{
+    switch (c)
+    {
+    case 'b':
+    case 't':
+    case 'n':
+    case 'f':
+    case 'r':
+    case '"':
+    case '\'':
+    case '\\':
+        return true;
+    default:
+        return false;
+    }
+}
+
+auto countTrailingZeros(unsigned mask) -> unsigned
+{
+    return static_cast<unsigned>(__builtin_ctz(mask));
+}
+
+// Same escaping as antlr4::Lexer::getErrorDisplay
+auto errorDisplay(std::string_view text) -> std::string
+{
+    std::string result;
+    result.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        default:
+            result += c;
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+FastLexer::FastLexer(MappedCharStream *input)
+    : input_(input), data_(input->getView().data()), size_(input->getView().size()), source_pair_(this, input)
+{
+}
+
+auto FastLexer::nextToken() -> std::unique_ptr<antlr4::Token>
+{
+    while (true)
+    {
+        skipWhitespace();
+
+        const size_t start = position_;
+        const size_t line = line_;
+        const size_t column = position_ - line_start_;
+        if (position_ >= size_)
+        {
+            return antlr4::CommonTokenFactory::DEFAULT->create(source_pair_, antlr4::Token::EOF, "",
+                                                                antlr4::Token::DEFAULT_CHANNEL, start, start - 1,
+                                                                line, column);
+        }
+
+        const char first = data_[position_];
+        const auto cls = charClass(first);
+        size_t type = antlr4::Token::INVALID_TYPE;
+        size_t length = 0;
+
+        if ((cls & CC_PUNCT) != 0)
+        {
+            type = punctuationType(first);
+            length = 1;
+        }
+        else if ((cls & CC_QUOTE) != 0)
+        {
+            type = Lexer::STRING_LITERAL;
+            length = matchString();
+        }
+        else
+        {
+            // Longest match wins; keywords, integers and bytes can never tie
+            if ((cls & CC_KEYWORD) != 0)
+            {
+                length = matchKeyword(type);
+            }
+            if ((cls & CC_DIGIT) != 0)
+            {
+                const auto integer_length = matchInteger();
+                if (integer_length > length)
+                {
+                    type = Lexer::INTEGER_LITERAL;
+                    length = integer_length;
+                }
+            }
+            if ((cls & CC_HEX) != 0)
+            {
+                const auto bytes_length = matchBytes(scanHexRun());
+                if (bytes_length > length)
+                {
+                    type = Lexer::BYTES_LITERAL;
+                    length = bytes_length;
+                }
+            }
+        }
+
+        if (length == 0)
+        {
+            reportRecognitionError();
+            continue;
+        }
+
+        if (type == Lexer::STRING_LITERAL)
+        {
+            // The only token that may span lines
+            advanceTo(start + length);
+        }
+        else
+        {
+            position_ = start + length;
+        }
+        return antlr4::CommonTokenFactory::DEFAULT->create(source_pair_, type, "", antlr4::Token::DEFAULT_CHANNEL,
+                                                            start, start + length - 1, line, column);
+    }
+}
+
+void FastLexer::skipWhitespace()
+{
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    while (position_ + 16 <= size_)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data_ + position_));
+        const __m128i newlines = _mm_cmpeq_epi8(chunk, newline);
+        const __m128i whitespace =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), newlines),
+                         _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_return), _mm_cmpeq_epi8(chunk, tab)));
+        const auto whitespace_mask = static_cast<unsigned>(_mm_movemask_epi8(whitespace));
+        auto newline_mask = static_cast<unsigned>(_mm_movemask_epi8(newlines));
+        const unsigned run = whitespace_mask == 0xFFFFU ? 16U : countTrailingZeros(~whitespace_mask);
+
+        newline_mask &= (1U << run) - 1U;
+        if (newline_mask != 0)
+        {
+            line_ += static_cast<size_t>(__builtin_popcount(newline_mask));
+            line_start_ = position_ + (31U - static_cast<unsigned>(__builtin_clz(newline_mask))) + 1;
+        }
+        position_ += run;
+        if (run < 16U)
+        {
+            return;
+        }
+    }
+#endif
+    while (position_ < size_ && (charClass(data_[position_]) & CC_WHITESPACE) != 0)
+    {
+        if (data_[position_] == '\n')
+        {
+            ++line_;
+            line_start_ = position_ + 1;
+        }
+        ++position_;
+    }
+}
+
+void FastLexer::advanceTo(size_t end)
+{
+    const char *cursor = data_ + position_;
+    const char *const stop = data_ + end;
+    while (cursor < stop)
+    {
+        const auto *newline = static_cast<const char *>(std::memchr(cursor, '\n', static_cast<size_t>(stop - cursor)));
+        if (newline == nullptr)
+        {
+            break;
+        }
+        ++line_;
+        line_start_ = static_cast<size_t>(newline - data_) + 1;
+        cursor = newline + 1;
+    }
+    position_ = end;
+}
+
+auto FastLexer::matchKeyword(size_t &type) const -> size_t
+{
+    const size_t limit = std::min(size_ - position_, MAX_KEYWORD_LENGTH);
+    size_t run = 0;
+    while (run < limit && (charClass(data_[position_ + run]) & CC_KEYWORD) != 0)
+    {
+        ++run;
+    }
+    // Longest keyword that is a prefix of the run, e.g. DIM for "dimx"
+    for (size_t length = run; length >= MIN_KEYWORD_LENGTH; --length)
+    {
+        const auto keyword_type = lookupKeyword(data_ + position_, length);
+        if (keyword_type != antlr4::Token::INVALID_TYPE)
+        {
+            type = keyword_type;
+            return length;
+        }
+    }
+    return 0;
+}
+
+auto FastLexer::matchInteger() const -> size_t
+{
+    size_t length = 1;
+    if (data_[position_] != '0')
+    {
+        while (position_ + length < size_ && (charClass(data_[position_ + length]) & CC_DIGIT) != 0)
+        {
+            ++length;
+        }
+    }
+    if (position_ + length < size_ && (data_[position_ + length] == 'l' || data_[position_ + length] == 'L'))
+    {
+        ++length;
+    }
+    return length;
+}
+
+auto FastLexer::matchString() const -> size_t
+{
+    size_t length = 1;
+    while (position_ + length < size_)
+    {
+        const char c = data_[position_ + length];
+        if (c == '"')
+        {
+            return length + 1;
+        }
+        if (c == '\\')
+        {
+            if (position_ + length + 1 >= size_ || !isEscapedCharacter(data_[position_ + length + 1]))
+            {
+                return 0;
+            }
+            length += 2;
+            continue;
+        }
+        ++length;
+    }
+    return 0;
+}
+
+auto FastLexer::matchBytes(size_t hex_run) const -> size_t
+{
+    // [0-9A-Fa-f]+ 'b': the terminating 'b' is itself a hex digit, so the longest
+    // token ends at the last 'b' of the run that has at least one digit before it
+    for (size_t length = hex_run; length >= 2; --length)
+    {
+        if (data_[position_ + length - 1] == 'b')
+        {
+            return length;
+        }
+    }
+    return 0;
+}
+
+auto FastLexer::scanHexRun() const -> size_t
+{
+    size_t offset = position_;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8('9');
+    const __m128i lower_a = _mm_set1_epi8('a');
+    const __m128i lower_f = _mm_set1_epi8('f');
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    while (offset + 16 <= size_)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data_ + offset));
+        // Unsigned range checks: lo <= c <= hi  <=>  max(c, lo) == c && min(c, hi) == c
+        const __m128i is_digit = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(chunk, zero), chunk),
+                                               _mm_cmpeq_epi8(_mm_min_epu8(chunk, nine), chunk));
+        const __m128i folded = _mm_or_si128(chunk, case_bit);
+        const __m128i is_letter = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(folded, lower_a), folded),
+                                                _mm_cmpeq_epi8(_mm_min_epu8(folded, lower_f), folded));
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)));
+        if (mask != 0xFFFFU)
+        {
+            return offset - position_ + countTrailingZeros(~mask);
+        }
+        offset += 16;
+    }
+#endif
+    while (offset < size_ && (charClass(data_[offset]) & CC_HEX) != 0)
+    {
+        ++offset;
+    }
+    return offset - position_;
+}
+
+auto FastLexer::viablePrefixLength() const -> size_t
+{
+    const size_t remaining = size_ - position_;
+    const auto cls = charClass(data_[position_]);
+    size_t viable = 0;
+
+    if ((cls & CC_KEYWORD) != 0)
+    {
+        for (const auto &keyword : KEYWORDS)
+        {
+            size_t common = 0;
+            while (common < keyword.text.size() && common < remaining &&
+                   foldCase(data_[position_ + common]) == keyword.text[common])
+            {
+                ++common;
+            }
+            viable = std::max(viable, common);
+        }
+    }
+    if ((cls & CC_HEX) != 0)
+    {
+        viable = std::max(viable, scanHexRun());
+    }
+    if ((cls & CC_QUOTE) != 0)
+    {
+        size_t length = 1;
+        while (length < remaining && data_[position_ + length] != '"')
+        {
+            if (data_[position_ + length] == '\\')
+            {
+                if (length + 1 >= remaining || !isEscapedCharacter(data_[position_ + length + 1]))
+                {
+                    ++length;
+                    break;
+                }
+                ++length;
+            }
+            ++length;
+        }
+        viable = std::max(viable, length);
+    }
+    return viable;
+}
+
+void FastLexer::reportRecognitionError()
+{
+    // Like the ATN simulator, report everything some rule could still match plus the offending character
+    const size_t stop = std::min(position_ + viablePrefixLength(), size_ - 1);
+    const std::string_view text(data_ + position_, stop - position_ + 1);
+    const std::string message = "token recognition error at: '" + errorDisplay(text) + "'";
+    for (auto *listener : error_listeners_)
+    {
+        listener->syntaxError(nullptr, nullptr, line_, position_ - line_start_, message, nullptr);
+    }
+    // Recover by dropping a single character, as antlr4::Lexer::recover does
+    advanceTo(position_ + 1);
+}
+
+} // namespace sonnx
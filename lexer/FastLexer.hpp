@@ -0,0 +1,84 @@
+#ifndef FAST_LEXER_HPP
+#define FAST_LEXER_HPP
+
+#include "antlr4-runtime.h"
+#include "utils/MappedCharStream.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sonnx
+{
+
+// Hand-written replacement for antlr_sonnx::S_ONNXLexer.
+// Emits exactly the token types, offsets and line/column positions of the generated lexer
+// (longest match, ties resolved in grammar rule order), but works directly on the mapped
+// bytes: keywords are recognised with a case-folded perfect hash instead of the ATN built
+// from single-letter fragments, and whitespace and hex runs are scanned 16 bytes at a time.
+// Tokens carry no text of their own; CommonToken::getText() slices it out of the input.
+class FastLexer final : public antlr4::TokenSource
+{
+  public:
+    explicit FastLexer(MappedCharStream *input);
+
+    void addErrorListener(antlr4::ANTLRErrorListener *listener)
+    {
+        error_listeners_.push_back(listener);
+    }
+    void removeErrorListeners()
+    {
+        error_listeners_.clear();
+    }
+
+    auto nextToken() -> std::unique_ptr<antlr4::Token> override;
+    [[nodiscard]] auto getLine() const -> size_t override
+    {
+        return line_;
+    }
+    auto getCharPositionInLine() -> size_t override
+    {
+        return position_ - line_start_;
+    }
+    auto getInputStream() -> antlr4::CharStream * override
+    {
+        return input_;
+    }
+    auto getSourceName() -> std::string override
+    {
+        return input_->getSourceName();
+    }
+    auto getTokenFactory() -> antlr4::TokenFactory<antlr4::CommonToken> * override
+    {
+        return antlr4::CommonTokenFactory::DEFAULT.get();
+    }
+
+  private:
+    MappedCharStream *input_;
+    const char *data_;
+    size_t size_;
+    size_t position_ = 0;
+    size_t line_ = 1;
+    size_t line_start_ = 0;
+    std::pair<antlr4::TokenSource *, antlr4::CharStream *> source_pair_;
+    std::vector<antlr4::ANTLRErrorListener *> error_listeners_;
+
+    void skipWhitespace();
+    void advanceTo(size_t end);
+
+    // Each matcher returns the length of the longest token of its kind at position_, 0 if none
+    [[nodiscard]] auto matchKeyword(size_t &type) const -> size_t;
+    [[nodiscard]] auto matchInteger() const -> size_t;
+    [[nodiscard]] auto matchString() const -> size_t;
+    [[nodiscard]] auto matchBytes(size_t hex_run) const -> size_t;
+    [[nodiscard]] auto scanHexRun() const -> size_t;
+
+    // Length of the longest prefix at position_ that some rule could still extend
+    [[nodiscard]] auto viablePrefixLength() const -> size_t;
+    void reportRecognitionError();
+};
+
+} // namespace sonnx
+
+#endif // FAST_LEXER_HPP
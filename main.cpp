@@ -1,97 +1,234 @@
-#include "S_ONNXLexer.h"
-#include "S_ONNXParser.h"
-#include "ast/AST.hpp"
-#include "error_listener/LexicalErrorListener.hpp"
-#include "error_listener/ParserErrorListener.hpp"
-#include "error_listener/ParserErrorStrategy.hpp"
-#include "visitor/ASTConstructionVisitor.hpp"
+#include "driver/BatchCompiler.hpp"
+#include "driver/CompileCache.hpp"
+#include "driver/CompileServer.hpp"
+#include "driver/Compiler.hpp"
+#include "utils/MappedCharStream.hpp"
+#include "utils/ParallelFor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <exception>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
 #include <memory>
-#include <visitor/ASTSemanticVisitor.hpp>
+#include <optional>
+#include <string>
+#include <vector>
 
-// #define OUTPUT_AST
+namespace
+{
 
-#ifdef OUTPUT_AST
-#include "visitor/ASTOutputVisitor.hpp"
-#endif
+constexpr const char *USAGE =
+    "Usage: sonnxc [--lexer=antlr|fast|compare] [--parser=antlr|direct|compare] [--ast=tree|flat] [--tac-levels]\n"
+    "              [--tac-shapes] [--fold-constants] [--eliminate-common-subexpressions] [--eliminate-dead-code]\n"
+    "              [--plan-memory] [--jobs=N] [--no-cache] [--cache-dir=DIR] [--cache-max-size=MiB]\n"
+    "              [--client <socket>] <path-to-model | ->\n"
+    "       sonnxc --batch [--jobs=N] [--output-dir=DIR] [--manifest=FILE] [compile and cache options] <models...>\n"
+    "       sonnxc --serve <socket> [--no-cache] [--cache-dir=DIR] [--cache-max-size=MiB]";
 
-auto main(const int argc, char *argv[]) -> int
+struct Options
 {
-    if (argc != 2)
+    sonnx::CompileOptions compile;
+    // The compile options as spelled on the command line, forwarded by --client
+    std::vector<std::string> compile_arguments;
+    std::string model_path;
+    bool batch = false;
+    std::vector<std::string> batch_models;
+    std::string manifest_path;
+    std::string output_dir;
+    unsigned jobs = sonnx::defaultJobs();
+    std::string cache_dir;
+    bool use_cache = true;
+    uint64_t cache_max_size = sonnx::CompileCache::DEFAULT_MAX_SIZE;
+    std::string serve_socket;
+    std::string client_socket;
+};
+
+auto parseArguments(const int argc, char *argv[], Options &options) -> bool
+{
+    for (int i = 1; i < argc; ++i)
     {
-        std::cerr << "Usage: sonnxc <path-to-model>" << '\n';
-        return 1;
+        const std::string argument = argv[i];
+        if (options.compile.parseOption(argument))
+        {
+            options.compile_arguments.push_back(argument);
+            continue;
+        }
+        if (argument == "--batch")
+        {
+            options.batch = true;
+        }
+        else if (argument.rfind("--manifest=", 0) == 0)
+        {
+            options.batch = true;
+            options.manifest_path = argument.substr(11);
+        }
+        else if (argument.rfind("--output-dir=", 0) == 0)
+        {
+            options.output_dir = argument.substr(13);
+        }
+        else if (argument.rfind("--jobs=", 0) == 0)
+        {
+            const auto value = argument.substr(7);
+            if (value.empty() || value.size() > 4 || value.find_first_not_of("0123456789") != std::string::npos ||
+                std::stoul(value) == 0)
+            {
+                return false;
+            }
+            options.jobs = static_cast<unsigned>(std::stoul(value));
+        }
+        else if (argument == "--no-cache")
+        {
+            options.use_cache = false;
+        }
+        else if (argument.rfind("--cache-dir=", 0) == 0)
+        {
+            options.cache_dir = argument.substr(12);
+        }
+        else if (argument.rfind("--cache-max-size=", 0) == 0)
+        {
+            // Given in MiB
+            const auto value = argument.substr(17);
+            if (value.empty() || value.size() > 12 || value.find_first_not_of("0123456789") != std::string::npos)
+            {
+                return false;
+            }
+            options.cache_max_size = std::stoull(value) << 20;
+        }
+        else if ((argument == "--serve" || argument == "--client") && i + 1 < argc)
+        {
+            (argument == "--serve" ? options.serve_socket : options.client_socket) = argv[++i];
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            return false;
+        }
+        else
+        {
+            options.batch_models.push_back(argument);
+        }
+    }
+    if (options.batch)
+    {
+        return options.serve_socket.empty() && options.client_socket.empty() &&
+               (!options.batch_models.empty() || !options.manifest_path.empty());
+    }
+    if (options.batch_models.size() > 1)
+    {
+        return false;
+    }
+    if (!options.batch_models.empty())
+    {
+        options.model_path = options.batch_models.front();
+    }
+    if (!options.serve_socket.empty())
+    {
+        return options.model_path.empty() && options.client_socket.empty() && options.compile_arguments.empty();
     }
+    return !options.model_path.empty();
+}
 
-    try
+auto makeCache(const Options &options) -> std::optional<sonnx::CompileCache>
+{
+    const auto cache_dir = options.cache_dir.empty() ? sonnx::CompileCache::defaultDirectory()
+                                                     : std::filesystem::path(options.cache_dir);
+    if (!options.use_cache || cache_dir.empty())
+    {
+        return std::nullopt;
+    }
+    return sonnx::CompileCache(cache_dir, options.cache_max_size);
+}
+
+// "-" reads the model from standard input
+auto openModel(const std::string &model_path) -> std::unique_ptr<sonnx::MappedCharStream>
+{
+    if (model_path == "-")
     {
-        const auto file_stream = std::make_unique<antlr4::ANTLRFileStream>();
-        file_stream->loadFromFile(argv[1]);
-        auto lexer = std::make_unique<antlr_sonnx::S_ONNXLexer>(file_stream.get());
-        lexer->removeErrorListeners();
-        auto lexicalErrorListener = std::make_unique<sonnx::LexicalErrorListener>();
-        lexer->addErrorListener(lexicalErrorListener.get());
-        auto token_stream = std::make_unique<antlr4::CommonTokenStream>(lexer.get());
-        token_stream->fill();
+        std::string text(std::istreambuf_iterator<char>(std::cin), {});
+        return sonnx::MappedCharStream::fromText(std::move(text), "<stdin>");
+    }
+    return sonnx::MappedCharStream::fromFile(model_path);
+}
 
-        auto parser = std::make_unique<antlr_sonnx::S_ONNXParser>(token_stream.get());
-        parser->removeErrorListeners();
-        auto parserErrorListener = std::make_unique<sonnx::ParserErrorListener>();
-        auto errorStrategy = std::make_unique<sonnx::ParserErrorStrategy>();
-        parser->addErrorListener(parserErrorListener.get());
-        parser->setErrorHandler(std::move(errorStrategy));
+auto printResult(const sonnx::CompileResult &result) -> int
+{
+    std::cout << result.output << std::flush;
+    std::cerr << result.diagnostics;
+    return result.exit_code;
+}
 
-        auto parseTree = parser->model();
-        auto visitor = std::make_unique<sonnx::ASTConstructionVisitor>();
-        visitor->visit(parseTree);
-        auto model = visitor->getTop();
+} // namespace
 
-        if (!model)
-        {
-            std::cerr << "FATAL AST construction error: visitor returned null model" << std::endl;
-            return 1;
-        }
+auto main(const int argc, char *argv[]) -> int
+{
+    Options options;
+    if (!parseArguments(argc, argv, options))
+    {
+        std::cerr << USAGE << '\n';
+        return 1;
+    }
 
-        auto *model_ptr = dynamic_cast<sonnx::ModelNode *>(model.get());
-        if (!model_ptr)
+    try
+    {
+        if (!options.serve_socket.empty())
         {
-            std::cerr << "Error: Failed to cast to ModelNode!" << '\n';
-            return 1;
+            sonnx::CompileServer(options.serve_socket, makeCache(options)).run();
+            return 0;
         }
 
-#ifdef OUTPUT_AST
-        auto ast_output_visitor = std::make_unique<sonnx::ASTOutputVisitor>();
-        ast_output_visitor->visit(*model_ptr);
-        std::cout << ast_output_visitor->getResult() << std::endl;
-#endif
-
-        auto semantic_visitor = std::make_unique<sonnx::ASTSemanticVisitor>();
-        semantic_visitor->visit(*model_ptr);
-
-        if (semantic_visitor->hasErrors())
+        if (options.batch)
         {
-            std::cerr << "Semantic analysis failed with errors:\n";
-            for (const auto &error : semantic_visitor->getErrors())
+            auto model_paths = options.batch_models;
+            if (!options.manifest_path.empty())
             {
-                std::cerr << "- " << error << '\n';
+                const auto listed = sonnx::BatchCompiler::readManifest(options.manifest_path);
+                model_paths.insert(model_paths.end(), listed.begin(), listed.end());
             }
-            return 1;
+            const sonnx::BatchCompiler batch(options.compile, makeCache(options), options.jobs, options.output_dir);
+            const auto start = std::chrono::steady_clock::now();
+            const auto entries = batch.run(model_paths);
+            const std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - start;
+            batch.printSummary(entries, wall.count(), std::cerr);
+            const auto failed = std::any_of(entries.begin(), entries.end(),
+                                            [](const sonnx::BatchEntry &entry) { return entry.exit_code != 0; });
+            return failed ? 1 : 0;
         }
 
-        const auto &symbol_table = semantic_visitor->getSymbolTable();
-        if (symbol_table.hasCycle())
+        // A single model gets the workers to itself; batch mode runs one model per worker instead
+        options.compile.jobs = options.jobs;
+
+        if (!options.client_socket.empty())
         {
-            std::cerr << "Warning: Cycle detected in computation graph\n";
+            sonnx::CompileRequest request;
+            request.options = options.compile_arguments;
+            if (options.model_path == "-")
+            {
+                request.inline_source = true;
+                request.model.assign(std::istreambuf_iterator<char>(std::cin), {});
+            }
+            else
+            {
+                // The server resolves the path from its own working directory
+                request.model = std::filesystem::absolute(options.model_path).string();
+            }
+            if (const auto result = sonnx::CompileClient::compile(options.client_socket, request))
+            {
+                return printResult(*result);
+            }
+            // No server: compile in-process so the client stays a drop-in for the plain CLI
+            const auto file_stream = request.inline_source
+                                         ? sonnx::MappedCharStream::fromText(std::move(request.model), "<stdin>")
+                                         : sonnx::MappedCharStream::fromFile(options.model_path);
+            const auto cache = makeCache(options);
+            return cache ? cache->compile(*file_stream, options.compile, std::cout, std::cerr)
+                         : sonnx::compile(*file_stream, options.compile, std::cout, std::cerr);
         }
 
-        std::cout << symbol_table.generateTACode() << std::endl;
-        return 0;
-    }
-    catch (const antlr4::ParseCancellationException &e)
-    {
-        std::cerr << "Compilation aborted: " << e.what() << std::endl;
-        return 1;
+        const auto file_stream = openModel(options.model_path);
+        const auto cache = makeCache(options);
+        return cache ? cache->compile(*file_stream, options.compile, std::cout, std::cerr)
+                     : sonnx::compile(*file_stream, options.compile, std::cout, std::cerr);
     }
     catch (const std::exception &e)
     {
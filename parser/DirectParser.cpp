@@ -0,0 +1,523 @@
+#include "DirectParser.hpp"
+#include "S_ONNXLexer.h"
+#include "error_listener/ParserErrorListener.hpp"
+#include "error_listener/ParserErrorStrategy.hpp"
+#include "utils/Literal2Cpp.hpp"
+#include <array>
+#include <exception>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+namespace sonnx
+{
+
+namespace
+{
+
+using Lexer = antlr_sonnx::S_ONNXLexer;
+
+// Display names as reported by the generated vocabulary (literal name if any, else symbolic name)
+constexpr std::array<std::pair<size_t, std::string_view>, 42> TOKEN_DISPLAY_NAMES{{
+    {Lexer::WS, "WS"},
+    {Lexer::MODELPROTO, "MODELPROTO"},
+    {Lexer::GRAPH, "GRAPH"},
+    {Lexer::NAME, "NAME"},
+    {Lexer::NODE, "NODE"},
+    {Lexer::INPUT, "INPUT"},
+    {Lexer::OUTPUT, "OUTPUT"},
+    {Lexer::OP_TYPE, "OP_TYPE"},
+    {Lexer::ATTRIBUTE, "ATTRIBUTE"},
+    {Lexer::INITIALIZER, "INITIALIZER"},
+    {Lexer::DOC_STRING, "DOC_STRING"},
+    {Lexer::DOMAIN, "DOMAIN"},
+    {Lexer::MODEL_VERSION, "MODEL_VERSION"},
+    {Lexer::PRODUCER_NAME, "PRODUCER_NAME"},
+    {Lexer::PRODUCER_VERSION, "PRODUCER_VERSION"},
+    {Lexer::TYPE, "TYPE"},
+    {Lexer::TENSOR_TYPE, "TENSOR_TYPE"},
+    {Lexer::IR_VERSION, "IR_VERSION"},
+    {Lexer::ELEM_TYPE, "ELEM_TYPE"},
+    {Lexer::SHAPE, "SHAPE"},
+    {Lexer::DIM, "DIM"},
+    {Lexer::DIMS, "DIMS"},
+    {Lexer::RAW_DATA, "RAW_DATA"},
+    {Lexer::OPSET_IMPORT, "OPSET_IMPORT"},
+    {Lexer::DIM_VALUE, "DIM_VALUE"},
+    {Lexer::DIM_PARAM, "DIM_PARAM"},
+    {Lexer::DATA_TYPE, "DATA_TYPE"},
+    {Lexer::VERSION, "VERSION"},
+    {Lexer::VALUE, "VALUE"},
+    {Lexer::INT, "INT"},
+    {Lexer::FLOAT, "FLOAT"},
+    {Lexer::STRING, "STRING"},
+    {Lexer::BOOL, "BOOL"},
+    {Lexer::LBRACKET, "'['"},
+    {Lexer::RBRACKET, "']'"},
+    {Lexer::LBRACE, "'{'"},
+    {Lexer::RBRACE, "'}'"},
+    {Lexer::COMMA, "','"},
+    {Lexer::ASSIGN, "'='"},
+    {Lexer::INTEGER_LITERAL, "INTEGER_LITERAL"},
+    {Lexer::STRING_LITERAL, "STRING_LITERAL"},
+    {Lexer::BYTES_LITERAL, "BYTES_LITERAL"},
+}};
+
+auto tokenDisplayName(size_t type) -> std::string
+{
+    if (type == antlr4::Token::EOF)
+    {
+        return "EOF";
+    }
+    for (const auto &[token_type, name] : TOKEN_DISPLAY_NAMES)
+    {
+        if (token_type == type)
+        {
+            return std::string(name);
+        }
+    }
+    return std::to_string(type);
+}
+
+// Same escaping as antlr4::DefaultErrorStrategy::escapeWSAndQuote
+auto escapeWSAndQuote(const std::string &text) -> std::string
+{
+    std::string result = "'";
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '\n':
+            result += "\\n";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            result += c;
+            break;
+        }
+    }
+    return result + "'";
+}
+
+} // namespace
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseModel() -> Ref
+{
+    // model : MODELPROTO LBRACE model_body_def RBRACE
+    match(Lexer::MODELPROTO);
+    match(Lexer::LBRACE);
+
+    auto ir_version = parseIntegerDef(Lexer::IR_VERSION);
+    auto producer_name = parseStringDef(Lexer::PRODUCER_NAME);
+    auto producer_version = parseStringDef(Lexer::PRODUCER_VERSION);
+    auto model_domain = parseStringDef(Lexer::DOMAIN);
+    auto model_version = parseIntegerDef(Lexer::MODEL_VERSION);
+    auto doc_string = parseStringDef(Lexer::DOC_STRING);
+
+    // graph_def : GRAPH LBRACE name_def node_list input_list output_list initializer_list? RBRACE
+    match(Lexer::GRAPH);
+    match(Lexer::LBRACE);
+    auto graph_name = parseStringDef(Lexer::NAME);
+    auto node_list = parseNodeList();
+    auto input_list = parseInputList();
+    auto output_list = parseOutputList();
+    auto initializer_list = peekType() == Lexer::INITIALIZER ? parseInitializerList() : Builder::NONE;
+    match(Lexer::RBRACE);
+
+    // opset_import_def : OPSET_IMPORT LBRACE domain_def version_def RBRACE
+    match(Lexer::OPSET_IMPORT);
+    match(Lexer::LBRACE);
+    auto opset_domain = parseStringDef(Lexer::DOMAIN);
+    auto opset_version = parseIntegerDef(Lexer::VERSION);
+    match(Lexer::RBRACE);
+
+    match(Lexer::RBRACE);
+
+    if (!pending_error_.empty())
+    {
+        throw antlr4::ParseCancellationException(pending_error_);
+    }
+
+    return builder_.template make<ModelNode>(ir_version, producer_name, producer_version, model_domain,
+                                             model_version, doc_string, graph_name, node_list, input_list,
+                                             output_list, initializer_list, opset_domain, opset_version);
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::match(size_t type) -> antlr4::Token *
+{
+    auto *token = tokens_->LT(1);
+    if (token->getType() != type)
+    {
+        reportMissingToken();
+    }
+    tokens_->consume();
+    return token;
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::matchDataType() -> DataType
+{
+    // (INT | FLOAT | STRING | BOOL) is a set match in the generated parser
+    DataType type{};
+    switch (peekType())
+    {
+    case Lexer::INT:
+        type = DataType::INT;
+        break;
+    case Lexer::FLOAT:
+        type = DataType::FLOAT;
+        break;
+    case Lexer::STRING:
+        type = DataType::STRING;
+        break;
+    case Lexer::BOOL:
+        type = DataType::BOOL;
+        break;
+    default:
+        reportMissingToken();
+    }
+    tokens_->consume();
+    return type;
+}
+
+template <typename Builder> void BasicDirectParser<Builder>::reportMissingToken()
+{
+    throw antlr4::ParseCancellationException(ParserErrorStrategy::formatMissingToken(tokens_->LT(1)));
+}
+
+template <typename Builder>
+void BasicDirectParser<Builder>::reportNoViableAlternative(antlr4::Token *start, antlr4::Token *offending)
+{
+    std::string input;
+    if (start->getType() == antlr4::Token::EOF)
+    {
+        input = "<EOF>";
+    }
+    else
+    {
+        for (size_t i = start->getTokenIndex(); i <= offending->getTokenIndex(); ++i)
+        {
+            const auto *token = tokens_->get(i);
+            if (token->getType() == antlr4::Token::EOF)
+            {
+                break;
+            }
+            input += token->getText();
+        }
+    }
+    const auto message = "no viable alternative at input " + escapeWSAndQuote(input);
+    throw antlr4::ParseCancellationException(ParserErrorListener::formatMessage(
+        offending->getLine(), offending->getCharPositionInLine(), message, offending,
+        tokenDisplayName(offending->getType())));
+}
+
+template <typename Builder>
+void BasicDirectParser<Builder>::deferConstructionError(const antlr4::Token *start, const std::string &message)
+{
+    if (pending_error_.empty())
+    {
+        pending_error_ = constructionErrorMessage(start, message);
+    }
+}
+
+template <typename Builder>
+auto BasicDirectParser<Builder>::constructionErrorMessage(const antlr4::Token *start, const std::string &message)
+    -> std::string
+{
+    // Mirrors ASTConstructionVisitor::reportError, where start is the first token of the rule
+    std::ostringstream errorMsg;
+    errorMsg << "FATAL AST construction error at line " << start->getLine() << ", column "
+             << (start->getCharPositionInLine() + 1) << ": " << message;
+    return errorMsg.str();
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::makeStrLiteral(const antlr4::Token *literal) -> Ref
+{
+    const auto id = names_.intern(Literal2Cpp::stringLiteral2CppString(literal->getText()));
+    return builder_.template make<StrLiteralNode>(id, names_.view(id));
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::makeIntegerLiteral(const antlr4::Token *literal) -> Ref
+{
+    const auto integer = Literal2Cpp::integerLiteral2CppInteger(literal->getText());
+    if (std::holds_alternative<uint32_t>(integer))
+    {
+        return builder_.template make<U32LiteralNode>(std::get<uint32_t>(integer));
+    }
+    return builder_.template make<U64LiteralNode>(std::get<uint64_t>(integer));
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseIntegerDef(size_t keyword) -> Ref
+{
+    // KEYWORD ASSIGN INTEGER_LITERAL
+    const auto *start = match(keyword);
+    match(Lexer::ASSIGN);
+    const auto *literal = match(Lexer::INTEGER_LITERAL);
+    try
+    {
+        return makeIntegerLiteral(literal);
+    }
+    catch (const std::exception &e)
+    {
+        deferConstructionError(start, std::string("Failed to parse integer value: ") + e.what());
+        return builder_.template make<ErrorNode>();
+    }
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseStringDef(size_t keyword) -> Ref
+{
+    // KEYWORD ASSIGN STRING_LITERAL
+    match(keyword);
+    match(Lexer::ASSIGN);
+    const auto *literal = match(Lexer::STRING_LITERAL);
+    return makeStrLiteral(literal);
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseNodeList() -> Ref
+{
+    // node_list : (NODE LBRACE node_def RBRACE)+
+    std::vector<Ref> nodes{};
+    do
+    {
+        match(Lexer::NODE);
+        match(Lexer::LBRACE);
+        nodes.push_back(parseNodeDef());
+        match(Lexer::RBRACE);
+    } while (peekType() == Lexer::NODE);
+    return builder_.template makeList<NodeListNode>(nodes);
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseNodeDef() -> Ref
+{
+    // node_def : op_type_def name_def (input_list | input_arr) (output_list | output_arr) attribute_list?
+    auto op_type = parseStringDef(Lexer::OP_TYPE);
+    auto name = parseStringDef(Lexer::NAME);
+
+    // Both alternatives start with the same keyword, so these are the two LL(2) decisions of the grammar
+    Ref input = Builder::NONE;
+    if (peekType() == Lexer::INPUT && peekType(2) == Lexer::LBRACE)
+    {
+        input = parseInputList();
+    }
+    else if (peekType() == Lexer::INPUT && peekType(2) == Lexer::ASSIGN)
+    {
+        input = builder_.template makeList<InputArrNode>(parseStringArray(Lexer::INPUT));
+    }
+    else
+    {
+        reportNoViableAlternative(tokens_->LT(1), peekType() == Lexer::INPUT ? tokens_->LT(2) : tokens_->LT(1));
+    }
+
+    Ref output = Builder::NONE;
+    if (peekType() == Lexer::OUTPUT && peekType(2) == Lexer::LBRACE)
+    {
+        output = parseOutputList();
+    }
+    else if (peekType() == Lexer::OUTPUT && peekType(2) == Lexer::ASSIGN)
+    {
+        output = builder_.template makeList<OutputArrNode>(parseStringArray(Lexer::OUTPUT));
+    }
+    else
+    {
+        reportNoViableAlternative(tokens_->LT(1), peekType() == Lexer::OUTPUT ? tokens_->LT(2) : tokens_->LT(1));
+    }
+
+    auto attribute_list = peekType() == Lexer::ATTRIBUTE ? parseAttributeList() : Builder::NONE;
+
+    return builder_.template make<NodeNode>(op_type, name, input, output, attribute_list);
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseInputList() -> Ref
+{
+    return builder_.template makeList<InputListNode>(parseValueInfoList(Lexer::INPUT));
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseOutputList() -> Ref
+{
+    return builder_.template makeList<OutputListNode>(parseValueInfoList(Lexer::OUTPUT));
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseValueInfoList(size_t keyword) -> std::vector<Ref>
+{
+    // (KEYWORD LBRACE value_info_def RBRACE)+
+    std::vector<Ref> io_tensors{};
+    do
+    {
+        match(keyword);
+        match(Lexer::LBRACE);
+        io_tensors.push_back(parseValueInfoDef());
+        match(Lexer::RBRACE);
+    } while (peekType() == keyword);
+    return io_tensors;
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseInitializerList() -> Ref
+{
+    // initializer_list : (INITIALIZER LBRACE tensor_def RBRACE)+
+    std::vector<Ref> initializers{};
+    do
+    {
+        match(Lexer::INITIALIZER);
+        match(Lexer::LBRACE);
+        initializers.push_back(parseTensorDef());
+        match(Lexer::RBRACE);
+    } while (peekType() == Lexer::INITIALIZER);
+    return builder_.template makeList<InitializerListNode>(initializers);
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseStringArray(size_t keyword) -> std::vector<Ref>
+{
+    // KEYWORD ASSIGN LBRACKET STRING_LITERAL (COMMA STRING_LITERAL)* RBRACKET
+    std::vector<Ref> elements{};
+    match(keyword);
+    match(Lexer::ASSIGN);
+    match(Lexer::LBRACKET);
+    const auto *literal = match(Lexer::STRING_LITERAL);
+    elements.push_back(makeStrLiteral(literal));
+    while (peekType() == Lexer::COMMA)
+    {
+        match(Lexer::COMMA);
+        literal = match(Lexer::STRING_LITERAL);
+        elements.push_back(makeStrLiteral(literal));
+    }
+    match(Lexer::RBRACKET);
+    return elements;
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseAttributeList() -> Ref
+{
+    // attribute_list : (ATTRIBUTE LBRACE name_def value_def RBRACE)+
+    std::vector<Ref> attributes{};
+    do
+    {
+        match(Lexer::ATTRIBUTE);
+        match(Lexer::LBRACE);
+        auto name = parseStringDef(Lexer::NAME);
+        auto value = parseStringDef(Lexer::VALUE);
+        attributes.push_back(builder_.template make<AttributeNode>(name, value));
+        match(Lexer::RBRACE);
+    } while (peekType() == Lexer::ATTRIBUTE);
+    return builder_.template makeList<AttributeListNode>(attributes);
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseValueInfoDef() -> Ref
+{
+    // value_info_def : name_def TYPE LBRACE TENSOR_TYPE LBRACE elem_type_def shape_def RBRACE RBRACE
+    auto name = parseStringDef(Lexer::NAME);
+    match(Lexer::TYPE);
+    match(Lexer::LBRACE);
+    match(Lexer::TENSOR_TYPE);
+    match(Lexer::LBRACE);
+
+    match(Lexer::ELEM_TYPE);
+    match(Lexer::ASSIGN);
+    auto type = builder_.template make<TypeEnumNode>(matchDataType());
+
+    // shape_def : SHAPE LBRACE (DIM LBRACE dim_def RBRACE)+ RBRACE
+    match(Lexer::SHAPE);
+    match(Lexer::LBRACE);
+    std::vector<Ref> io_dims{};
+    do
+    {
+        match(Lexer::DIM);
+        match(Lexer::LBRACE);
+        io_dims.push_back(parseDimDef());
+        match(Lexer::RBRACE);
+    } while (peekType() == Lexer::DIM);
+    match(Lexer::RBRACE);
+
+    match(Lexer::RBRACE);
+    match(Lexer::RBRACE);
+
+    return builder_.template make<IOTensorNode>(name, type, builder_.template makeList<IOShapeNode>(io_dims));
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseDimDef() -> Ref
+{
+    // dim_def : DIM_VALUE ASSIGN INTEGER_LITERAL | DIM_PARAM ASSIGN STRING_LITERAL
+    switch (peekType())
+    {
+    case Lexer::DIM_VALUE: {
+        const auto *start = match(Lexer::DIM_VALUE);
+        match(Lexer::ASSIGN);
+        const auto *literal = match(Lexer::INTEGER_LITERAL);
+        try
+        {
+            return makeIntegerLiteral(literal);
+        }
+        catch (const std::exception &e)
+        {
+            // The visitor wraps the integer error once more in visitDim_def
+            deferConstructionError(
+                start, "Failed to construct dimension: " +
+                           constructionErrorMessage(start, std::string("Failed to parse integer value: ") + e.what()));
+            return builder_.template make<ErrorNode>();
+        }
+    }
+    case Lexer::DIM_PARAM: {
+        match(Lexer::DIM_PARAM);
+        match(Lexer::ASSIGN);
+        const auto *literal = match(Lexer::STRING_LITERAL);
+        return makeStrLiteral(literal);
+    }
+    default:
+        reportNoViableAlternative(tokens_->LT(1), tokens_->LT(1));
+    }
+}
+
+template <typename Builder> auto BasicDirectParser<Builder>::parseTensorDef() -> Ref
+{
+    // tensor_def : name_def data_type_def dims_def raw_data_def
+    auto name = parseStringDef(Lexer::NAME);
+
+    match(Lexer::DATA_TYPE);
+    match(Lexer::ASSIGN);
+    auto type = builder_.template make<TypeEnumNode>(matchDataType());
+
+    // dims_def : DIMS ASSIGN INTEGER_LITERAL+
+    match(Lexer::DIMS);
+    match(Lexer::ASSIGN);
+    std::vector<Ref> dim_values{};
+    do
+    {
+        const auto *literal = match(Lexer::INTEGER_LITERAL);
+        try
+        {
+            dim_values.push_back(makeIntegerLiteral(literal));
+        }
+        catch (const std::out_of_range &)
+        {
+            dim_values.push_back(builder_.template make<ErrorNode>());
+        }
+    } while (peekType() == Lexer::INTEGER_LITERAL);
+    // Built before the raw data so that the flat form stays in post-order
+    auto shape = builder_.template makeList<InitShapeNode>(dim_values);
+
+    // raw_data_def : RAW_DATA ASSIGN BYTES_LITERAL
+    const auto *start = match(Lexer::RAW_DATA);
+    match(Lexer::ASSIGN);
+    const auto *literal = match(Lexer::BYTES_LITERAL);
+    Ref raw_data = Builder::NONE;
+    try
+    {
+        auto text = source_.substr(literal->getStartIndex(), literal->getStopIndex() - literal->getStartIndex() + 1);
+        raw_data = builder_.template make<BytesLiteralNode>(Literal2Cpp::bytesLiteral2HexDigits(text));
+    }
+    catch (const std::exception &e)
+    {
+        deferConstructionError(start, std::string("Failed to parse bytes literal: ") + e.what());
+        raw_data = builder_.template make<ErrorNode>();
+    }
+
+    return builder_.template make<InitTensorNode>(name, type, shape, raw_data);
+}
+
+template class BasicDirectParser<TreeBuilder>;
+template class BasicDirectParser<FlatBuilder>;
+
+} // namespace sonnx
@@ -0,0 +1,79 @@
+#ifndef DIRECT_PARSER_HPP
+#define DIRECT_PARSER_HPP
+
+#include "antlr4-runtime.h"
+#include "ast/ASTBuilder.hpp"
+#include "utils/StringInterner.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sonnx
+{
+
+// Recursive-descent parser for S_ONNX that builds the AST in a single pass over the tokens,
+// without an ANTLR parse tree and without ASTConstructionVisitor's node stack.
+// Produces the same AST and the same diagnostics as the S_ONNXParser + ASTConstructionVisitor
+// pipeline: syntax errors are formatted by ParserErrorListener / ParserErrorStrategy, and
+// literal conversion errors are held back until the whole model has parsed, because the
+// visitor only runs once the parse tree is complete.
+// Builder is TreeBuilder or FlatBuilder (see ast/ASTBuilder.hpp) and decides which form the AST takes.
+template <typename Builder> class BasicDirectParser
+{
+  public:
+    using Ref = typename Builder::Ref;
+
+    // String literals are interned in names; it must outlive the AST, as must whatever builder writes to
+    BasicDirectParser(antlr4::TokenStream *tokens, Builder &builder, StringInterner &names, std::string_view source)
+        : tokens_(tokens), builder_(builder), names_(names), source_(source)
+    {
+    }
+
+    // The model node
+    auto parseModel() -> Ref;
+
+  private:
+    antlr4::TokenStream *tokens_;
+    Builder &builder_;
+    StringInterner &names_;
+    // Model source the token offsets refer to; bytes literals are kept as views into it
+    std::string_view source_;
+    std::string pending_error_;
+
+    // Token handling
+    auto peekType(ssize_t k = 1) -> size_t
+    {
+        return tokens_->LA(k);
+    }
+    auto match(size_t type) -> antlr4::Token *;
+    auto matchDataType() -> DataType;
+    [[noreturn]] void reportMissingToken();
+    [[noreturn]] void reportNoViableAlternative(antlr4::Token *start, antlr4::Token *offending);
+    void deferConstructionError(const antlr4::Token *start, const std::string &message);
+    static auto constructionErrorMessage(const antlr4::Token *start, const std::string &message) -> std::string;
+
+    auto makeStrLiteral(const antlr4::Token *literal) -> Ref;
+    auto makeIntegerLiteral(const antlr4::Token *literal) -> Ref;
+
+    // One method per grammar rule that produces an AST node
+    auto parseIntegerDef(size_t keyword) -> Ref;
+    auto parseStringDef(size_t keyword) -> Ref;
+    auto parseNodeList() -> Ref;
+    auto parseNodeDef() -> Ref;
+    auto parseInputList() -> Ref;
+    auto parseOutputList() -> Ref;
+    auto parseInitializerList() -> Ref;
+    auto parseStringArray(size_t keyword) -> std::vector<Ref>;
+    auto parseAttributeList() -> Ref;
+    auto parseValueInfoDef() -> Ref;
+    auto parseDimDef() -> Ref;
+    auto parseTensorDef() -> Ref;
+    auto parseValueInfoList(size_t keyword) -> std::vector<Ref>;
+};
+
+using DirectParser = BasicDirectParser<TreeBuilder>;
+using FlatDirectParser = BasicDirectParser<FlatBuilder>;
+
+} // namespace sonnx
+
+#endif // DIRECT_PARSER_HPP
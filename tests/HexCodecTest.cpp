@@ -0,0 +1,201 @@
+// Checks every hex kernel this CPU can run against the scalar code
+#include "utils/HexCodec.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using sonnx::HexCodec;
+
+namespace
+{
+
+constexpr std::string_view DECODERS[] = {"avx512bw", "avx2", "sse4.1", "scalar"};
+constexpr std::string_view ENCODERS[] = {"avx2", "ssse3", "scalar"};
+
+int failures = 0;
+
+void fail(std::string_view kernel, const std::string &what)
+{
+    std::cerr << "FAIL [" << kernel << "] " << what << '\n';
+    ++failures;
+}
+
+// Long enough to cover several blocks of the widest kernel plus every tail length
+auto makeDigits(std::mt19937 &random, size_t size) -> std::string
+{
+    static constexpr std::string_view ALPHABET = "0123456789abcdefABCDEF";
+    std::string digits(size, '0');
+    for (auto &digit : digits)
+    {
+        digit = ALPHABET[random() % ALPHABET.size()];
+    }
+    return digits;
+}
+
+// The kernel must agree with decodeScalar on the result and on every byte it promises to have written
+void checkDecode(std::string_view kernel, const std::string &digits, const std::string &label)
+{
+    std::vector<uint8_t> expected(digits.size() / 2 + 1, 0xAA);
+    std::vector<uint8_t> actual(expected.size(), 0xAA);
+    const auto expected_result = HexCodec::decodeScalar(digits, expected.data());
+    size_t result = 0;
+    if (!HexCodec::decodeWith(kernel, digits, actual.data(), result))
+    {
+        return;
+    }
+    if (result != expected_result)
+    {
+        fail(kernel, label + ": returned " + std::to_string(result) + ", scalar " + std::to_string(expected_result));
+        return;
+    }
+    const auto written = std::min(result, digits.size()) / 2;
+    if (!std::equal(expected.begin(), expected.begin() + static_cast<std::ptrdiff_t>(written), actual.begin()))
+    {
+        fail(kernel, label + ": decoded bytes differ");
+    }
+}
+
+void checkValidate(const std::string &digits, const std::string &label)
+{
+    size_t expected = digits.size();
+    bool expected_upper = false;
+    for (size_t i = 0; i < digits.size(); ++i)
+    {
+        const auto c = digits[i];
+        const bool is_upper = c >= 'A' && c <= 'F';
+        if (!(c >= '0' && c <= '9') && !(c >= 'a' && c <= 'f') && !is_upper)
+        {
+            expected = i;
+            break;
+        }
+        expected_upper = expected_upper || is_upper;
+    }
+    bool upper = false;
+    if (HexCodec::validate(digits, upper) != expected || upper != expected_upper)
+    {
+        fail("validate", label);
+    }
+}
+
+void testEveryByteValue()
+{
+    std::vector<uint8_t> bytes;
+    for (int repeat = 0; repeat < 3; ++repeat)
+    {
+        for (int value = 0; value < 256; ++value)
+        {
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+    }
+    std::string expected(bytes.size() * 2, '\0');
+    HexCodec::encodeScalar(bytes.data(), bytes.size(), expected.data());
+    for (const auto kernel : ENCODERS)
+    {
+        // Every length, so that each kernel also runs with every tail length
+        for (size_t size = 0; size <= bytes.size(); size += size < 130 ? 1 : 37)
+        {
+            std::string actual(size * 2, '\0');
+            if (HexCodec::encodeWith(kernel, bytes.data(), size, actual.data()) &&
+                std::string_view(actual) != std::string_view(expected).substr(0, size * 2))
+            {
+                fail(kernel, "encode of " + std::to_string(size) + " bytes");
+            }
+        }
+    }
+
+    std::string upper = expected;
+    for (auto &digit : upper)
+    {
+        digit = digit >= 'a' ? static_cast<char>(digit - 'a' + 'A') : digit;
+    }
+    for (const auto kernel : DECODERS)
+    {
+        for (const auto &digits : {expected, upper})
+        {
+            std::vector<uint8_t> decoded(bytes.size());
+            size_t result = 0;
+            if (HexCodec::decodeWith(kernel, digits, decoded.data(), result) &&
+                (result != digits.size() || decoded != bytes))
+            {
+                fail(kernel, "decode of every byte value");
+            }
+        }
+    }
+    checkValidate(expected, "every byte value");
+    checkValidate(upper, "every byte value, upper case");
+}
+
+void testLengthsAndInvalidDigits()
+{
+    std::mt19937 random(2024);
+    for (size_t size = 0; size <= 300; ++size)
+    {
+        const auto digits = makeDigits(random, size);
+        const auto label = std::to_string(size) + " digits";
+        for (const auto kernel : DECODERS)
+        {
+            checkDecode(kernel, digits, label);
+        }
+        checkValidate(digits, label);
+
+        // One invalid character at each position, including a dangling last digit of an odd length
+        for (size_t position = 0; position < size; position += size < 64 ? 1 : 7)
+        {
+            for (const char invalid : {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\x80', '\xff'})
+            {
+                auto broken = digits;
+                broken[position] = invalid;
+                const auto broken_label = label + ", invalid at " + std::to_string(position);
+                for (const auto kernel : DECODERS)
+                {
+                    checkDecode(kernel, broken, broken_label);
+                }
+                checkValidate(broken, broken_label);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::cout << "selected decoder: " << HexCodec::decoderName() << ", encoder: " << HexCodec::encoderName() << '\n';
+    for (const auto kernel : DECODERS)
+    {
+        size_t result = 0;
+        const bool runs = HexCodec::decodeWith(kernel, {}, nullptr, result);
+        std::cout << "decoder " << kernel << (runs ? ": checked" : ": not supported here, skipped") << '\n';
+    }
+    for (const auto kernel : ENCODERS)
+    {
+        const bool runs = HexCodec::encodeWith(kernel, nullptr, 0, nullptr);
+        std::cout << "encoder " << kernel << (runs ? ": checked" : ": not supported here, skipped") << '\n';
+    }
+
+    testEveryByteValue();
+    testLengthsAndInvalidDigits();
+
+    // The dispatched entry points must be the selected kernels
+    const std::string digits = "00ff7f80A5c3";
+    std::vector<uint8_t> selected(digits.size() / 2);
+    std::vector<uint8_t> named(digits.size() / 2);
+    size_t result = 0;
+    if (HexCodec::decode(digits, selected.data()) != digits.size() ||
+        !HexCodec::decodeWith(HexCodec::decoderName(), digits, named.data(), result) || selected != named)
+    {
+        fail(HexCodec::decoderName(), "decode does not match the selected kernel");
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    std::cout << "all hex codec checks passed\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "Attributes.hpp"
+#include <limits>
+
+namespace sonnx
+{
+
+auto Attributes::find(const List &attributes, std::string_view name) -> std::optional<std::string_view>
+{
+    for (const auto &[attribute_name, value] : attributes)
+    {
+        if (attribute_name == name)
+        {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+auto Attributes::parseIntegers(std::string_view text) -> std::optional<std::vector<int64_t>>
+{
+    std::vector<int64_t> values;
+    size_t i = 0;
+    const auto skip = [&] {
+        while (i < text.size() && (text[i] == ' ' || text[i] == ',' || text[i] == '[' || text[i] == ']'))
+        {
+            ++i;
+        }
+    };
+    for (skip(); i < text.size(); skip())
+    {
+        const bool negative = text[i] == '-';
+        if (negative || text[i] == '+')
+        {
+            ++i;
+        }
+        if (i == text.size() || text[i] < '0' || text[i] > '9')
+        {
+            return std::nullopt;
+        }
+        uint64_t magnitude = 0;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+        {
+            magnitude = magnitude * 10 + static_cast<uint64_t>(text[i] - '0');
+            if (magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+            {
+                return std::nullopt;
+            }
+        }
+        values.push_back(negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude));
+    }
+    return values;
+}
+
+auto Attributes::findIntegers(const List &attributes, std::string_view name) -> std::optional<std::vector<int64_t>>
+{
+    const auto text = find(attributes, name);
+    return text ? parseIntegers(*text) : std::nullopt;
+}
+
+auto Attributes::findInteger(const List &attributes, std::string_view name, const int64_t fallback)
+    -> std::optional<int64_t>
+{
+    const auto text = find(attributes, name);
+    if (!text)
+    {
+        return fallback;
+    }
+    const auto values = parseIntegers(*text);
+    if (!values || values->size() != 1)
+    {
+        return std::nullopt;
+    }
+    return values->front();
+}
+
+auto Attributes::parseDataType(std::string_view text) -> std::optional<DataType>
+{
+    if (text == "FLOAT" || text == "float" || text == "1")
+    {
+        return DataType::FLOAT;
+    }
+    if (text == "INT" || text == "int" || text == "INT64" || text == "int64" || text == "7")
+    {
+        return DataType::INT;
+    }
+    if (text == "BOOL" || text == "bool" || text == "9")
+    {
+        return DataType::BOOL;
+    }
+    if (text == "STRING" || text == "string" || text == "8")
+    {
+        return DataType::STRING;
+    }
+    return std::nullopt;
+}
+
+} // namespace sonnx
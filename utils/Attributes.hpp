@@ -0,0 +1,37 @@
+#ifndef ATTRIBUTES_HPP
+#define ATTRIBUTES_HPP
+
+#include "ast/AST.hpp"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sonnx
+{
+
+// Reading node attributes, whose values are kept as the text written in the model
+class Attributes
+{
+  public:
+    // Name and value of one attribute
+    using Entry = std::pair<std::string_view, std::string_view>;
+    using List = std::vector<Entry>;
+
+    // Value of the first attribute called name
+    static auto find(const List &attributes, std::string_view name) -> std::optional<std::string_view>;
+    // Accepts "1", "-1" and lists such as "[1, 0, 2]" or "1,0,2"
+    static auto parseIntegers(std::string_view text) -> std::optional<std::vector<int64_t>>;
+    // The integers of attribute name; nothing if it is absent or not a list of integers
+    static auto findIntegers(const List &attributes, std::string_view name) -> std::optional<std::vector<int64_t>>;
+    // The single integer of attribute name, fallback if it is absent; nothing if it is not one integer
+    static auto findInteger(const List &attributes, std::string_view name, int64_t fallback) -> std::optional<int64_t>;
+    // A tensor type, by name or by its ONNX TensorProto number, as in the "to" attribute of Cast. INT is int64;
+    // other widths, such as INT32 (6), have no DataType and give nothing, so a Cast to them is not folded
+    static auto parseDataType(std::string_view text) -> std::optional<DataType>;
+};
+
+} // namespace sonnx
+
+#endif // ATTRIBUTES_HPP
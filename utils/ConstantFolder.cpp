@@ -0,0 +1,615 @@
+#include "ConstantFolder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace sonnx
+{
+
+namespace
+{
+
+using Dims = std::vector<uint64_t>;
+
+// Element count of dims, or UINT64_MAX if it does not fit
+auto countElements(const Dims &dims) -> uint64_t
+{
+    uint64_t count = 1;
+    for (const auto dim : dims)
+    {
+        if (dim != 0 && count > std::numeric_limits<uint64_t>::max() / dim)
+        {
+            return std::numeric_limits<uint64_t>::max();
+        }
+        count *= dim;
+    }
+    return count;
+}
+
+// Typed copies in and out of the byte layout; memcpy keeps the access well-defined for any alignment. An empty
+// tensor is not copied, since its data() may be null and memcpy must not get a null pointer even for 0 bytes.
+template <typename T> auto load(const Constant &constant) -> std::vector<T>
+{
+    std::vector<T> values(constant.bytes.size() / sizeof(T));
+    if (!values.empty())
+    {
+        std::memcpy(values.data(), constant.bytes.data(), values.size() * sizeof(T));
+    }
+    return values;
+}
+
+template <typename T> auto store(DataType type, Dims dims, const std::vector<T> &values) -> Constant
+{
+    Constant result{type, std::move(dims), std::vector<uint8_t>(values.size() * sizeof(T))};
+    if (!values.empty())
+    {
+        std::memcpy(result.bytes.data(), values.data(), result.bytes.size());
+    }
+    return result;
+}
+
+// Axis in [-rank, rank) resolved to [0, rank)
+auto resolveAxis(int64_t axis, size_t rank) -> std::optional<size_t>
+{
+    const auto signed_rank = static_cast<int64_t>(rank);
+    if (axis < -signed_rank || axis >= signed_rank)
+    {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(axis < 0 ? axis + signed_rank : axis);
+}
+
+// Numpy-style broadcast of two shapes
+auto broadcastDims(const Dims &a, const Dims &b) -> std::optional<Dims>
+{
+    Dims result(std::max(a.size(), b.size()));
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        const auto a_dim = i < result.size() - a.size() ? 1 : a[i - (result.size() - a.size())];
+        const auto b_dim = i < result.size() - b.size() ? 1 : b[i - (result.size() - b.size())];
+        if (a_dim != b_dim && a_dim != 1 && b_dim != 1)
+        {
+            return std::nullopt;
+        }
+        result[i] = a_dim == 1 ? b_dim : a_dim;
+    }
+    return result;
+}
+
+// Element strides of dims as seen from a broadcast output of rank out_rank; 0 along broadcast axes
+auto broadcastStrides(const Dims &dims, size_t out_rank) -> Dims
+{
+    Dims strides(out_rank, 0);
+    uint64_t stride = 1;
+    for (size_t i = dims.size(); i-- > 0;)
+    {
+        strides[out_rank - dims.size() + i] = dims[i] == 1 ? 0 : stride;
+        stride *= dims[i];
+    }
+    return strides;
+}
+
+// out[i] = op(a[i'], b[i'']) over the broadcast shape. Equal shapes and scalar operands run as flat loops; the
+// general case walks the outer axes with a counter and runs the innermost one as a strided loop.
+template <typename T, typename Op>
+void broadcastApply(const std::vector<T> &a, const Dims &a_dims, const std::vector<T> &b, const Dims &b_dims,
+                    const Dims &out_dims, std::vector<T> &out, Op op)
+{
+    const auto count = out.size();
+    if (a.size() == count && b.size() == count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = op(a[i], b[i]);
+        }
+        return;
+    }
+    if (b.size() == 1 && a.size() == count)
+    {
+        const auto scalar = b[0];
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = op(a[i], scalar);
+        }
+        return;
+    }
+    if (a.size() == 1 && b.size() == count)
+    {
+        const auto scalar = a[0];
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = op(scalar, b[i]);
+        }
+        return;
+    }
+
+    const auto rank = out_dims.size();
+    const auto a_strides = broadcastStrides(a_dims, rank);
+    const auto b_strides = broadcastStrides(b_dims, rank);
+    const auto inner = out_dims[rank - 1];
+    const auto a_inner = a_strides[rank - 1];
+    const auto b_inner = b_strides[rank - 1];
+    Dims counter(rank, 0);
+    size_t a_offset = 0;
+    size_t b_offset = 0;
+    for (size_t base = 0; base < count; base += inner)
+    {
+        for (size_t j = 0; j < inner; ++j)
+        {
+            out[base + j] = op(a[a_offset + j * a_inner], b[b_offset + j * b_inner]);
+        }
+        // Advance the outer axes
+        for (size_t axis = rank - 1; axis-- > 0;)
+        {
+            a_offset += a_strides[axis];
+            b_offset += b_strides[axis];
+            if (++counter[axis] < out_dims[axis])
+            {
+                break;
+            }
+            a_offset -= a_strides[axis] * out_dims[axis];
+            b_offset -= b_strides[axis] * out_dims[axis];
+            counter[axis] = 0;
+        }
+    }
+}
+
+template <typename T>
+auto foldBinary(std::string_view op_type, const Constant &a, const Constant &b, const Dims &out_dims)
+    -> std::optional<Constant>
+{
+    const auto lhs = load<T>(a);
+    const auto rhs = load<T>(b);
+    std::vector<T> out(countElements(out_dims));
+    if constexpr (std::is_integral_v<T>)
+    {
+        // Wrap around on overflow like a runtime does, without signed overflow in the compiler
+        using U = std::make_unsigned_t<T>;
+        if (op_type == "Add")
+        {
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out,
+                           [](T x, T y) { return static_cast<T>(static_cast<U>(x) + static_cast<U>(y)); });
+        }
+        else if (op_type == "Sub")
+        {
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out,
+                           [](T x, T y) { return static_cast<T>(static_cast<U>(x) - static_cast<U>(y)); });
+        }
+        else if (op_type == "Mul")
+        {
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out,
+                           [](T x, T y) { return static_cast<T>(static_cast<U>(x) * static_cast<U>(y)); });
+        }
+        else
+        {
+            // Division by zero and the one overflowing quotient are left to the runtime
+            if (std::find(rhs.begin(), rhs.end(), T{0}) != rhs.end() ||
+                (std::find(rhs.begin(), rhs.end(), T{-1}) != rhs.end() &&
+                 std::find(lhs.begin(), lhs.end(), std::numeric_limits<T>::min()) != lhs.end()))
+            {
+                return std::nullopt;
+            }
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out, [](T x, T y) { return static_cast<T>(x / y); });
+        }
+    }
+    else
+    {
+        if (op_type == "Add")
+        {
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out, [](T x, T y) { return x + y; });
+        }
+        else if (op_type == "Sub")
+        {
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out, [](T x, T y) { return x - y; });
+        }
+        else if (op_type == "Mul")
+        {
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out, [](T x, T y) { return x * y; });
+        }
+        else
+        {
+            broadcastApply(lhs, a.dims, rhs, b.dims, out_dims, out, [](T x, T y) { return x / y; });
+        }
+    }
+    return store(a.type, out_dims, out);
+}
+
+auto foldElementwise(std::string_view op_type, const std::vector<const Constant *> &inputs) -> std::optional<Constant>
+{
+    if (inputs.size() != 2 || inputs[0]->type != inputs[1]->type)
+    {
+        return std::nullopt;
+    }
+    const auto out_dims = broadcastDims(inputs[0]->dims, inputs[1]->dims);
+    if (!out_dims || countElements(*out_dims) > ConstantFolder::MAX_RESULT_BYTES / 8)
+    {
+        return std::nullopt;
+    }
+    switch (inputs[0]->type)
+    {
+    case DataType::FLOAT:
+        return foldBinary<float>(op_type, *inputs[0], *inputs[1], *out_dims);
+    case DataType::INT:
+        return foldBinary<int64_t>(op_type, *inputs[0], *inputs[1], *out_dims);
+    default:
+        return std::nullopt;
+    }
+}
+
+// [M, K] x [K, N]; the i-k-j order keeps the innermost loop a contiguous multiply-add over a row of b and out
+template <typename T> auto foldMatMul(const Constant &a, const Constant &b) -> Constant
+{
+    const auto m = a.dims[0];
+    const auto k = a.dims[1];
+    const auto n = b.dims[1];
+    const auto lhs = load<T>(a);
+    const auto rhs = load<T>(b);
+    std::vector<T> out(m * n, T{});
+    for (size_t i = 0; i < m; ++i)
+    {
+        T *out_row = out.data() + i * n;
+        for (size_t p = 0; p < k; ++p)
+        {
+            const T scale = lhs[i * k + p];
+            const T *rhs_row = rhs.data() + p * n;
+            for (size_t j = 0; j < n; ++j)
+            {
+                if constexpr (std::is_integral_v<T>)
+                {
+                    using U = std::make_unsigned_t<T>;
+                    out_row[j] = static_cast<T>(static_cast<U>(out_row[j]) +
+                                                static_cast<U>(scale) * static_cast<U>(rhs_row[j]));
+                }
+                else
+                {
+                    out_row[j] += scale * rhs_row[j];
+                }
+            }
+        }
+    }
+    return store(a.type, {m, n}, out);
+}
+
+auto foldMatMul(const std::vector<const Constant *> &inputs) -> std::optional<Constant>
+{
+    if (inputs.size() != 2 || inputs[0]->type != inputs[1]->type || inputs[0]->dims.size() != 2 ||
+        inputs[1]->dims.size() != 2 || inputs[0]->dims[1] != inputs[1]->dims[0] ||
+        countElements({inputs[0]->dims[0], inputs[1]->dims[1]}) > ConstantFolder::MAX_RESULT_BYTES / 8)
+    {
+        return std::nullopt;
+    }
+    switch (inputs[0]->type)
+    {
+    case DataType::FLOAT:
+        return foldMatMul<float>(*inputs[0], *inputs[1]);
+    case DataType::INT:
+        return foldMatMul<int64_t>(*inputs[0], *inputs[1]);
+    default:
+        return std::nullopt;
+    }
+}
+
+// Moves whole elements, so it works on the bytes of any type
+auto foldTranspose(const std::vector<const Constant *> &inputs,
+                   const std::vector<ConstantFolder::Attribute> &attributes) -> std::optional<Constant>
+{
+    if (inputs.size() != 1)
+    {
+        return std::nullopt;
+    }
+    const auto &input = *inputs[0];
+    const auto rank = input.dims.size();
+
+    // Reverses the axes unless perm says otherwise
+    std::vector<size_t> perm(rank);
+    for (size_t i = 0; i < rank; ++i)
+    {
+        perm[i] = rank - 1 - i;
+    }
+    if (const auto text = Attributes::find(attributes, "perm"))
+    {
+        const auto values = Attributes::parseIntegers(*text);
+        if (!values || values->size() != rank)
+        {
+            return std::nullopt;
+        }
+        std::vector<bool> seen(rank, false);
+        for (size_t i = 0; i < rank; ++i)
+        {
+            const auto axis = resolveAxis((*values)[i], rank);
+            if (!axis || seen[*axis])
+            {
+                return std::nullopt;
+            }
+            seen[*axis] = true;
+            perm[i] = *axis;
+        }
+    }
+
+    // Axes of length 1 get stride 0, which is harmless since they are never stepped along
+    const auto in_strides = broadcastStrides(input.dims, rank);
+    Dims out_dims(rank);
+    Dims strides(rank);
+    for (size_t i = 0; i < rank; ++i)
+    {
+        out_dims[i] = input.dims[perm[i]];
+        strides[i] = in_strides[perm[i]];
+    }
+
+    const auto element_size = Constant::elementSize(input.type);
+    const auto count = input.elementCount();
+    Constant result{input.type, out_dims, std::vector<uint8_t>(input.bytes.size())};
+    Dims counter(rank, 0);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::memcpy(result.bytes.data() + i * element_size, input.bytes.data() + offset * element_size, element_size);
+        for (size_t axis = rank; axis-- > 0;)
+        {
+            offset += strides[axis];
+            if (++counter[axis] < out_dims[axis])
+            {
+                break;
+            }
+            offset -= strides[axis] * out_dims[axis];
+            counter[axis] = 0;
+        }
+    }
+    return result;
+}
+
+// The bytes stay as they are; only the dims change. A 0 keeps the input's dim, a -1 takes what is left.
+auto foldReshape(const std::vector<const Constant *> &inputs) -> std::optional<Constant>
+{
+    if (inputs.size() != 2 || inputs[1]->type != DataType::INT || inputs[1]->dims.size() != 1)
+    {
+        return std::nullopt;
+    }
+    const auto &input = *inputs[0];
+    const auto shape = load<int64_t>(*inputs[1]);
+
+    Dims out_dims(shape.size());
+    std::optional<size_t> inferred;
+    uint64_t known = 1;
+    for (size_t i = 0; i < shape.size(); ++i)
+    {
+        if (shape[i] == -1 && !inferred)
+        {
+            inferred = i;
+            continue;
+        }
+        if (shape[i] < 0 || (shape[i] == 0 && i >= input.dims.size()))
+        {
+            return std::nullopt;
+        }
+        out_dims[i] = shape[i] == 0 ? input.dims[i] : static_cast<uint64_t>(shape[i]);
+        known = countElements({known, out_dims[i]});
+    }
+    const auto count = input.elementCount();
+    if (inferred)
+    {
+        if (known == 0 || count % known != 0)
+        {
+            return std::nullopt;
+        }
+        out_dims[*inferred] = count / known;
+    }
+    if (countElements(out_dims) != count)
+    {
+        return std::nullopt;
+    }
+    return Constant{input.type, std::move(out_dims), input.bytes};
+}
+
+auto foldConcat(const std::vector<const Constant *> &inputs, const std::vector<ConstantFolder::Attribute> &attributes)
+    -> std::optional<Constant>
+{
+    const auto text = Attributes::find(attributes, "axis");
+    const auto values = text ? Attributes::parseIntegers(*text) : std::nullopt;
+    if (inputs.empty() || !values || values->size() != 1)
+    {
+        return std::nullopt;
+    }
+    const auto &first = *inputs[0];
+    const auto rank = first.dims.size();
+    const auto axis = resolveAxis(values->front(), rank);
+    if (!axis)
+    {
+        return std::nullopt;
+    }
+
+    auto out_dims = first.dims;
+    out_dims[*axis] = 0;
+    for (const auto *input : inputs)
+    {
+        if (input->type != first.type || input->dims.size() != rank)
+        {
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < rank; ++i)
+        {
+            if (i != *axis && input->dims[i] != first.dims[i])
+            {
+                return std::nullopt;
+            }
+        }
+        out_dims[*axis] += input->dims[*axis];
+    }
+
+    // Each input contributes one contiguous block per index of the axes before axis
+    const auto element_size = Constant::elementSize(first.type);
+    uint64_t outer = 1;
+    uint64_t inner = element_size;
+    for (size_t i = 0; i < *axis; ++i)
+    {
+        outer *= first.dims[i];
+    }
+    for (size_t i = *axis + 1; i < rank; ++i)
+    {
+        inner *= first.dims[i];
+    }
+    if (countElements(out_dims) > ConstantFolder::MAX_RESULT_BYTES / element_size)
+    {
+        return std::nullopt;
+    }
+    Constant result{first.type, out_dims, {}};
+    result.bytes.reserve(countElements(out_dims) * element_size);
+    for (uint64_t o = 0; o < outer; ++o)
+    {
+        for (const auto *input : inputs)
+        {
+            const auto block = input->dims[*axis] * inner;
+            const auto *begin = input->bytes.data() + o * block;
+            result.bytes.insert(result.bytes.end(), begin, begin + block);
+        }
+    }
+    return result;
+}
+
+template <typename From> auto castValues(const Constant &input, DataType to) -> std::optional<Constant>
+{
+    const auto values = load<From>(input);
+    switch (to)
+    {
+    case DataType::FLOAT: {
+        std::vector<float> out(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            out[i] = static_cast<float>(values[i]);
+        }
+        return store(to, input.dims, out);
+    }
+    case DataType::INT: {
+        std::vector<int64_t> out(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            if constexpr (std::is_floating_point_v<From>)
+            {
+                // NaN and values outside int64 have no defined result; leave them to the runtime
+                if (!(values[i] > -9.2233720368547758e18F && values[i] < 9.2233720368547758e18F))
+                {
+                    return std::nullopt;
+                }
+            }
+            out[i] = static_cast<int64_t>(values[i]);
+        }
+        return store(to, input.dims, out);
+    }
+    case DataType::BOOL: {
+        std::vector<uint8_t> out(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            out[i] = values[i] != From{} ? 1 : 0;
+        }
+        return store(to, input.dims, out);
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+auto foldCast(const std::vector<const Constant *> &inputs, const std::vector<ConstantFolder::Attribute> &attributes)
+    -> std::optional<Constant>
+{
+    const auto text = Attributes::find(attributes, "to");
+    const auto to = text ? Attributes::parseDataType(*text) : std::nullopt;
+    if (inputs.size() != 1 || !to)
+    {
+        return std::nullopt;
+    }
+    const auto &input = *inputs[0];
+    switch (input.type)
+    {
+    case DataType::FLOAT:
+        return castValues<float>(input, *to);
+    case DataType::INT:
+        return castValues<int64_t>(input, *to);
+    case DataType::BOOL:
+        return castValues<uint8_t>(input, *to);
+    default:
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+auto Constant::elementSize(const DataType type) -> size_t
+{
+    switch (type)
+    {
+    case DataType::FLOAT:
+        return sizeof(float);
+    case DataType::INT:
+        return sizeof(int64_t);
+    case DataType::BOOL:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+auto Constant::elementCount() const -> uint64_t
+{
+    return countElements(dims);
+}
+
+auto Constant::isWellFormed() const -> bool
+{
+    const auto element_size = elementSize(type);
+    const auto count = elementCount();
+    return element_size != 0 && count <= bytes.size() && count * element_size == bytes.size();
+}
+
+auto ConstantFolder::supports(std::string_view op_type) -> bool
+{
+    static constexpr std::string_view OPS[] = {"Add",       "Sub",     "Mul",    "Div", "MatMul",
+                                               "Transpose", "Reshape", "Concat", "Cast"};
+    return std::find(std::begin(OPS), std::end(OPS), op_type) != std::end(OPS);
+}
+
+auto ConstantFolder::fold(std::string_view op_type, const std::vector<const Constant *> &inputs,
+                          const std::vector<Attribute> &attributes) -> std::optional<Constant>
+{
+    for (const auto *input : inputs)
+    {
+        if (!input || !input->isWellFormed())
+        {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<Constant> result;
+    if (op_type == "Add" || op_type == "Sub" || op_type == "Mul" || op_type == "Div")
+    {
+        result = foldElementwise(op_type, inputs);
+    }
+    else if (op_type == "MatMul")
+    {
+        result = foldMatMul(inputs);
+    }
+    else if (op_type == "Transpose")
+    {
+        result = foldTranspose(inputs, attributes);
+    }
+    else if (op_type == "Reshape")
+    {
+        result = foldReshape(inputs);
+    }
+    else if (op_type == "Concat")
+    {
+        result = foldConcat(inputs, attributes);
+    }
+    else if (op_type == "Cast")
+    {
+        result = foldCast(inputs, attributes);
+    }
+
+    if (result && result->bytes.size() > MAX_RESULT_BYTES)
+    {
+        return std::nullopt;
+    }
+    return result;
+}
+
+} // namespace sonnx
@@ -0,0 +1,51 @@
+#ifndef CONSTANT_FOLDER_HPP
+#define CONSTANT_FOLDER_HPP
+
+#include "Attributes.hpp"
+#include "ast/AST.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace sonnx
+{
+
+// A tensor whose value is known at compile time, in raw_data layout: FLOAT elements are little-endian float32,
+// INT elements little-endian int64 and BOOL elements one byte each. STRING tensors are never folded.
+struct Constant
+{
+    DataType type = DataType::UNDEFINED;
+    std::vector<uint64_t> dims;
+    std::vector<uint8_t> bytes;
+
+    // Bytes per element, or 0 for a type the kernels do not handle
+    static auto elementSize(DataType type) -> size_t;
+    [[nodiscard]] auto elementCount() const -> uint64_t;
+    // The type is foldable and the byte count matches the dims
+    [[nodiscard]] auto isWellFormed() const -> bool;
+};
+
+// CPU reference kernels that evaluate a node on constant inputs. Each kernel runs over contiguous arrays in
+// plain loops that the compiler vectorizes; floating-point results follow float32 arithmetic, though sums in
+// MatMul may round differently from a runtime that orders them otherwise.
+class ConstantFolder
+{
+  public:
+    using Attribute = Attributes::Entry;
+
+    // Results larger than this stay computed at inference time rather than bloating the TAC
+    static constexpr size_t MAX_RESULT_BYTES = 64 << 20;
+
+    // Whether op_type has a kernel: Add, Sub, Mul, Div, MatMul, Transpose, Reshape, Concat or Cast
+    static auto supports(std::string_view op_type) -> bool;
+    // Evaluates a single-output node. Returns nothing if the types, shapes or attributes are outside what the
+    // kernels handle, in which case the node is left in place.
+    static auto fold(std::string_view op_type, const std::vector<const Constant *> &inputs,
+                     const std::vector<Attribute> &attributes) -> std::optional<Constant>;
+};
+
+} // namespace sonnx
+
+#endif // CONSTANT_FOLDER_HPP
@@ -0,0 +1,404 @@
+#include "HexCodec.hpp"
+#include <array>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SONNX_HEX_CODEC_X86
+#include <immintrin.h>
+#endif
+
+namespace sonnx
+{
+
+namespace
+{
+
+constexpr uint8_t INVALID_NIBBLE = 0xFF;
+
+constexpr auto makeNibbleTable() -> std::array<uint8_t, 256>
+{
+    std::array<uint8_t, 256> table{};
+    for (auto &entry : table)
+    {
+        entry = INVALID_NIBBLE;
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        table['0' + i] = static_cast<uint8_t>(i);
+    }
+    for (int i = 0; i < 6; ++i)
+    {
+        table['a' + i] = static_cast<uint8_t>(10 + i);
+        table['A' + i] = static_cast<uint8_t>(10 + i);
+    }
+    return table;
+}
+
+constexpr auto NIBBLE_TABLE = makeNibbleTable();
+constexpr std::array<char, 16> HEX_DIGITS{'0', '1', '2', '3', '4', '5', '6', '7',
+                                          '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+// A kernel decodes whole blocks only and stops in front of the first block holding an invalid digit;
+// it returns the number of digits consumed and leaves the rest, including the error, to the scalar code
+using DecodeKernel = size_t (*)(const char *in, size_t size, uint8_t *out);
+
+// Likewise, an encode kernel converts whole blocks and returns the number of bytes consumed
+using EncodeKernel = size_t (*)(const uint8_t *in, size_t size, char *out);
+
+template <typename Kernel> struct Selected
+{
+    Kernel kernel;
+    const char *name;
+};
+
+#ifdef SONNX_HEX_CODEC_X86
+
+// Digits become 0-15; valid is set to all-ones in every lane holding [0-9a-fA-F]
+__attribute__((target("sse4.1"))) inline auto nibblesSse(__m128i chunk, __m128i &valid) -> __m128i
+{
+    const __m128i digit = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i alpha = _mm_sub_epi8(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    valid = _mm_or_si128(is_digit, is_alpha);
+    return _mm_blendv_epi8(_mm_add_epi8(alpha, _mm_set1_epi8(10)), digit, is_digit);
+}
+
+// 32 digits -> 16 bytes per iteration
+__attribute__((target("sse4.1"))) auto decodeSse41(const char *in, size_t size, uint8_t *out) -> size_t
+{
+    // Each 16-bit lane holds (high nibble, low nibble); multiply-add folds them into high * 16 + low
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32)
+    {
+        __m128i valid_lo;
+        __m128i valid_hi;
+        const __m128i lo = nibblesSse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + offset)), valid_lo);
+        const __m128i hi = nibblesSse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + offset + 16)), valid_hi);
+        if (_mm_movemask_epi8(_mm_and_si128(valid_lo, valid_hi)) != 0xFFFF)
+        {
+            break;
+        }
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(lo, weights), _mm_maddubs_epi16(hi, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + offset / 2), bytes);
+    }
+    return offset;
+}
+
+__attribute__((target("avx2"))) inline auto nibblesAvx2(__m256i chunk, __m256i &valid) -> __m256i
+{
+    const __m256i digit = _mm256_sub_epi8(chunk, _mm256_set1_epi8('0'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+    valid = _mm256_or_si256(is_digit, is_alpha);
+    return _mm256_blendv_epi8(_mm256_add_epi8(alpha, _mm256_set1_epi8(10)), digit, is_digit);
+}
+
+// 64 digits -> 32 bytes per iteration
+__attribute__((target("avx2"))) auto decodeAvx2(const char *in, size_t size, uint8_t *out) -> size_t
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t offset = 0;
+    for (; offset + 64 <= size; offset += 64)
+    {
+        __m256i valid_lo;
+        __m256i valid_hi;
+        const __m256i lo =
+            nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + offset)), valid_lo);
+        const __m256i hi =
+            nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + offset + 32)), valid_hi);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid_lo, valid_hi)) != -1)
+        {
+            break;
+        }
+        // packus works per 128-bit lane, so restore the order of the 64-bit groups afterwards
+        const __m256i packed =
+            _mm256_packus_epi16(_mm256_maddubs_epi16(lo, weights), _mm256_maddubs_epi16(hi, weights));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + offset / 2), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    return offset;
+}
+
+__attribute__((target("avx512f,avx512bw"))) inline auto nibblesAvx512(__m512i chunk, __mmask64 &valid) -> __m512i
+{
+    const __m512i digit = _mm512_sub_epi8(chunk, _mm512_set1_epi8('0'));
+    const __mmask64 is_digit = _mm512_cmple_epu8_mask(digit, _mm512_set1_epi8(9));
+    const __m512i alpha = _mm512_sub_epi8(_mm512_or_si512(chunk, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+    const __mmask64 is_alpha = _mm512_cmple_epu8_mask(alpha, _mm512_set1_epi8(5));
+    valid = is_digit | is_alpha;
+    return _mm512_mask_blend_epi8(is_digit, _mm512_add_epi8(alpha, _mm512_set1_epi8(10)), digit);
+}
+
+// 128 digits -> 64 bytes per iteration
+__attribute__((target("avx512f,avx512bw"))) auto decodeAvx512(const char *in, size_t size, uint8_t *out) -> size_t
+{
+    const __m512i weights = _mm512_set1_epi16(0x0110);
+    const __m512i group_order = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+    size_t offset = 0;
+    for (; offset + 128 <= size; offset += 128)
+    {
+        __mmask64 valid_lo;
+        __mmask64 valid_hi;
+        const __m512i lo = nibblesAvx512(_mm512_loadu_si512(in + offset), valid_lo);
+        const __m512i hi = nibblesAvx512(_mm512_loadu_si512(in + offset + 64), valid_hi);
+        if ((valid_lo & valid_hi) != ~__mmask64{0})
+        {
+            break;
+        }
+        const __m512i packed =
+            _mm512_packus_epi16(_mm512_maddubs_epi16(lo, weights), _mm512_maddubs_epi16(hi, weights));
+        _mm512_storeu_si512(out + offset / 2, _mm512_maskz_permutexvar_epi64(0xFF, group_order, packed));
+    }
+    return offset;
+}
+
+// 16 bytes -> 32 digits per iteration: each nibble indexes a 16-entry digit table with pshufb
+__attribute__((target("ssse3"))) auto encodeSsse3(const uint8_t *in, size_t size, char *out) -> size_t
+{
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(HEX_DIGITS.data()));
+    const __m128i low_mask = _mm_set1_epi8(0x0F);
+    size_t offset = 0;
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + offset));
+        const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), low_mask));
+        const __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, low_mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + offset * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + offset * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+    return offset;
+}
+
+// 32 bytes -> 64 digits per iteration
+__attribute__((target("avx2"))) auto encodeAvx2(const uint8_t *in, size_t size, char *out) -> size_t
+{
+    const __m256i digits =
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(HEX_DIGITS.data())));
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32)
+    {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + offset));
+        const __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_mask));
+        const __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(bytes, low_mask));
+        // The unpacks interleave within each 128-bit lane; reassemble the lanes in input order
+        const __m256i first = _mm256_unpacklo_epi8(high, low);
+        const __m256i second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + offset * 2),
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + offset * 2 + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return offset;
+}
+
+#endif // SONNX_HEX_CODEC_X86
+
+// Widest first; each kernel is named after the CPU feature it needs
+constexpr Selected<DecodeKernel> DECODE_KERNELS[] = {
+#ifdef SONNX_HEX_CODEC_X86
+    {decodeAvx512, "avx512bw"},
+    {decodeAvx2, "avx2"},
+    {decodeSse41, "sse4.1"},
+#endif
+    {nullptr, "scalar"}};
+
+constexpr Selected<EncodeKernel> ENCODE_KERNELS[] = {
+#ifdef SONNX_HEX_CODEC_X86
+    {encodeAvx2, "avx2"},
+    {encodeSsse3, "ssse3"},
+#endif
+    {nullptr, "scalar"}};
+
+// __builtin_cpu_supports only takes string literals
+auto cpuSupports(std::string_view feature) -> bool
+{
+#ifdef SONNX_HEX_CODEC_X86
+    __builtin_cpu_init();
+    if (feature == "avx512bw")
+    {
+        return __builtin_cpu_supports("avx512bw");
+    }
+    if (feature == "avx2")
+    {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (feature == "sse4.1")
+    {
+        return __builtin_cpu_supports("sse4.1");
+    }
+    if (feature == "ssse3")
+    {
+        return __builtin_cpu_supports("ssse3");
+    }
+#endif
+    return feature == "scalar";
+}
+
+// The named kernel if this CPU can run it
+template <typename Kernel, size_t N>
+auto findKernel(const Selected<Kernel> (&kernels)[N], std::string_view name) -> const Selected<Kernel> *
+{
+    for (const auto &candidate : kernels)
+    {
+        if (name == candidate.name)
+        {
+            return cpuSupports(name) ? &candidate : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+template <typename Kernel, size_t N> auto selectKernel(const Selected<Kernel> (&kernels)[N]) -> Selected<Kernel>
+{
+    for (const auto &candidate : kernels)
+    {
+        if (cpuSupports(candidate.name))
+        {
+            return candidate;
+        }
+    }
+    return kernels[N - 1];
+}
+
+auto decoder() -> const Selected<DecodeKernel> &
+{
+    static const Selected<DecodeKernel> selected = selectKernel(DECODE_KERNELS);
+    return selected;
+}
+
+auto encoder() -> const Selected<EncodeKernel> &
+{
+    static const Selected<EncodeKernel> selected = selectKernel(ENCODE_KERNELS);
+    return selected;
+}
+
+auto decodeUsing(DecodeKernel kernel, std::string_view hex_digits, uint8_t *out) noexcept -> size_t
+{
+    const size_t consumed = kernel != nullptr ? kernel(hex_digits.data(), hex_digits.size(), out) : 0;
+    return consumed + HexCodec::decodeScalar(hex_digits.substr(consumed), out + consumed / 2);
+}
+
+void encodeUsing(EncodeKernel kernel, const uint8_t *in, size_t size, char *out) noexcept
+{
+    const size_t consumed = kernel != nullptr ? kernel(in, size, out) : 0;
+    HexCodec::encodeScalar(in + consumed, size - consumed, out + consumed * 2);
+}
+
+} // namespace
+
+auto HexCodec::decode(std::string_view hex_digits, uint8_t *out) noexcept -> size_t
+{
+    return decodeUsing(decoder().kernel, hex_digits, out);
+}
+
+auto HexCodec::decodeWith(std::string_view kernel, std::string_view hex_digits, uint8_t *out,
+                          size_t &result) noexcept -> bool
+{
+    const auto *selected = findKernel(DECODE_KERNELS, kernel);
+    if (selected == nullptr)
+    {
+        return false;
+    }
+    result = decodeUsing(selected->kernel, hex_digits, out);
+    return true;
+}
+
+auto HexCodec::decodeScalar(std::string_view hex_digits, uint8_t *out) noexcept -> size_t
+{
+    const auto size = hex_digits.size();
+    for (size_t i = 0; i + 1 < size; i += 2)
+    {
+        const auto high = NIBBLE_TABLE[static_cast<unsigned char>(hex_digits[i])];
+        const auto low = NIBBLE_TABLE[static_cast<unsigned char>(hex_digits[i + 1])];
+        if (high == INVALID_NIBBLE || low == INVALID_NIBBLE)
+        {
+            return high == INVALID_NIBBLE ? i : i + 1;
+        }
+        *out++ = static_cast<uint8_t>(high << 4 | low);
+    }
+    // A dangling digit produces no byte but is still checked
+    if (size % 2 != 0 && NIBBLE_TABLE[static_cast<unsigned char>(hex_digits[size - 1])] == INVALID_NIBBLE)
+    {
+        return size - 1;
+    }
+    return size;
+}
+
+auto HexCodec::validate(std::string_view hex_digits, bool &has_upper_case) noexcept -> size_t
+{
+    const auto size = hex_digits.size();
+    size_t offset = 0;
+    bool upper_case = false;
+#if defined(SONNX_HEX_CODEC_X86) && defined(__SSE2__)
+    // SSE2 is part of the x86-64 baseline, so this needs no dispatch
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i five = _mm_set1_epi8(5);
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hex_digits.data() + offset));
+        const __m128i digit = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+        const __m128i lower = _mm_sub_epi8(chunk, _mm_set1_epi8('a'));
+        const __m128i upper = _mm_sub_epi8(chunk, _mm_set1_epi8('A'));
+        const __m128i is_upper = _mm_cmpeq_epi8(_mm_min_epu8(upper, five), upper);
+        const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(digit, nine), digit),
+                                                        _mm_cmpeq_epi8(_mm_min_epu8(lower, five), lower)),
+                                           is_upper);
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+        {
+            break;
+        }
+        upper_case = upper_case || _mm_movemask_epi8(is_upper) != 0;
+    }
+#endif
+    for (; offset < size; ++offset)
+    {
+        const auto character = hex_digits[offset];
+        if (NIBBLE_TABLE[static_cast<unsigned char>(character)] == INVALID_NIBBLE)
+        {
+            has_upper_case = upper_case;
+            return offset;
+        }
+        upper_case = upper_case || (character >= 'A' && character <= 'F');
+    }
+    has_upper_case = upper_case;
+    return size;
+}
+
+auto HexCodec::decoderName() noexcept -> const char *
+{
+    return decoder().name;
+}
+
+auto HexCodec::encoderName() noexcept -> const char *
+{
+    return encoder().name;
+}
+
+void HexCodec::encode(const uint8_t *in, size_t size, char *out) noexcept
+{
+    encodeUsing(encoder().kernel, in, size, out);
+}
+
+auto HexCodec::encodeWith(std::string_view kernel, const uint8_t *in, size_t size, char *out) noexcept -> bool
+{
+    const auto *selected = findKernel(ENCODE_KERNELS, kernel);
+    if (selected == nullptr)
+    {
+        return false;
+    }
+    encodeUsing(selected->kernel, in, size, out);
+    return true;
+}
+
+void HexCodec::encodeScalar(const uint8_t *in, size_t size, char *out) noexcept
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        *out++ = HEX_DIGITS[in[i] >> 4];
+        *out++ = HEX_DIGITS[in[i] & 0x0F];
+    }
+}
+
+} // namespace sonnx
@@ -0,0 +1,45 @@
+#ifndef HEX_CODEC_HPP
+#define HEX_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace sonnx
+{
+
+// Bulk hex conversion for raw_data payloads.
+// On x86 the widest vector kernel the running CPU supports is picked once at first use; other
+// targets, and the tails of every input, go through the table-driven scalar code.
+class HexCodec
+{
+  public:
+    // Decodes hex_digits (upper or lower case, even length) into hex_digits.size() / 2 bytes at out.
+    // Returns hex_digits.size() on success, otherwise the offset of the first invalid digit; bytes
+    // before the pair containing that digit have been written.
+    static auto decode(std::string_view hex_digits, uint8_t *out) noexcept -> size_t;
+    static auto decodeScalar(std::string_view hex_digits, uint8_t *out) noexcept -> size_t;
+
+    // Returns hex_digits.size() if every character is a hex digit, otherwise the offset of the first
+    // one that is not; has_upper_case tells whether any of the digits is one of A-F
+    static auto validate(std::string_view hex_digits, bool &has_upper_case) noexcept -> size_t;
+
+    // Writes 2 * size lower-case hex digits for the bytes at in to out
+    static void encode(const uint8_t *in, size_t size, char *out) noexcept;
+    static void encodeScalar(const uint8_t *in, size_t size, char *out) noexcept;
+
+    // Names of the kernels selected for this CPU ("avx512bw", "avx2", "sse4.1", "ssse3" or "scalar")
+    static auto decoderName() noexcept -> const char *;
+    static auto encoderName() noexcept -> const char *;
+
+    // decode and encode through the named kernel rather than the selected one, so that every kernel the CPU
+    // can run may be checked against the scalar code. Return false, writing nothing, for a kernel that is
+    // unknown or not supported here; "scalar" is always available.
+    static auto decodeWith(std::string_view kernel, std::string_view hex_digits, uint8_t *out,
+                           size_t &result) noexcept -> bool;
+    static auto encodeWith(std::string_view kernel, const uint8_t *in, size_t size, char *out) noexcept -> bool;
+};
+
+} // namespace sonnx
+
+#endif // HEX_CODEC_HPP
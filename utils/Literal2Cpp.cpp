@@ -1,4 +1,5 @@
 #include "Literal2Cpp.hpp"
+#include "HexCodec.hpp"
 #include <charconv>
 #include <cstdint>
 #include <stdexcept>
@@ -101,23 +102,30 @@ auto Literal2Cpp::stringLiteral2CppString(const std::string &string_literal) noe
     return result;
 }
 
-auto Literal2Cpp::bytesLiteral2CppBytes(const std::string &bytes_literal) -> std::vector<uint8_t>
+auto Literal2Cpp::bytesLiteral2CppBytes(std::string_view bytes_literal) -> std::vector<uint8_t>
 {
-    static constexpr int BASE = 16;
-    auto hex_part = std::string_view(bytes_literal).substr(0, bytes_literal.size() - 1);
+    return hexDigits2CppBytes(bytesLiteral2HexDigits(bytes_literal));
+}
+
+auto Literal2Cpp::bytesLiteral2HexDigits(std::string_view bytes_literal) -> std::string_view
+{
+    auto hex_part = bytes_literal.substr(0, bytes_literal.size() - 1);
     if (hex_part.size() % 2 != 0)
     {
         throw std::invalid_argument(
             "Invalid bytes literal: number of hex digits must be even for proper byte conversion");
     }
-    std::vector<uint8_t> result{};
-    result.reserve(hex_part.size() / 2);
-    for (size_t i = 0; i < hex_part.size(); i += 2)
+    return hex_part;
+}
+
+auto Literal2Cpp::hexDigits2CppBytes(std::string_view hex_digits) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> result(hex_digits.size() / 2);
+    const auto decoded = HexCodec::decode(hex_digits, result.data());
+    if (decoded != hex_digits.size())
     {
-        auto sub_string = hex_part.substr(i, 2);
-        uint8_t byte_val = 0;
-        auto [ptr, ec] = std::from_chars(sub_string.begin(), sub_string.end(), byte_val, BASE);
-        result.push_back(byte_val);
+        throw std::invalid_argument("Invalid bytes literal: invalid hex digit '" + std::string(1, hex_digits[decoded]) +
+                                    "' at offset " + std::to_string(decoded));
     }
     return result;
 }
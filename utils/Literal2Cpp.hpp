@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -15,7 +16,10 @@ class Literal2Cpp
     static auto integerLiteral2CppInteger(const std::string &integer_literal) noexcept(false)
         -> std::variant<uint32_t, uint64_t>;
     static auto stringLiteral2CppString(const std::string &string_literal) noexcept(true) -> std::string;
-    static auto bytesLiteral2CppBytes(const std::string &bytes_literal) noexcept(false) -> std::vector<uint8_t>;
+    static auto bytesLiteral2CppBytes(std::string_view bytes_literal) noexcept(false) -> std::vector<uint8_t>;
+    // Hex digits of a bytes literal without the trailing 'b', checked for an even digit count
+    static auto bytesLiteral2HexDigits(std::string_view bytes_literal) noexcept(false) -> std::string_view;
+    static auto hexDigits2CppBytes(std::string_view hex_digits) noexcept(false) -> std::vector<uint8_t>;
 };
 
 } // namespace sonnx
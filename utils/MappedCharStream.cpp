@@ -0,0 +1,179 @@
+#include "MappedCharStream.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace sonnx
+{
+
+namespace
+{
+
+auto systemErrorMessage(const std::string &what, const std::string &path) -> std::string
+{
+    return what + " '" + path + "': " + std::strerror(errno);
+}
+
+} // namespace
+
+auto MappedCharStream::fromFile(const std::string &path) -> std::unique_ptr<MappedCharStream>
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error(systemErrorMessage("Cannot open model file", path));
+    }
+
+    struct stat file_stat
+    {
+    };
+    if (::fstat(fd, &file_stat) != 0)
+    {
+        const auto message = systemErrorMessage("Cannot stat model file", path);
+        ::close(fd);
+        throw std::runtime_error(message);
+    }
+    if (!S_ISREG(file_stat.st_mode))
+    {
+        ::close(fd);
+        throw std::runtime_error("Model path is not a regular file: '" + path + "'");
+    }
+
+    const auto file_size = static_cast<size_t>(file_stat.st_size);
+    if (file_size == 0)
+    {
+        ::close(fd);
+        return std::unique_ptr<MappedCharStream>(new MappedCharStream("", 0, nullptr, path));
+    }
+
+    void *mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error(systemErrorMessage("Cannot map model file", path));
+    }
+    // The lexer walks the input front to back exactly once
+    ::madvise(mapping, file_size, MADV_SEQUENTIAL);
+
+    return std::unique_ptr<MappedCharStream>(
+        new MappedCharStream(static_cast<const char *>(mapping), file_size, mapping, path));
+}
+
+auto MappedCharStream::fromText(std::string text, std::string source_name) -> std::unique_ptr<MappedCharStream>
+{
+    return std::unique_ptr<MappedCharStream>(new MappedCharStream(std::move(text), std::move(source_name)));
+}
+
+MappedCharStream::MappedCharStream(const char *data, size_t size, void *mapping, std::string source_name)
+    : data_(data), size_(size), mapping_(mapping), source_name_(std::move(source_name))
+{
+}
+
+MappedCharStream::MappedCharStream(std::string text, std::string source_name)
+    : data_(nullptr), size_(text.size()), mapping_(nullptr), source_name_(std::move(source_name)),
+      text_(std::move(text))
+{
+    data_ = text_.data();
+}
+
+MappedCharStream::~MappedCharStream()
+{
+    if (mapping_ != nullptr)
+    {
+        ::munmap(mapping_, size_);
+    }
+}
+
+void MappedCharStream::consume()
+{
+    if (position_ >= size_)
+    {
+        throw antlr4::IllegalStateException("cannot consume EOF");
+    }
+    ++position_;
+}
+
+auto MappedCharStream::LA(ssize_t i) -> size_t
+{
+    if (i == 0)
+    {
+        return 0; // undefined
+    }
+    if (i < 0)
+    {
+        ++i; // e.g., translate LA(-1) to use offset i=0; then data[p+0-1]
+        if (static_cast<ssize_t>(position_) + i - 1 < 0)
+        {
+            return antlr4::IntStream::EOF; // invalid; no char before first char
+        }
+    }
+    const auto offset = static_cast<size_t>(static_cast<ssize_t>(position_) + i - 1);
+    if (offset >= size_)
+    {
+        return antlr4::IntStream::EOF;
+    }
+    return static_cast<unsigned char>(data_[offset]);
+}
+
+auto MappedCharStream::mark() -> ssize_t
+{
+    return -1;
+}
+
+void MappedCharStream::release(ssize_t /*marker*/)
+{
+}
+
+auto MappedCharStream::index() -> size_t
+{
+    return position_;
+}
+
+void MappedCharStream::seek(size_t index)
+{
+    position_ = std::min(index, size_);
+}
+
+auto MappedCharStream::size() -> size_t
+{
+    return size_;
+}
+
+auto MappedCharStream::getSourceName() const -> std::string
+{
+    return source_name_;
+}
+
+auto MappedCharStream::getText(const antlr4::misc::Interval &interval) -> std::string
+{
+    if (interval.a < 0 || interval.b < 0)
+    {
+        return "";
+    }
+    const auto start = static_cast<size_t>(interval.a);
+    auto stop = static_cast<size_t>(interval.b);
+    if (start >= size_)
+    {
+        return "";
+    }
+    stop = std::min(stop, size_ - 1);
+    if (stop < start)
+    {
+        return "";
+    }
+    return {data_ + start, stop - start + 1};
+}
+
+auto MappedCharStream::toString() const -> std::string
+{
+    return {data_, size_};
+}
+
+} // namespace sonnx
@@ -0,0 +1,63 @@
+#ifndef MAPPED_CHAR_STREAM_HPP
+#define MAPPED_CHAR_STREAM_HPP
+
+#include "antlr4-runtime.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace sonnx
+{
+
+// Byte-oriented CharStream over a read-only memory mapping of the model file.
+// The S_ONNX grammar is ASCII-only outside of string literals, so every byte is
+// handed to the lexer as one symbol and no UTF-32 copy of the input is ever made.
+// Bytes >= 0x80 inside string literals are passed through unchanged, which keeps
+// UTF-8 text intact in token text; column numbers are counted in bytes.
+class MappedCharStream final : public antlr4::CharStream
+{
+  public:
+    static auto fromFile(const std::string &path) -> std::unique_ptr<MappedCharStream>;
+    // Stream over model text received in memory (e.g. by the compile server); the stream owns the text
+    static auto fromText(std::string text, std::string source_name) -> std::unique_ptr<MappedCharStream>;
+
+    ~MappedCharStream() override;
+    MappedCharStream(const MappedCharStream &) = delete;
+    auto operator=(const MappedCharStream &) -> MappedCharStream & = delete;
+    MappedCharStream(MappedCharStream &&) = delete;
+    auto operator=(MappedCharStream &&) -> MappedCharStream & = delete;
+
+    void consume() override;
+    auto LA(ssize_t i) -> size_t override;
+    auto mark() -> ssize_t override;
+    void release(ssize_t marker) override;
+    auto index() -> size_t override;
+    void seek(size_t index) override;
+    auto size() -> size_t override;
+    [[nodiscard]] auto getSourceName() const -> std::string override;
+    auto getText(const antlr4::misc::Interval &interval) -> std::string override;
+    [[nodiscard]] auto toString() const -> std::string override;
+
+    // Direct access to the mapped bytes, valid for the lifetime of the stream
+    [[nodiscard]] auto getView() const -> std::string_view
+    {
+        return {data_, size_};
+    }
+
+  private:
+    MappedCharStream(const char *data, size_t size, void *mapping, std::string source_name);
+    MappedCharStream(std::string text, std::string source_name);
+
+    const char *data_;
+    size_t size_;
+    size_t position_ = 0;
+    void *mapping_;
+    std::string source_name_;
+    // Backing storage for streams created by fromText; empty for mapped files
+    std::string text_;
+};
+
+} // namespace sonnx
+
+#endif // MAPPED_CHAR_STREAM_HPP
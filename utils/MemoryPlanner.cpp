@@ -0,0 +1,135 @@
+#include "MemoryPlanner.hpp"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <set>
+#include <utility>
+
+namespace sonnx
+{
+
+namespace
+{
+
+// Free blocks of the arena, by offset for merging neighbours and by size for best fit
+class FreeBlocks
+{
+  public:
+    void release(uint64_t offset, uint64_t size)
+    {
+        // Merge with the blocks on either side
+        auto next = by_offset_.lower_bound(offset);
+        if (next != by_offset_.begin())
+        {
+            const auto previous = std::prev(next);
+            if (previous->first + previous->second == offset)
+            {
+                offset = previous->first;
+                size += previous->second;
+                erase(previous);
+            }
+        }
+        if (next != by_offset_.end() && offset + size == next->first)
+        {
+            size += next->second;
+            erase(next);
+        }
+        by_offset_.emplace(offset, size);
+        by_size_.emplace(size, offset);
+    }
+
+    // Offset of the smallest block that holds size, lowest offset first among equals; the rest stays free
+    auto take(uint64_t size) -> std::pair<bool, uint64_t>
+    {
+        const auto block = by_size_.lower_bound({size, 0});
+        if (block == by_size_.end())
+        {
+            return {false, 0};
+        }
+        const auto [block_size, offset] = *block;
+        by_size_.erase(block);
+        by_offset_.erase(offset);
+        if (block_size > size)
+        {
+            by_offset_.emplace(offset + size, block_size - size);
+            by_size_.emplace(block_size - size, offset + size);
+        }
+        return {true, offset};
+    }
+
+    // The free block ending at end, whose size is returned after it is taken; 0 if there is none
+    auto takeEndingAt(uint64_t end) -> uint64_t
+    {
+        if (by_offset_.empty())
+        {
+            return 0;
+        }
+        const auto last = std::prev(by_offset_.end());
+        if (last->first + last->second != end)
+        {
+            return 0;
+        }
+        const auto size = last->second;
+        erase(last);
+        return size;
+    }
+
+  private:
+    std::map<uint64_t, uint64_t> by_offset_;
+    std::set<std::pair<uint64_t, uint64_t>> by_size_;
+
+    void erase(std::map<uint64_t, uint64_t>::iterator block)
+    {
+        by_size_.erase({block->second, block->first});
+        by_offset_.erase(block);
+    }
+};
+
+} // namespace
+
+MemoryPlanner::MemoryPlanner(const std::vector<Buffer> &buffers) : offsets_(buffers.size(), 0)
+{
+    // Allocation order: by first step; release order: by last step
+    std::vector<size_t> by_first(buffers.size());
+    std::iota(by_first.begin(), by_first.end(), 0);
+    auto by_last = by_first;
+    std::stable_sort(by_first.begin(), by_first.end(),
+                     [&](size_t a, size_t b) { return buffers[a].first < buffers[b].first; });
+    std::stable_sort(by_last.begin(), by_last.end(),
+                     [&](size_t a, size_t b) { return buffers[a].last < buffers[b].last; });
+
+    FreeBlocks free_blocks;
+    size_t released = 0;
+    for (const auto buffer : by_first)
+    {
+        // Blocks whose last use came before this step are free again
+        const auto step = buffers[buffer].first;
+        for (; released < by_last.size() && buffers[by_last[released]].last < step; ++released)
+        {
+            const auto done = by_last[released];
+            if (buffers[done].size > 0)
+            {
+                free_blocks.release(offsets_[done], align(buffers[done].size));
+            }
+        }
+
+        const auto size = align(buffers[buffer].size);
+        if (size == 0)
+        {
+            continue;
+        }
+        const auto [found, offset] = free_blocks.take(size);
+        if (found)
+        {
+            offsets_[buffer] = offset;
+            continue;
+        }
+        // Grow the arena, starting inside a free block at its end if there is one
+        const auto tail = free_blocks.takeEndingAt(arena_size_);
+        offsets_[buffer] = arena_size_ - tail;
+        arena_size_ += size - tail;
+    }
+}
+
+} // namespace sonnx
@@ -0,0 +1,56 @@
+#ifndef MEMORY_PLANNER_HPP
+#define MEMORY_PLANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sonnx
+{
+
+// Places buffers with known lifetimes in one arena, so that buffers alive at the same step never overlap.
+// Buffers are placed in order of their first step, each into the smallest free block that holds it (best fit),
+// and blocks are given back once the step of their last use has passed; the arena only grows when no free block
+// is large enough. O(n log n) in the number of buffers.
+class MemoryPlanner
+{
+  public:
+    // Offsets and sizes are multiples of this
+    static constexpr uint64_t ALIGNMENT = 64;
+
+    // A buffer written at step first and last read at step last (inclusive). Buffers written at the step a
+    // buffer is last read at do not share its memory, as an operation may write its outputs while reading.
+    struct Buffer
+    {
+        uint64_t size;
+        uint32_t first;
+        uint32_t last;
+    };
+
+    MemoryPlanner() = default;
+    explicit MemoryPlanner(const std::vector<Buffer> &buffers);
+
+    // Offset of buffers[i] in the arena
+    [[nodiscard]] auto offset(size_t buffer) const -> uint64_t
+    {
+        return offsets_[buffer];
+    }
+    // Bytes the arena needs, i.e. the peak of live memory as planned
+    [[nodiscard]] auto arenaSize() const -> uint64_t
+    {
+        return arena_size_;
+    }
+
+    static auto align(uint64_t size) -> uint64_t
+    {
+        return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+  private:
+    std::vector<uint64_t> offsets_;
+    uint64_t arena_size_ = 0;
+};
+
+} // namespace sonnx
+
+#endif // MEMORY_PLANNER_HPP
@@ -0,0 +1,40 @@
+#include "NodeGraph.hpp"
+
+namespace sonnx
+{
+
+namespace
+{
+
+// Counting sort of edges by their key end: one pass to size each row, one prefix sum, one pass to fill.
+// Filling in edge order keeps every row in edge order.
+void buildRows(size_t node_count, const std::vector<NodeGraph::Edge> &edges, bool forward,
+               std::vector<NodeGraph::Index> &offsets, std::vector<NodeGraph::Index> &targets)
+{
+    offsets.assign(node_count + 1, 0);
+    for (const auto &[from, to] : edges)
+    {
+        ++offsets[(forward ? from : to) + 1];
+    }
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+
+    targets.resize(edges.size());
+    std::vector<NodeGraph::Index> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto &[from, to] : edges)
+    {
+        targets[cursor[forward ? from : to]++] = forward ? to : from;
+    }
+}
+
+} // namespace
+
+NodeGraph::NodeGraph(size_t node_count, const std::vector<Edge> &edges) : node_count_(node_count)
+{
+    buildRows(node_count, edges, true, successor_offsets_, successor_targets_);
+    buildRows(node_count, edges, false, predecessor_offsets_, predecessor_targets_);
+}
+
+} // namespace sonnx
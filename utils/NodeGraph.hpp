@@ -0,0 +1,84 @@
+#ifndef NODE_GRAPH_HPP
+#define NODE_GRAPH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace sonnx
+{
+
+// Read-only adjacency of the computation DAG over dense node indices, in compressed sparse row form: the
+// successors of node i are targets_[offsets_[i] .. offsets_[i + 1]), and likewise for predecessors. Fixed once
+// built; analyses only ever see it through the const accessors.
+class NodeGraph
+{
+  public:
+    using Index = uint32_t;
+    // Edge from a producer node to a consumer node
+    using Edge = std::pair<Index, Index>;
+
+    // Neighbours of one node, as indices of other nodes
+    class Neighbours
+    {
+      public:
+        Neighbours(const Index *begin, const Index *end) : begin_(begin), end_(end)
+        {
+        }
+        [[nodiscard]] auto begin() const -> const Index *
+        {
+            return begin_;
+        }
+        [[nodiscard]] auto end() const -> const Index *
+        {
+            return end_;
+        }
+        [[nodiscard]] auto size() const -> size_t
+        {
+            return static_cast<size_t>(end_ - begin_);
+        }
+        [[nodiscard]] auto empty() const -> bool
+        {
+            return begin_ == end_;
+        }
+
+      private:
+        const Index *begin_;
+        const Index *end_;
+    };
+
+    NodeGraph() = default;
+    // Both directions list the neighbours of a node in the order its edges appear in edges
+    NodeGraph(size_t node_count, const std::vector<Edge> &edges);
+
+    [[nodiscard]] auto nodeCount() const -> size_t
+    {
+        return node_count_;
+    }
+    [[nodiscard]] auto edgeCount() const -> size_t
+    {
+        return successor_targets_.size();
+    }
+    [[nodiscard]] auto successors(Index node) const -> Neighbours
+    {
+        return {successor_targets_.data() + successor_offsets_[node],
+                successor_targets_.data() + successor_offsets_[node + 1]};
+    }
+    [[nodiscard]] auto predecessors(Index node) const -> Neighbours
+    {
+        return {predecessor_targets_.data() + predecessor_offsets_[node],
+                predecessor_targets_.data() + predecessor_offsets_[node + 1]};
+    }
+
+  private:
+    size_t node_count_ = 0;
+    std::vector<Index> successor_offsets_ = {0};
+    std::vector<Index> successor_targets_;
+    std::vector<Index> predecessor_offsets_ = {0};
+    std::vector<Index> predecessor_targets_;
+};
+
+} // namespace sonnx
+
+#endif // NODE_GRAPH_HPP
@@ -0,0 +1,113 @@
+#include "NodeLevels.hpp"
+#include "ParallelFor.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace sonnx
+{
+
+namespace
+{
+
+// Frontier nodes handed to one worker at a time
+constexpr size_t FRONTIER_CHUNK = 1024;
+
+// Kahn's algorithm one frontier at a time: depth[i] is the frontier in which node i became free, i.e. the longest
+// path to it from a node without predecessors (forward) or from a node without successors (backward). A node is
+// freed by whichever worker removes its last incoming edge, so each depth has exactly one writer.
+// Returns the number of frontiers.
+auto frontierDepths(const NodeGraph &graph, const bool forward, const unsigned jobs,
+                    std::vector<NodeLevels::Index> &depth) -> NodeLevels::Index
+{
+    using Index = NodeLevels::Index;
+    const auto node_count = graph.nodeCount();
+    const auto incoming = [&](Index node) { return forward ? graph.predecessors(node) : graph.successors(node); };
+    const auto outgoing = [&](Index node) { return forward ? graph.successors(node) : graph.predecessors(node); };
+
+    depth.assign(node_count, 0);
+    std::vector<std::atomic<Index>> remaining(node_count);
+    std::vector<Index> frontier;
+    for (Index node = 0; node < node_count; ++node)
+    {
+        const auto degree = static_cast<Index>(incoming(node).size());
+        remaining[node].store(degree, std::memory_order_relaxed);
+        if (degree == 0)
+        {
+            frontier.push_back(node);
+        }
+    }
+
+    Index frontier_count = 0;
+    std::vector<std::vector<Index>> parts;
+    while (!frontier.empty())
+    {
+        const auto next_depth = ++frontier_count;
+        const auto chunk_count = (frontier.size() + FRONTIER_CHUNK - 1) / FRONTIER_CHUNK;
+        parts.resize(chunk_count);
+        parallelFor(chunk_count, frontier.size() >= NodeLevels::PARALLEL_FRONTIER ? jobs : 1, [&](const size_t chunk) {
+            auto &part = parts[chunk];
+            part.clear();
+            const auto end = std::min(frontier.size(), (chunk + 1) * FRONTIER_CHUNK);
+            for (auto i = chunk * FRONTIER_CHUNK; i < end; ++i)
+            {
+                for (const auto next : outgoing(frontier[i]))
+                {
+                    if (remaining[next].fetch_sub(1, std::memory_order_relaxed) == 1)
+                    {
+                        depth[next] = next_depth;
+                        part.push_back(next);
+                    }
+                }
+            }
+        });
+
+        frontier.clear();
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+        {
+            frontier.insert(frontier.end(), parts[chunk].begin(), parts[chunk].end());
+        }
+    }
+    return frontier_count;
+}
+
+} // namespace
+
+NodeLevels::NodeLevels(const NodeGraph &graph, const unsigned jobs)
+{
+    const auto level_count = frontierDepths(graph, true, jobs, asap_);
+    frontierDepths(graph, false, jobs, alap_);
+    // Backward depth is the distance to the farthest sink; count it down from the last level
+    for (auto &level : alap_)
+    {
+        level = level_count - 1 - level;
+    }
+
+    // Counting sort by ASAP level, in index order within a level
+    level_offsets_.assign(static_cast<size_t>(level_count) + 1, 0);
+    for (const auto level : asap_)
+    {
+        ++level_offsets_[level + 1];
+    }
+    for (size_t level = 0; level < level_count; ++level)
+    {
+        level_offsets_[level + 1] += level_offsets_[level];
+    }
+    level_nodes_.resize(asap_.size());
+    std::vector<Index> cursor(level_offsets_.begin(), level_offsets_.end() - 1);
+    for (Index node = 0; node < asap_.size(); ++node)
+    {
+        level_nodes_[cursor[asap_[node]]++] = node;
+    }
+}
+
+auto NodeLevels::maxWidth() const -> size_t
+{
+    size_t width = 0;
+    for (size_t level = 0; level < levelCount(); ++level)
+    {
+        width = std::max(width, this->level(level).size());
+    }
+    return width;
+}
+
+} // namespace sonnx
@@ -0,0 +1,67 @@
+#ifndef NODE_LEVELS_HPP
+#define NODE_LEVELS_HPP
+
+#include "NodeGraph.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace sonnx
+{
+
+// Wavefront levels of an acyclic NodeGraph. A node's ASAP level is the length of the longest path reaching it
+// from a source, its ALAP level the latest level it can take without lengthening the longest path to a sink,
+// and its slack the difference. All nodes of one ASAP level only depend on earlier levels, so each level can
+// run in parallel.
+class NodeLevels
+{
+  public:
+    using Index = NodeGraph::Index;
+    // Nodes of one level, in index order
+    using Nodes = NodeGraph::Neighbours;
+
+    // Frontiers at least this large are split across workers
+    static constexpr size_t PARALLEL_FRONTIER = 4096;
+
+    NodeLevels() = default;
+    // graph must be acyclic. Levels are found one frontier at a time, sources first for ASAP and sinks first for
+    // ALAP; large frontiers are expanded on up to jobs threads. The result does not depend on jobs.
+    explicit NodeLevels(const NodeGraph &graph, unsigned jobs = 1);
+
+    [[nodiscard]] auto nodeCount() const -> size_t
+    {
+        return asap_.size();
+    }
+    [[nodiscard]] auto levelCount() const -> size_t
+    {
+        return level_offsets_.size() - 1;
+    }
+    [[nodiscard]] auto asap(Index node) const -> Index
+    {
+        return asap_[node];
+    }
+    [[nodiscard]] auto alap(Index node) const -> Index
+    {
+        return alap_[node];
+    }
+    [[nodiscard]] auto slack(Index node) const -> Index
+    {
+        return alap_[node] - asap_[node];
+    }
+    // Nodes whose ASAP level is level
+    [[nodiscard]] auto level(size_t level) const -> Nodes
+    {
+        return {level_nodes_.data() + level_offsets_[level], level_nodes_.data() + level_offsets_[level + 1]};
+    }
+    // Size of the largest level, i.e. the most nodes that can ever run at once
+    [[nodiscard]] auto maxWidth() const -> size_t;
+
+  private:
+    std::vector<Index> asap_;
+    std::vector<Index> alap_;
+    std::vector<Index> level_offsets_ = {0};
+    std::vector<Index> level_nodes_;
+};
+
+} // namespace sonnx
+
+#endif // NODE_LEVELS_HPP
@@ -0,0 +1,67 @@
+#ifndef PARALLEL_FOR_HPP
+#define PARALLEL_FOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sonnx
+{
+
+// Worker count used when none is given: one per hardware thread
+inline auto defaultJobs() -> unsigned
+{
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+// Calls fn(i) for every i in [0, count) on at most jobs threads (the caller being one of them).
+// Indices are handed out one at a time, so work items of uneven cost still balance.
+// The first exception thrown by fn stops the hand-out and is rethrown once all workers are done.
+template <typename Fn> void parallelFor(const size_t count, const unsigned jobs, Fn &&fn)
+{
+    std::atomic<size_t> next{0};
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    auto worker = [&] {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                const std::lock_guard<std::mutex> lock(failure_mutex);
+                if (!failure)
+                {
+                    failure = std::current_exception();
+                }
+                next = count;
+            }
+        }
+    };
+
+    const auto thread_count = static_cast<size_t>(std::min<size_t>(std::max(1U, jobs), count));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_count; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    if (failure)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace sonnx
+
+#endif // PARALLEL_FOR_HPP
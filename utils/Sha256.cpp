@@ -0,0 +1,141 @@
+#include "Sha256.hpp"
+#include "HexCodec.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace sonnx
+{
+
+namespace
+{
+
+constexpr std::array<uint32_t, 64> ROUND_CONSTANTS{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+constexpr auto rotateRight(uint32_t value, int count) -> uint32_t
+{
+    return (value >> count) | (value << (32 - count));
+}
+
+} // namespace
+
+Sha256::Sha256()
+    : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}
+{
+}
+
+void Sha256::update(std::string_view data)
+{
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    auto remaining = data.size();
+    total_size_ += remaining;
+
+    if (block_size_ > 0)
+    {
+        const auto count = std::min(remaining, block_.size() - block_size_);
+        std::memcpy(block_.data() + block_size_, bytes, count);
+        block_size_ += count;
+        bytes += count;
+        remaining -= count;
+        if (block_size_ < block_.size())
+        {
+            return;
+        }
+        processBlock(block_.data());
+        block_size_ = 0;
+    }
+
+    // Whole blocks are hashed straight from the input
+    for (; remaining >= block_.size(); bytes += block_.size(), remaining -= block_.size())
+    {
+        processBlock(bytes);
+    }
+
+    std::memcpy(block_.data(), bytes, remaining);
+    block_size_ = remaining;
+}
+
+auto Sha256::hexDigest() -> std::string
+{
+    const uint64_t bit_length = total_size_ * 8;
+
+    // Padding: 0x80, zeros up to 56 mod 64, then the message length in bits as big-endian
+    block_[block_size_++] = 0x80;
+    if (block_size_ > 56)
+    {
+        std::memset(block_.data() + block_size_, 0, block_.size() - block_size_);
+        processBlock(block_.data());
+        block_size_ = 0;
+    }
+    std::memset(block_.data() + block_size_, 0, 56 - block_size_);
+    for (int i = 0; i < 8; ++i)
+    {
+        block_[56 + i] = static_cast<uint8_t>(bit_length >> (56 - 8 * i));
+    }
+    processBlock(block_.data());
+
+    std::array<uint8_t, 32> digest{};
+    for (size_t i = 0; i < state_.size(); ++i)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            digest[i * 4 + j] = static_cast<uint8_t>(state_[i] >> (24 - 8 * j));
+        }
+    }
+    std::string hex(digest.size() * 2, '0');
+    HexCodec::encode(digest.data(), digest.size(), hex.data());
+    return hex;
+}
+
+void Sha256::processBlock(const uint8_t *block)
+{
+    std::array<uint32_t, 64> schedule{};
+    for (size_t i = 0; i < 16; ++i)
+    {
+        schedule[i] = static_cast<uint32_t>(block[i * 4]) << 24 | static_cast<uint32_t>(block[i * 4 + 1]) << 16 |
+                      static_cast<uint32_t>(block[i * 4 + 2]) << 8 | static_cast<uint32_t>(block[i * 4 + 3]);
+    }
+    for (size_t i = 16; i < 64; ++i)
+    {
+        const auto s0 = rotateRight(schedule[i - 15], 7) ^ rotateRight(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+        const auto s1 = rotateRight(schedule[i - 2], 17) ^ rotateRight(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+        schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = state_;
+    for (size_t i = 0; i < 64; ++i)
+    {
+        const auto s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+        const auto choice = (e & f) ^ (~e & g);
+        const auto temp1 = h + s1 + choice + ROUND_CONSTANTS[i] + schedule[i];
+        const auto s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+        const auto majority = (a & b) ^ (a & c) ^ (b & c);
+        const auto temp2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+}
+
+} // namespace sonnx
@@ -0,0 +1,34 @@
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sonnx
+{
+
+// Incremental SHA-256 (FIPS 180-4), used to derive content addresses for the compile cache
+class Sha256
+{
+  public:
+    Sha256();
+
+    void update(std::string_view data);
+    // Finishes the hash and returns it as 64 lower-case hex digits; the object must not be reused
+    auto hexDigest() -> std::string;
+
+  private:
+    std::array<uint32_t, 8> state_;
+    std::array<uint8_t, 64> block_{};
+    size_t block_size_ = 0;
+    uint64_t total_size_ = 0;
+
+    void processBlock(const uint8_t *block);
+};
+
+} // namespace sonnx
+
+#endif // SHA256_HPP
@@ -0,0 +1,610 @@
+#include "ShapeInference.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace sonnx
+{
+
+namespace
+{
+
+using Input = ShapeInference::Input;
+using Output = ShapeInference::Output;
+
+// Same shape and type as the first input
+constexpr std::string_view UNARY_OPS[] = {
+    "Abs",      "Ceil",        "Clip",       "Cos",     "Dropout",     "Elu",        "Erf",
+    "Exp",      "Floor",       "Gelu",       "HardSigmoid", "HardSwish", "Identity", "LeakyRelu",
+    "Log",      "LogSoftmax",  "LRN",        "Neg",     "Reciprocal",  "Relu",       "Round",
+    "Selu",     "Sigmoid",     "Sin",        "Softmax", "Softplus",    "Sqrt",       "Tanh",
+    "BatchNormalization",      "InstanceNormalization", "LayerNormalization"};
+// Numpy-style broadcast of all inputs, with the type of the inputs
+constexpr std::string_view BROADCAST_OPS[] = {"Add", "Sub", "Mul", "Div", "Pow", "Mod",
+                                              "Max", "Min", "Sum", "Mean", "PRelu"};
+// Numpy-style broadcast of all inputs, with a BOOL result
+constexpr std::string_view COMPARISON_OPS[] = {"Equal", "Less", "Greater", "LessOrEqual",
+                                               "GreaterOrEqual", "And", "Or", "Xor"};
+constexpr std::string_view POOL_OPS[] = {"AveragePool", "LpPool", "MaxPool"};
+constexpr std::string_view GLOBAL_POOL_OPS[] = {"GlobalAveragePool", "GlobalLpPool", "GlobalMaxPool"};
+
+template <size_t N> auto isOneOf(std::string_view op_type, const std::string_view (&ops)[N]) -> bool
+{
+    return std::find(std::begin(ops), std::end(ops), op_type) != std::end(ops);
+}
+
+auto shapeOf(const std::vector<Input> &inputs, size_t position) -> const Shape *
+{
+    return position < inputs.size() && inputs[position].shape && *inputs[position].shape
+               ? &**inputs[position].shape
+               : nullptr;
+}
+
+// Type of the first input that has one
+auto commonType(const std::vector<Input> &inputs) -> DataType
+{
+    for (const auto &input : inputs)
+    {
+        if (input.type != DataType::UNDEFINED)
+        {
+            return input.type;
+        }
+    }
+    return DataType::UNDEFINED;
+}
+
+auto resolveAxis(int64_t axis, size_t rank) -> std::optional<size_t>
+{
+    const auto signed_rank = static_cast<int64_t>(rank);
+    if (axis < -signed_rank || axis >= signed_rank)
+    {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(axis < 0 ? axis + signed_rank : axis);
+}
+
+// Product of dims[begin, end): a number if all are numbers, the one dim_param if every other dim is 1
+auto product(const Shape &dims, size_t begin, size_t end) -> ShapeDim
+{
+    uint64_t value = 1;
+    std::optional<ShapeDim> param;
+    for (auto i = begin; i < end; ++i)
+    {
+        if (dims[i].kind == ShapeDim::Kind::VALUE)
+        {
+            value *= dims[i].value;
+        }
+        else if (dims[i].kind == ShapeDim::Kind::PARAM && !param)
+        {
+            param = dims[i];
+        }
+        else
+        {
+            return ShapeDim::unknown();
+        }
+    }
+    if (param)
+    {
+        return value == 1 ? *param : ShapeDim::unknown();
+    }
+    return ShapeDim::of(value);
+}
+
+// One dimension of a broadcast; nothing if the two are numbers that do not broadcast
+auto broadcastDim(const ShapeDim &a, const ShapeDim &b) -> std::optional<ShapeDim>
+{
+    if (a.isValue(1))
+    {
+        return b;
+    }
+    if (b.isValue(1) || a.sameAs(b))
+    {
+        return a;
+    }
+    if (a.kind == ShapeDim::Kind::VALUE && b.kind == ShapeDim::Kind::VALUE)
+    {
+        return std::nullopt;
+    }
+    // A number other than 1 is what the other side has to be, or broadcast to
+    if (a.kind == ShapeDim::Kind::VALUE)
+    {
+        return a;
+    }
+    if (b.kind == ShapeDim::Kind::VALUE)
+    {
+        return b;
+    }
+    return ShapeDim::unknown();
+}
+
+auto broadcast(const Shape &a, const Shape &b) -> std::optional<Shape>
+{
+    Shape result(std::max(a.size(), b.size()));
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        const auto a_dim = i < result.size() - a.size() ? ShapeDim::of(1) : a[i - (result.size() - a.size())];
+        const auto b_dim = i < result.size() - b.size() ? ShapeDim::of(1) : b[i - (result.size() - b.size())];
+        const auto dim = broadcastDim(a_dim, b_dim);
+        if (!dim)
+        {
+            return std::nullopt;
+        }
+        result[i] = *dim;
+    }
+    return result;
+}
+
+auto inferBroadcast(const std::vector<Input> &inputs) -> std::optional<Shape>
+{
+    if (inputs.empty())
+    {
+        return std::nullopt;
+    }
+    std::optional<Shape> result = Shape{};
+    for (size_t i = 0; i < inputs.size() && result; ++i)
+    {
+        const auto *shape = shapeOf(inputs, i);
+        if (!shape)
+        {
+            return std::nullopt;
+        }
+        result = broadcast(*result, *shape);
+    }
+    return result;
+}
+
+// Spatial output dims of a sliding window over x, whose first two dims are batch and channels
+auto inferWindow(const Shape &x, const std::vector<int64_t> &kernel, const Attributes::List &attributes,
+                 bool ceil_mode) -> std::optional<Shape>
+{
+    if (x.size() < 2 || kernel.size() != x.size() - 2)
+    {
+        return std::nullopt;
+    }
+    const auto spatial = kernel.size();
+    const auto strides = Attributes::findIntegers(attributes, "strides").value_or(std::vector<int64_t>(spatial, 1));
+    const auto dilations =
+        Attributes::findIntegers(attributes, "dilations").value_or(std::vector<int64_t>(spatial, 1));
+    const auto pads = Attributes::findIntegers(attributes, "pads").value_or(std::vector<int64_t>(2 * spatial, 0));
+    const auto auto_pad = Attributes::find(attributes, "auto_pad").value_or("NOTSET");
+    if (strides.size() != spatial || dilations.size() != spatial || pads.size() != 2 * spatial)
+    {
+        return std::nullopt;
+    }
+
+    Shape result;
+    for (size_t i = 0; i < spatial; ++i)
+    {
+        const auto &dim = x[2 + i];
+        const auto stride = strides[i];
+        const auto window = dilations[i] * (kernel[i] - 1) + 1;
+        const auto padding = pads[i] + pads[i + spatial];
+        if (stride <= 0 || window <= 0 || pads[i] < 0 || pads[i + spatial] < 0)
+        {
+            return std::nullopt;
+        }
+
+        // SAME keeps ceil(dim / stride); otherwise the window slides over the padded input
+        const bool same = auto_pad == "SAME_UPPER" || auto_pad == "SAME_LOWER";
+        const auto slack = auto_pad == "VALID" ? 1 - window : padding + 1 - window;
+        if (dim.kind != ShapeDim::Kind::VALUE)
+        {
+            // Only a window that keeps the size keeps a dim_param
+            result.push_back(stride == 1 && (same || slack == 0) ? dim : ShapeDim::unknown());
+            continue;
+        }
+
+        const auto size = static_cast<int64_t>(dim.value);
+        if (same)
+        {
+            result.push_back(ShapeDim::of(static_cast<uint64_t>((size + stride - 1) / stride)));
+            continue;
+        }
+        const auto span = size + slack - 1;
+        if (span < 0)
+        {
+            return std::nullopt;
+        }
+        const auto steps = ceil_mode ? (span + stride - 1) / stride : span / stride;
+        result.push_back(ShapeDim::of(static_cast<uint64_t>(steps + 1)));
+    }
+    return result;
+}
+
+// X [N, C, D...] and W [M, C / group, k...] give [N, M, D'...]
+auto inferConv(const std::vector<Input> &inputs, const Attributes::List &attributes) -> std::optional<Shape>
+{
+    const auto *x = shapeOf(inputs, 0);
+    const auto *w = shapeOf(inputs, 1);
+    if (!x || x->size() < 3)
+    {
+        return std::nullopt;
+    }
+
+    auto kernel = Attributes::findIntegers(attributes, "kernel_shape");
+    if (!kernel && w && w->size() == x->size())
+    {
+        kernel.emplace();
+        for (size_t i = 2; i < w->size(); ++i)
+        {
+            if ((*w)[i].kind != ShapeDim::Kind::VALUE)
+            {
+                return std::nullopt;
+            }
+            kernel->push_back(static_cast<int64_t>((*w)[i].value));
+        }
+    }
+    if (!kernel)
+    {
+        return std::nullopt;
+    }
+
+    auto spatial = inferWindow(*x, *kernel, attributes, false);
+    if (!spatial)
+    {
+        return std::nullopt;
+    }
+    Shape result{(*x)[0], w && !w->empty() ? (*w)[0] : ShapeDim::unknown()};
+    result.insert(result.end(), spatial->begin(), spatial->end());
+    return result;
+}
+
+auto inferPool(const std::vector<Input> &inputs, const Attributes::List &attributes) -> std::optional<Shape>
+{
+    const auto *x = shapeOf(inputs, 0);
+    const auto kernel = Attributes::findIntegers(attributes, "kernel_shape");
+    const auto ceil_mode = Attributes::findInteger(attributes, "ceil_mode", 0);
+    if (!x || x->size() < 3 || !kernel || !ceil_mode)
+    {
+        return std::nullopt;
+    }
+    auto spatial = inferWindow(*x, *kernel, attributes, *ceil_mode != 0);
+    if (!spatial)
+    {
+        return std::nullopt;
+    }
+    Shape result{(*x)[0], (*x)[1]};
+    result.insert(result.end(), spatial->begin(), spatial->end());
+    return result;
+}
+
+auto inferGlobalPool(const std::vector<Input> &inputs) -> std::optional<Shape>
+{
+    const auto *x = shapeOf(inputs, 0);
+    if (!x || x->size() < 2)
+    {
+        return std::nullopt;
+    }
+    Shape result(x->size(), ShapeDim::of(1));
+    result[0] = (*x)[0];
+    result[1] = (*x)[1];
+    return result;
+}
+
+// Numpy matmul: a rank-1 operand gains a dim of 1 for the product, which is dropped again from the result
+auto inferMatMul(const std::vector<Input> &inputs) -> std::optional<Shape>
+{
+    const auto *a_shape = shapeOf(inputs, 0);
+    const auto *b_shape = shapeOf(inputs, 1);
+    if (!a_shape || !b_shape || a_shape->empty() || b_shape->empty())
+    {
+        return std::nullopt;
+    }
+    auto a = *a_shape;
+    auto b = *b_shape;
+    const bool a_vector = a.size() == 1;
+    const bool b_vector = b.size() == 1;
+    if (a_vector)
+    {
+        a.insert(a.begin(), ShapeDim::of(1));
+    }
+    if (b_vector)
+    {
+        b.push_back(ShapeDim::of(1));
+    }
+
+    const auto &inner_a = a[a.size() - 1];
+    const auto &inner_b = b[b.size() - 2];
+    if (inner_a.kind == ShapeDim::Kind::VALUE && inner_b.kind == ShapeDim::Kind::VALUE && !inner_a.sameAs(inner_b))
+    {
+        return std::nullopt;
+    }
+
+    auto result = broadcast(Shape(a.begin(), a.end() - 2), Shape(b.begin(), b.end() - 2));
+    if (!result)
+    {
+        return std::nullopt;
+    }
+    if (!a_vector)
+    {
+        result->push_back(a[a.size() - 2]);
+    }
+    if (!b_vector)
+    {
+        result->push_back(b[b.size() - 1]);
+    }
+    return result;
+}
+
+// A [M, K] and B [K, N], either transposed by its attribute, give [M, N]
+auto inferGemm(const std::vector<Input> &inputs, const Attributes::List &attributes) -> std::optional<Shape>
+{
+    const auto *a = shapeOf(inputs, 0);
+    const auto *b = shapeOf(inputs, 1);
+    const auto trans_a = Attributes::findInteger(attributes, "transA", 0);
+    const auto trans_b = Attributes::findInteger(attributes, "transB", 0);
+    if (!a || !b || a->size() != 2 || b->size() != 2 || !trans_a || !trans_b)
+    {
+        return std::nullopt;
+    }
+    return Shape{(*a)[*trans_a ? 1 : 0], (*b)[*trans_b ? 0 : 1]};
+}
+
+// The target shape comes from the contents of the second input. A 0 copies the input's dim unless allowzero is
+// set, and a single -1 takes whatever is left of the element count.
+auto inferReshape(const std::vector<Input> &inputs, const Attributes::List &attributes) -> std::optional<Shape>
+{
+    const auto *data = shapeOf(inputs, 0);
+    const auto allow_zero = Attributes::findInteger(attributes, "allowzero", 0);
+    const auto *target = inputs.size() > 1 ? inputs[1].value : nullptr;
+    if (!target || target->type != DataType::INT || target->dims.size() != 1 || !target->isWellFormed() ||
+        !allow_zero)
+    {
+        // Without the contents, a known length of the shape input still gives the rank
+        const auto *target_shape = shapeOf(inputs, 1);
+        if (target_shape && target_shape->size() == 1 && (*target_shape)[0].kind == ShapeDim::Kind::VALUE)
+        {
+            return Shape((*target_shape)[0].value, ShapeDim::unknown());
+        }
+        return std::nullopt;
+    }
+
+    std::vector<int64_t> values(target->elementCount());
+    if (!values.empty())
+    {
+        std::memcpy(values.data(), target->bytes.data(), values.size() * sizeof(int64_t));
+    }
+    Shape result(values.size());
+    std::optional<size_t> inferred;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (values[i] == -1 && !inferred)
+        {
+            inferred = i;
+        }
+        else if (values[i] == 0 && *allow_zero == 0)
+        {
+            if (!data || i >= data->size())
+            {
+                return std::nullopt;
+            }
+            result[i] = (*data)[i];
+        }
+        else if (values[i] >= 0)
+        {
+            result[i] = ShapeDim::of(static_cast<uint64_t>(values[i]));
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (inferred)
+    {
+        // Known only if every other dim here and every input dim is a number
+        const auto total = data ? product(*data, 0, data->size()) : ShapeDim::unknown();
+        result[*inferred] = ShapeDim::unknown();
+        if (total.kind == ShapeDim::Kind::VALUE)
+        {
+            Shape known(result);
+            known.erase(known.begin() + static_cast<ptrdiff_t>(*inferred));
+            const auto rest = product(known, 0, known.size());
+            if (rest.kind == ShapeDim::Kind::VALUE && rest.value != 0 && total.value % rest.value == 0)
+            {
+                result[*inferred] = ShapeDim::of(total.value / rest.value);
+            }
+        }
+    }
+    return result;
+}
+
+auto inferTranspose(const std::vector<Input> &inputs, const Attributes::List &attributes) -> std::optional<Shape>
+{
+    const auto *x = shapeOf(inputs, 0);
+    if (!x)
+    {
+        return std::nullopt;
+    }
+    const auto rank = x->size();
+    Shape result(x->rbegin(), x->rend());
+    if (const auto perm = Attributes::findIntegers(attributes, "perm"))
+    {
+        if (perm->size() != rank)
+        {
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < rank; ++i)
+        {
+            const auto axis = resolveAxis((*perm)[i], rank);
+            if (!axis)
+            {
+                return std::nullopt;
+            }
+            result[i] = (*x)[*axis];
+        }
+    }
+    return result;
+}
+
+auto inferConcat(const std::vector<Input> &inputs, const Attributes::List &attributes) -> std::optional<Shape>
+{
+    const auto *first = shapeOf(inputs, 0);
+    const auto axis_value = Attributes::findIntegers(attributes, "axis");
+    if (!first || !axis_value || axis_value->size() != 1)
+    {
+        return std::nullopt;
+    }
+    const auto axis = resolveAxis(axis_value->front(), first->size());
+    if (!axis)
+    {
+        return std::nullopt;
+    }
+
+    Shape result(*first);
+    uint64_t length = 0;
+    bool length_known = true;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        const auto *shape = shapeOf(inputs, i);
+        if (!shape || shape->size() != first->size())
+        {
+            return std::nullopt;
+        }
+        for (size_t d = 0; d < shape->size(); ++d)
+        {
+            if (d == *axis)
+            {
+                length_known = length_known && (*shape)[d].kind == ShapeDim::Kind::VALUE;
+                length += (*shape)[d].value;
+            }
+            else if (result[d].kind == ShapeDim::Kind::UNKNOWN)
+            {
+                result[d] = (*shape)[d];
+            }
+        }
+    }
+    // A single input keeps its dim, whatever it is
+    if (inputs.size() > 1)
+    {
+        result[*axis] = length_known ? ShapeDim::of(length) : ShapeDim::unknown();
+    }
+    return result;
+}
+
+// [d0 * ... * d(axis-1), d(axis) * ... * d(rank-1)]
+auto inferFlatten(const std::vector<Input> &inputs, const Attributes::List &attributes) -> std::optional<Shape>
+{
+    const auto *x = shapeOf(inputs, 0);
+    const auto axis_value = Attributes::findInteger(attributes, "axis", 1);
+    if (!x || !axis_value)
+    {
+        return std::nullopt;
+    }
+    // axis may equal the rank here
+    const auto rank = static_cast<int64_t>(x->size());
+    const auto axis = *axis_value < 0 ? *axis_value + rank : *axis_value;
+    if (axis < 0 || axis > rank)
+    {
+        return std::nullopt;
+    }
+    const auto split = static_cast<size_t>(axis);
+    return Shape{product(*x, 0, split), product(*x, split, x->size())};
+}
+
+} // namespace
+
+auto ShapeInference::needsValue(std::string_view op_type, size_t position) -> bool
+{
+    return op_type == "Reshape" && position == 1;
+}
+
+auto ShapeInference::infer(std::string_view op_type, const std::vector<Input> &inputs,
+                           const Attributes::List &attributes, size_t output_count) -> std::vector<Output>
+{
+    std::vector<Output> outputs(output_count);
+    if (output_count == 0)
+    {
+        return outputs;
+    }
+    auto &first = outputs[0];
+    const auto input_type = inputs.empty() ? DataType::UNDEFINED : inputs[0].type;
+
+    if (isOneOf(op_type, UNARY_OPS) || op_type == "Not")
+    {
+        first.type = op_type == "Not" ? DataType::BOOL : input_type;
+        if (const auto *x = shapeOf(inputs, 0))
+        {
+            first.shape = *x;
+        }
+        // The mask of Dropout covers the input
+        if (op_type == "Dropout" && output_count > 1)
+        {
+            outputs[1] = {DataType::BOOL, first.shape};
+        }
+    }
+    else if (isOneOf(op_type, BROADCAST_OPS))
+    {
+        first = {commonType(inputs), inferBroadcast(inputs)};
+    }
+    else if (isOneOf(op_type, COMPARISON_OPS))
+    {
+        first = {DataType::BOOL, inferBroadcast(inputs)};
+    }
+    else if (op_type == "Where")
+    {
+        first.type = inputs.size() > 1 ? commonType({inputs.begin() + 1, inputs.end()}) : DataType::UNDEFINED;
+        first.shape = inferBroadcast(inputs);
+    }
+    else if (op_type == "Cast")
+    {
+        const auto to = Attributes::find(attributes, "to");
+        first.type = to ? Attributes::parseDataType(*to).value_or(DataType::UNDEFINED) : DataType::UNDEFINED;
+        if (const auto *x = shapeOf(inputs, 0))
+        {
+            first.shape = *x;
+        }
+    }
+    else if (op_type == "Conv")
+    {
+        first = {input_type, inferConv(inputs, attributes)};
+    }
+    else if (isOneOf(op_type, POOL_OPS))
+    {
+        first = {input_type, inferPool(inputs, attributes)};
+        // The indices of MaxPool have the shape of its result
+        if (op_type == "MaxPool" && output_count > 1)
+        {
+            outputs[1] = {DataType::INT, first.shape};
+        }
+    }
+    else if (isOneOf(op_type, GLOBAL_POOL_OPS))
+    {
+        first = {input_type, inferGlobalPool(inputs)};
+    }
+    else if (op_type == "MatMul")
+    {
+        first = {commonType(inputs), inferMatMul(inputs)};
+    }
+    else if (op_type == "Gemm")
+    {
+        first = {commonType(inputs), inferGemm(inputs, attributes)};
+    }
+    else if (op_type == "Reshape")
+    {
+        first = {input_type, inferReshape(inputs, attributes)};
+    }
+    else if (op_type == "Transpose")
+    {
+        first = {input_type, inferTranspose(inputs, attributes)};
+    }
+    else if (op_type == "Concat")
+    {
+        first = {commonType(inputs), inferConcat(inputs, attributes)};
+    }
+    else if (op_type == "Flatten")
+    {
+        first = {input_type, inferFlatten(inputs, attributes)};
+    }
+    else if (op_type == "Shape")
+    {
+        first.type = DataType::INT;
+        if (const auto *x = shapeOf(inputs, 0))
+        {
+            first.shape = Shape{ShapeDim::of(x->size())};
+        }
+    }
+    return outputs;
+}
+
+} // namespace sonnx
@@ -0,0 +1,83 @@
+#ifndef SHAPE_INFERENCE_HPP
+#define SHAPE_INFERENCE_HPP
+
+#include "Attributes.hpp"
+#include "ConstantFolder.hpp"
+#include "StringInterner.hpp"
+#include "ast/AST.hpp"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace sonnx
+{
+
+// One dimension of a tensor: a number, a named dim_param such as "N", or unknown
+struct ShapeDim
+{
+    enum class Kind : uint8_t
+    {
+        UNKNOWN,
+        VALUE,
+        PARAM
+    };
+    Kind kind = Kind::UNKNOWN;
+    uint64_t value = 0;
+    SymbolId param = StringInterner::EMPTY;
+
+    static auto unknown() -> ShapeDim
+    {
+        return {};
+    }
+    static auto of(uint64_t value) -> ShapeDim
+    {
+        return {Kind::VALUE, value, StringInterner::EMPTY};
+    }
+    static auto named(SymbolId param) -> ShapeDim
+    {
+        return {Kind::PARAM, 0, param};
+    }
+    [[nodiscard]] auto isValue(uint64_t expected) const -> bool
+    {
+        return kind == Kind::VALUE && value == expected;
+    }
+    // Known to be the same size: equal numbers or the same dim_param
+    [[nodiscard]] auto sameAs(const ShapeDim &other) const -> bool
+    {
+        return kind == other.kind && kind != Kind::UNKNOWN && value == other.value && param == other.param;
+    }
+};
+
+// Dimensions of a tensor of known rank
+using Shape = std::vector<ShapeDim>;
+
+// Per-operator rules that derive the type and shape of a node's outputs from those of its inputs
+class ShapeInference
+{
+  public:
+    // What is known about one input. value is set for inputs whose contents a rule reads, if they are constant.
+    struct Input
+    {
+        DataType type = DataType::UNDEFINED;
+        const std::optional<Shape> *shape = nullptr;
+        const Constant *value = nullptr;
+    };
+    // What a rule found for one output; either part may stay unknown
+    struct Output
+    {
+        DataType type = DataType::UNDEFINED;
+        std::optional<Shape> shape;
+    };
+
+    // Whether the rule for op_type reads the contents of input position, such as the shape input of Reshape
+    static auto needsValue(std::string_view op_type, size_t position) -> bool;
+    // Infers output_count outputs. Operators without a rule, and inputs whose shapes are unknown or do not fit the
+    // operator, leave the affected outputs unknown; a dim_param passes through wherever a rule keeps the dimension.
+    static auto infer(std::string_view op_type, const std::vector<Input> &inputs,
+                      const Attributes::List &attributes, size_t output_count) -> std::vector<Output>;
+};
+
+} // namespace sonnx
+
+#endif // SHAPE_INFERENCE_HPP
@@ -0,0 +1,143 @@
+#ifndef SMALL_VECTOR_HPP
+#define SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace sonnx
+{
+
+// Growable array that keeps its first N elements inline and only allocates past that. Holds trivially
+// copyable values (pointers, ids), so growing and copying are plain memory copies.
+template <typename T, size_t N> class SmallVector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector only holds trivially copyable values");
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+  public:
+    SmallVector() = default;
+    SmallVector(const SmallVector &other)
+    {
+        append(other);
+    }
+    auto operator=(const SmallVector &other) -> SmallVector &
+    {
+        if (this != &other)
+        {
+            clear();
+            append(other);
+        }
+        return *this;
+    }
+    SmallVector(SmallVector &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+    auto operator=(SmallVector &&other) noexcept -> SmallVector &
+    {
+        if (this != &other)
+        {
+            if (other.heap_)
+            {
+                // Take over the allocation
+                heap_ = std::move(other.heap_);
+                capacity_ = other.capacity_;
+                size_ = other.size_;
+            }
+            else
+            {
+                heap_.reset();
+                capacity_ = N;
+                size_ = other.size_;
+                std::copy(other.inline_, other.inline_ + other.size_, inline_);
+            }
+            other.capacity_ = N;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+    ~SmallVector() = default;
+
+    void push_back(T value)
+    {
+        if (size_ == capacity_)
+        {
+            grow(capacity_ * 2);
+        }
+        data()[size_++] = value;
+    }
+    void clear()
+    {
+        size_ = 0;
+    }
+
+    [[nodiscard]] auto size() const -> size_t
+    {
+        return size_;
+    }
+    [[nodiscard]] auto empty() const -> bool
+    {
+        return size_ == 0;
+    }
+    [[nodiscard]] auto data() -> T *
+    {
+        return heap_ ? heap_.get() : inline_;
+    }
+    [[nodiscard]] auto data() const -> const T *
+    {
+        return heap_ ? heap_.get() : inline_;
+    }
+    [[nodiscard]] auto operator[](size_t position) -> T &
+    {
+        return data()[position];
+    }
+    [[nodiscard]] auto operator[](size_t position) const -> const T &
+    {
+        return data()[position];
+    }
+    [[nodiscard]] auto begin() -> T *
+    {
+        return data();
+    }
+    [[nodiscard]] auto end() -> T *
+    {
+        return data() + size_;
+    }
+    [[nodiscard]] auto begin() const -> const T *
+    {
+        return data();
+    }
+    [[nodiscard]] auto end() const -> const T *
+    {
+        return data() + size_;
+    }
+
+  private:
+    T inline_[N];
+    std::unique_ptr<T[]> heap_;
+    size_t capacity_ = N;
+    size_t size_ = 0;
+
+    void grow(size_t capacity)
+    {
+        auto heap = std::make_unique<T[]>(capacity);
+        std::copy(begin(), end(), heap.get());
+        heap_ = std::move(heap);
+        capacity_ = capacity;
+    }
+    void append(const SmallVector &other)
+    {
+        if (other.size_ > capacity_)
+        {
+            grow(other.size_);
+        }
+        std::copy(other.begin(), other.end(), data());
+        size_ = other.size_;
+    }
+};
+
+} // namespace sonnx
+
+#endif // SMALL_VECTOR_HPP
@@ -0,0 +1,50 @@
+#include "StringInterner.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace sonnx
+{
+
+StringInterner::StringInterner()
+{
+    views_.emplace_back();
+    ids_.emplace(std::string_view(), EMPTY);
+}
+
+auto StringInterner::intern(std::string_view text) -> SymbolId
+{
+    const auto it = ids_.find(text);
+    if (it != ids_.end())
+    {
+        return it->second;
+    }
+    if (views_.size() > UINT32_MAX)
+    {
+        throw std::length_error("too many distinct names for 32-bit symbol ids");
+    }
+    const auto id = static_cast<SymbolId>(views_.size());
+    const auto stored = copyText(text);
+    views_.push_back(stored);
+    ids_.emplace(stored, id);
+    return id;
+}
+
+auto StringInterner::copyText(std::string_view text) -> std::string_view
+{
+    if (static_cast<size_t>(limit_ - cursor_) < text.size())
+    {
+        // Same growth policy as the AST arena; a name longer than a chunk gets a chunk of its own
+        const auto chunk_size = std::max(next_chunk_size_, text.size());
+        next_chunk_size_ = std::min(next_chunk_size_ * 2, MAX_CHUNK_SIZE);
+        chunks_.emplace_back(new char[chunk_size]);
+        cursor_ = chunks_.back().get();
+        limit_ = cursor_ + chunk_size;
+    }
+    std::memcpy(cursor_, text.data(), text.size());
+    const std::string_view stored(cursor_, text.size());
+    cursor_ += text.size();
+    return stored;
+}
+
+} // namespace sonnx
@@ -0,0 +1,63 @@
+#ifndef STRING_INTERNER_HPP
+#define STRING_INTERNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sonnx
+{
+
+// Dense id of an interned name: equal names have equal ids, and ids count up from 0 in order of first sight
+using SymbolId = uint32_t;
+
+// Stores every distinct tensor, node, op_type and attribute name of one compilation exactly once.
+// Later passes compare, hash and index by SymbolId and only go back to the text for output and diagnostics.
+class StringInterner
+{
+  public:
+    // The empty string is interned up front, so "no name" is an ordinary id
+    static constexpr SymbolId EMPTY = 0;
+
+    StringInterner();
+    StringInterner(const StringInterner &) = delete;
+    auto operator=(const StringInterner &) -> StringInterner & = delete;
+    StringInterner(StringInterner &&) = delete;
+    auto operator=(StringInterner &&) -> StringInterner & = delete;
+    ~StringInterner() = default;
+
+    // Returns the id of text, copying it into the interner the first time it is seen
+    auto intern(std::string_view text) -> SymbolId;
+
+    // The view stays valid as long as the interner
+    [[nodiscard]] auto view(SymbolId id) const -> std::string_view
+    {
+        return views_[id];
+    }
+    [[nodiscard]] auto size() const -> size_t
+    {
+        return views_.size();
+    }
+
+  private:
+    static constexpr size_t FIRST_CHUNK_SIZE = 4 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = 256 * 1024;
+
+    // Text lives in chunks that never move, so the views in views_ and ids_ stay valid as both grow
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char *cursor_ = nullptr;
+    char *limit_ = nullptr;
+    size_t next_chunk_size_ = FIRST_CHUNK_SIZE;
+
+    std::vector<std::string_view> views_;
+    std::unordered_map<std::string_view, SymbolId> ids_;
+
+    auto copyText(std::string_view text) -> std::string_view;
+};
+
+} // namespace sonnx
+
+#endif // STRING_INTERNER_HPP
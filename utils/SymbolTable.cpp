@@ -1,5 +1,9 @@
 #include "SymbolTable.hpp"
+#include "HexCodec.hpp"
+#include "Literal2Cpp.hpp"
 #include <algorithm>
+#include <array>
+#include <functional>
 #include <queue>
 #include <sstream>
 #include <iostream>
@@ -7,6 +11,24 @@
 namespace sonnx
 {
 
+namespace
+{
+
+// Operators whose result is not a function of their inputs and attributes
+constexpr std::string_view NONDETERMINISTIC_OPS[] = {"RandomNormal", "RandomNormalLike", "RandomUniform",
+                                                     "RandomUniformLike", "Multinomial", "Bernoulli", "Dropout"};
+
+// Mixes value into seed with the splitmix64 finalizer
+auto hashCombine(uint64_t seed, uint64_t value) -> uint64_t
+{
+    uint64_t x = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
 void NodeSymbol::addInput(TensorSymbol *tensor)
 {
     inputs_.push_back(tensor);
@@ -19,290 +41,744 @@ void NodeSymbol::addOutput(TensorSymbol *tensor)
     tensor->setProducer(this);
 }
 
-bool SymbolTable::insertNodeSymbol(const std::string &name, const std::string &op_type, const ASTNode *def)
+void NodeSymbol::replaceInput(const TensorSymbol *from, TensorSymbol *to)
+{
+    for (auto &input : inputs_)
+    {
+        if (input == from)
+        {
+            input = to;
+            to->addUser(this);
+        }
+    }
+}
+
+std::vector<uint8_t> TensorSymbol::decodeRawData() const
+{
+    return Literal2Cpp::hexDigits2CppBytes(raw_data_digits_);
+}
+
+auto SymbolTable::claimSlot(SymbolId name, SymbolSlot::Kind kind, SymbolIndex index) -> bool
 {
-    if (symbols_.find(name) != symbols_.end())
+    if (name >= slots_.size())
+    {
+        // Ids are dense, so the index only ever grows to the number of distinct names
+        slots_.resize(std::max<size_t>(name + 1, names_.size()));
+    }
+    auto &slot = slots_[name];
+    if (slot.kind != SymbolSlot::Kind::NONE)
     {
         return false;
     }
-    symbols_[name] = std::make_unique<NodeSymbol>(name, op_type, def);
+    slot = {kind, index};
     return true;
 }
 
-bool SymbolTable::insertTensorSymbol(const std::string &name, DataType dtype, const ASTNode *def)
+bool SymbolTable::insertNodeSymbol(SymbolId name, SymbolId op_type, const ASTNode *def)
 {
-    if (symbols_.find(name) != symbols_.end())
+    const auto index = static_cast<SymbolIndex>(nodes_.size());
+    if (!claimSlot(name, SymbolSlot::Kind::NODE, index))
     {
         return false;
     }
-    symbols_[name] = std::make_unique<TensorSymbol>(name, dtype, def);
+    nodes_.emplace_back(name, names_.view(name), op_type, names_.view(op_type), def, index);
     return true;
 }
 
-BaseSymbol *SymbolTable::lookup(const std::string &name)
+bool SymbolTable::insertTensorSymbol(SymbolId name, DataType dtype, const ASTNode *def)
 {
-    const auto it = symbols_.find(name);
-    return (it != symbols_.end()) ? it->second.get() : nullptr;
+    const auto index = static_cast<SymbolIndex>(tensors_.size());
+    if (!claimSlot(name, SymbolSlot::Kind::TENSOR, index))
+    {
+        return false;
+    }
+    tensors_.emplace_back(name, names_.view(name), dtype, def, index);
+    return true;
 }
 
-NodeSymbol *SymbolTable::getNodeSymbol(const std::string &name)
+NodeSymbol *SymbolTable::getNodeSymbol(SymbolId name)
 {
-    return dynamic_cast<NodeSymbol *>(lookup(name));
+    const auto slot = lookup(name);
+    return slot.kind == SymbolSlot::Kind::NODE ? &nodes_[slot.index] : nullptr;
 }
 
-TensorSymbol *SymbolTable::getTensorSymbol(const std::string &name)
+const NodeSymbol *SymbolTable::getNodeSymbol(SymbolId name) const
 {
-    return dynamic_cast<TensorSymbol *>(lookup(name));
+    const auto slot = lookup(name);
+    return slot.kind == SymbolSlot::Kind::NODE ? &nodes_[slot.index] : nullptr;
 }
 
-std::vector<NodeSymbol *> SymbolTable::getAllNodeSymbols() const
+TensorSymbol *SymbolTable::getTensorSymbol(SymbolId name)
 {
-    std::vector<NodeSymbol *> nodes;
-    for (auto &pair : symbols_)
-    {
-        if (auto *node = dynamic_cast<NodeSymbol *>(pair.second.get()))
-        {
-            nodes.push_back(node);
-        }
-    }
-    return nodes;
+    const auto slot = lookup(name);
+    return slot.kind == SymbolSlot::Kind::TENSOR ? &tensors_[slot.index] : nullptr;
 }
 
-std::vector<TensorSymbol *> SymbolTable::getAllTensorSymbols() const
+const TensorSymbol *SymbolTable::getTensorSymbol(SymbolId name) const
 {
-    std::vector<TensorSymbol *> tensors;
-    for (auto &pair : symbols_)
-    {
-        if (auto *tensor = dynamic_cast<TensorSymbol *>(pair.second.get()))
-        {
-            tensors.push_back(tensor);
-        }
-    }
-    return tensors;
+    const auto slot = lookup(name);
+    return slot.kind == SymbolSlot::Kind::TENSOR ? &tensors_[slot.index] : nullptr;
 }
 
 void SymbolTable::buildDAG()
 {
-    dag_edges_.clear();
-    reverse_dag_edges_.clear();
-
     // Build edges based on tensor producers and consumers
-    for (auto *node : getAllNodeSymbols())
+    std::vector<NodeGraph::Edge> edges;
+    for (const auto &node : nodes_)
     {
-        for (const auto *input : node->getInputs())
+        for (const auto *input : node.getInputs())
         {
-            if (auto *producer = input->getProducer())
+            if (const auto *producer = input->getProducer())
             {
-                dag_edges_[producer].push_back(node);
-                reverse_dag_edges_[node].push_back(producer);
+                edges.emplace_back(producer->getIndex(), node.getIndex());
             }
         }
     }
+    graph_ = NodeGraph(nodes_.size(), edges);
 }
 
 void SymbolTable::performTopologicalSort()
 {
     topological_order_.clear();
+    cycle_.clear();
     has_cycle_ = false;
 
-    auto nodes = getAllNodeSymbols();
-    std::unordered_set<NodeSymbol *> visited;
-    std::unordered_set<NodeSymbol *> recursion_stack;
+    // Exported models list every node after its producers. One pass over the edges confirms that in linear time,
+    // and the source order is then the answer, the same one Kahn's algorithm below would give.
+    const auto node_count = graph_.nodeCount();
+    topological_order_.reserve(node_count);
+    bool in_source_order = true;
+    for (SymbolIndex node = 0; node < node_count && in_source_order; ++node)
+    {
+        for (const auto predecessor : graph_.predecessors(node))
+        {
+            in_source_order = in_source_order && predecessor < node;
+        }
+    }
+    if (in_source_order)
+    {
+        for (SymbolIndex node = 0; node < node_count; ++node)
+        {
+            topological_order_.push_back(&nodes_[node]);
+        }
+        return;
+    }
+
+    // Otherwise Kahn's algorithm. The ready nodes are kept in a min-heap on their index, so among the nodes that
+    // could go next the earliest in the source always does: independent nodes keep their source order. The heap
+    // makes this path O(n log n) rather than linear.
+    std::vector<uint32_t> in_degree(node_count);
+    std::priority_queue<SymbolIndex, std::vector<SymbolIndex>, std::greater<>> ready;
+    for (SymbolIndex node = 0; node < node_count; ++node)
+    {
+        in_degree[node] = static_cast<uint32_t>(graph_.predecessors(node).size());
+        if (in_degree[node] == 0)
+        {
+            ready.push(node);
+        }
+    }
 
-    for (auto *node : nodes)
+    while (!ready.empty())
     {
-        if (visited.find(node) == visited.end())
+        const auto node = ready.top();
+        ready.pop();
+        topological_order_.push_back(&nodes_[node]);
+        for (const auto successor : graph_.successors(node))
         {
-            if (!topologicalSortDFS(node, visited, recursion_stack))
+            if (--in_degree[successor] == 0)
             {
-                has_cycle_ = true;
-                topological_order_.clear();
-                return;
+                ready.push(successor);
             }
         }
     }
+    if (topological_order_.size() == node_count)
+    {
+        return;
+    }
 
-    // Reverse to get correct topological order
-    std::reverse(topological_order_.begin(), topological_order_.end());
+    // The nodes left with a nonzero in-degree are on a cycle or downstream of one. Peel off the downstream ones,
+    // those with no successor left, the same way from the other end; what remains lies on cycles.
+    std::vector<uint32_t> out_degree(node_count, 0);
+    std::vector<SymbolIndex> sinks;
+    for (SymbolIndex node = 0; node < node_count; ++node)
+    {
+        if (in_degree[node] == 0)
+        {
+            continue;
+        }
+        for (const auto successor : graph_.successors(node))
+        {
+            out_degree[node] += in_degree[successor] != 0 ? 1 : 0;
+        }
+        if (out_degree[node] == 0)
+        {
+            sinks.push_back(node);
+        }
+    }
+    while (!sinks.empty())
+    {
+        const auto node = sinks.back();
+        sinks.pop_back();
+        in_degree[node] = 0;
+        for (const auto predecessor : graph_.predecessors(node))
+        {
+            if (in_degree[predecessor] != 0 && --out_degree[predecessor] == 0)
+            {
+                sinks.push_back(predecessor);
+            }
+        }
+    }
+    for (SymbolIndex node = 0; node < node_count; ++node)
+    {
+        if (in_degree[node] != 0)
+        {
+            cycle_.push_back(&nodes_[node]);
+        }
+    }
+    has_cycle_ = true;
+    topological_order_.clear();
 }
 
-bool SymbolTable::topologicalSortDFS(NodeSymbol *node, std::unordered_set<NodeSymbol *> &visited,
-                                     std::unordered_set<NodeSymbol *> &recursion_stack)
+void SymbolTable::computeLevels(const unsigned jobs)
 {
-    visited.insert(node);
-    recursion_stack.insert(node);
+    levels_ = NodeLevels(graph_, jobs);
+}
 
-    if (dag_edges_.find(node) != dag_edges_.end())
+void SymbolTable::inferShapes()
+{
+    // What the model and the data say
+    tensor_types_.resize(tensors_.size());
+    tensor_shapes_.assign(tensors_.size(), std::nullopt);
+    for (const auto &tensor : tensors_)
     {
-        for (auto *child : dag_edges_[node])
+        const auto index = tensor.getIndex();
+        tensor_types_[index] = tensor.getDataType();
+        if (const auto *value = getFoldedValue(tensor))
         {
-            if (recursion_stack.find(child) != recursion_stack.end())
+            tensor_types_[index] = value->type;
+            tensor_shapes_[index].emplace();
+            for (const auto dim : value->dims)
             {
-                return false; // Cycle detected
+                tensor_shapes_[index]->push_back(ShapeDim::of(dim));
             }
-            if (visited.find(child) == visited.end())
+        }
+        else if (tensor.isInitializer())
+        {
+            tensor_shapes_[index].emplace();
+            for (const auto dim : tensor.getDims())
             {
-                if (!topologicalSortDFS(child, visited, recursion_stack))
-                {
-                    return false;
-                }
+                tensor_shapes_[index]->push_back(ShapeDim::of(dim));
             }
         }
+        else
+        {
+            tensor_shapes_[index] = tensor.getShape();
+        }
     }
 
-    recursion_stack.erase(node);
-    topological_order_.push_back(node);
-    return true;
+    // Contents are only decoded for the inputs a rule reads
+    std::vector<std::unique_ptr<Constant>> initializer_values(tensors_.size());
+
+    std::vector<ShapeInference::Input> inputs;
+    Attributes::List attributes;
+    for (const auto *node : topological_order_)
+    {
+        if (isFoldedNode(*node))
+            continue;
+
+        inputs.clear();
+        const auto op_type = node->getOpType();
+        for (size_t i = 0; i < node->getInputs().size(); ++i)
+        {
+            const auto &input = *node->getInputs()[i];
+            inputs.push_back(
+                {tensor_types_[input.getIndex()], &tensor_shapes_[input.getIndex()],
+                 ShapeInference::needsValue(op_type, i) ? constantValue(input, initializer_values) : nullptr});
+        }
+        collectAttributes(*node, attributes);
+
+        const auto &outputs = node->getOutputs();
+        auto inferred = ShapeInference::infer(op_type, inputs, attributes, outputs.size());
+        for (size_t i = 0; i < outputs.size(); ++i)
+        {
+            const auto index = outputs[i]->getIndex();
+            if (tensor_types_[index] == DataType::UNDEFINED)
+            {
+                tensor_types_[index] = inferred[i].type;
+            }
+            if (!tensor_shapes_[index])
+            {
+                tensor_shapes_[index] = std::move(inferred[i].shape);
+            }
+        }
+    }
 }
 
 void SymbolTable::detectConstantFolding()
 {
-    // Identify operations with all constant inputs
+    // Identify operations with all constant inputs; the output of such an operation is constant in turn
+    fold_candidates_.assign(nodes_.size(), false);
+    std::vector<bool> constant_tensors(tensors_.size(), false);
+    for (const auto &tensor : tensors_)
+    {
+        constant_tensors[tensor.getIndex()] = tensor.isInitializer();
+    }
+
     for (auto *node : topological_order_)
     {
         bool all_inputs_constant = true;
         for (const auto *input : node->getInputs())
         {
-            if (!input->isInitializer())
+            if (!constant_tensors[input->getIndex()])
             {
                 all_inputs_constant = false;
                 break;
             }
         }
 
-        if (all_inputs_constant && !node->getInputs().empty())
+        // Only single-output operations with a kernel, whose output is not fixed by the model already
+        const auto &outputs = node->getOutputs();
+        if (all_inputs_constant && !node->getInputs().empty() && outputs.size() == 1 &&
+            !outputs[0]->isInitializer() && !outputs[0]->isModelInput() &&
+            ConstantFolder::supports(node->getOpType()))
         {
-            // This node could be constant folded
-            // Mark for optimization (could add a flag to NodeSymbol)
+            fold_candidates_[node->getIndex()] = true;
+            constant_tensors[outputs[0]->getIndex()] = true;
         }
     }
 }
 
-void SymbolTable::detectDeadCode() const
+void SymbolTable::foldConstants()
 {
-    std::unordered_set<const TensorSymbol *> used_tensors;
+    detectConstantFolding();
+    folded_values_.clear();
+    folded_values_.resize(tensors_.size());
 
-    // Mark all model outputs as used
-    for (const auto *tensor : getAllTensorSymbols())
+    // Initializers are decoded on first use
+    std::vector<std::unique_ptr<Constant>> initializer_values(tensors_.size());
+
+    std::vector<const Constant *> inputs;
+    Attributes::List attributes;
+    for (const auto *node : topological_order_)
     {
-        if (tensor->isModelOutput())
+        if (node->getIndex() >= fold_candidates_.size() || !fold_candidates_[node->getIndex()])
+            continue;
+
+        // An input that could not be folded keeps this node from folding as well
+        inputs.clear();
+        for (const auto *input : node->getInputs())
         {
-            used_tensors.insert(tensor);
+            inputs.push_back(constantValue(*input, initializer_values));
         }
-    }
+        if (std::find(inputs.begin(), inputs.end(), nullptr) != inputs.end())
+            continue;
 
-    // Backward traversal to find all used nodes
-    std::unordered_set<NodeSymbol *> used_nodes;
-    std::queue<const TensorSymbol *> work_queue;
+        collectAttributes(*node, attributes);
 
-    for (const auto *tensor : used_tensors)
+        // The result must agree with the output's declared type, if it has one
+        const auto *output = node->getOutputs()[0];
+        auto value = ConstantFolder::fold(node->getOpType(), inputs, attributes);
+        if (value && (output->getDataType() == DataType::UNDEFINED || output->getDataType() == value->type))
+        {
+            folded_values_[output->getIndex()] = std::make_unique<Constant>(std::move(*value));
+        }
+    }
+}
+
+void SymbolTable::detectDeadCode()
+{
+    // The model outputs are live, and so are their producers unless the output was folded
+    live_nodes_.assign(nodes_.size(), false);
+    live_tensors_.assign(tensors_.size(), false);
+    std::queue<SymbolIndex> work_queue;
+    const auto markLive = [&](const TensorSymbol &tensor) {
+        live_tensors_[tensor.getIndex()] = true;
+        const auto *producer = tensor.getProducer();
+        if (producer && !getFoldedValue(tensor) && !live_nodes_[producer->getIndex()])
+        {
+            live_nodes_[producer->getIndex()] = true;
+            work_queue.push(producer->getIndex());
+        }
+    };
+    for (const auto &tensor : tensors_)
     {
-        work_queue.push(tensor);
+        if (tensor.isModelOutput())
+        {
+            markLive(tensor);
+        }
     }
 
+    // Backward traversal to find all used nodes and the tensors they read
     while (!work_queue.empty())
     {
-        const auto *tensor = work_queue.front();
+        const auto node = work_queue.front();
         work_queue.pop();
 
-        if (auto *producer = tensor->getProducer())
+        for (const auto *input : nodes_[node].getInputs())
+        {
+            markLive(*input);
+        }
+    }
+}
+
+auto SymbolTable::eliminateDeadCode() -> DeadCodeStats
+{
+    detectDeadCode();
+    prune_dead_code_ = true;
+
+    // Folded and merged nodes were not written to begin with
+    DeadCodeStats removed;
+    for (const auto &node : nodes_)
+    {
+        if (!isFoldedNode(node) && !isMergedNode(node) && !live_nodes_[node.getIndex()])
+        {
+            removed.operations += node.getOutputs().size();
+        }
+    }
+    for (const auto &tensor : tensors_)
+    {
+        if (isEmitted(tensor))
+            continue;
+        if (tensor.isInitializer())
+        {
+            ++removed.initializers;
+            removed.initializer_bytes += tensor.getRawDataDigits().size() / 2;
+        }
+        else if (const auto *value = getFoldedValue(tensor))
+        {
+            ++removed.initializers;
+            removed.initializer_bytes += value->bytes.size();
+        }
+    }
+    return removed;
+}
+
+void SymbolTable::detectCommonSubexpressions()
+{
+    node_representatives_.resize(nodes_.size());
+    for (SymbolIndex node = 0; node < nodes_.size(); ++node)
+    {
+        node_representatives_[node] = node;
+    }
+
+    // Attributes sorted by name and value, so their order in the model does not matter
+    std::vector<uint32_t> attribute_offsets(nodes_.size() + 1, 0);
+    std::vector<NodeSymbol::Attribute> attributes;
+    for (const auto &node : nodes_)
+    {
+        const auto begin = attributes.size();
+        attributes.insert(attributes.end(), node.getAttributes().begin(), node.getAttributes().end());
+        std::sort(attributes.begin() + static_cast<ptrdiff_t>(begin), attributes.end(),
+                  [](const NodeSymbol::Attribute &a, const NodeSymbol::Attribute &b) {
+                      return a.name != b.name ? a.name < b.name : a.value < b.value;
+                  });
+        attribute_offsets[node.getIndex() + 1] = static_cast<uint32_t>(attributes.size());
+    }
+
+    // Value number of each tensor: the index of the first tensor known to hold the same value
+    std::vector<SymbolIndex> values(tensors_.size());
+    for (SymbolIndex tensor = 0; tensor < tensors_.size(); ++tensor)
+    {
+        values[tensor] = tensor;
+    }
+
+    const auto hashOf = [&](const NodeSymbol &node) {
+        uint64_t hash = hashCombine(node.getOpTypeId(), node.getOutputs().size());
+        for (const auto *input : node.getInputs())
+        {
+            hash = hashCombine(hash, values[input->getIndex()]);
+        }
+        for (auto i = attribute_offsets[node.getIndex()]; i < attribute_offsets[node.getIndex() + 1]; ++i)
+        {
+            hash = hashCombine(hashCombine(hash, attributes[i].name), attributes[i].value);
+        }
+        return hash;
+    };
+    const auto equivalent = [&](const NodeSymbol &a, const NodeSymbol &b) {
+        const auto &a_inputs = a.getInputs();
+        const auto &b_inputs = b.getInputs();
+        if (a.getOpTypeId() != b.getOpTypeId() || a.getOutputs().size() != b.getOutputs().size() ||
+            a_inputs.size() != b_inputs.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a_inputs.size(); ++i)
+        {
+            if (values[a_inputs[i]->getIndex()] != values[b_inputs[i]->getIndex()])
+                return false;
+        }
+        const auto a_begin = attribute_offsets[a.getIndex()];
+        const auto b_begin = attribute_offsets[b.getIndex()];
+        const auto count = attribute_offsets[a.getIndex() + 1] - a_begin;
+        if (count != attribute_offsets[b.getIndex() + 1] - b_begin)
+            return false;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (attributes[a_begin + i].name != attributes[b_begin + i].name ||
+                attributes[a_begin + i].value != attributes[b_begin + i].value)
+                return false;
+        }
+        return true;
+    };
+
+    // Open addressing with linear probing, at most half full
+    static constexpr SymbolIndex EMPTY_SLOT = UINT32_MAX;
+    size_t capacity = 16;
+    while (capacity < 2 * nodes_.size())
+    {
+        capacity *= 2;
+    }
+    std::vector<SymbolIndex> table(capacity, EMPTY_SLOT);
+    std::vector<uint64_t> table_hashes(capacity);
+
+    for (const auto *node : topological_order_)
+    {
+        // Folded nodes are not computed at all, and random operators differ on every run
+        const auto &outputs = node->getOutputs();
+        if (outputs.empty() || isFoldedNode(*node) ||
+            std::find(std::begin(NONDETERMINISTIC_OPS), std::end(NONDETERMINISTIC_OPS), node->getOpType()) !=
+                std::end(NONDETERMINISTIC_OPS))
+            continue;
+
+        const auto hash = hashOf(*node);
+        auto slot = static_cast<size_t>(hash) & (capacity - 1);
+        while (table[slot] != EMPTY_SLOT &&
+               (table_hashes[slot] != hash || !equivalent(nodes_[table[slot]], *node)))
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == EMPTY_SLOT)
+        {
+            table[slot] = node->getIndex();
+            table_hashes[slot] = hash;
+            continue;
+        }
+
+        // A model output names the tensor itself, so its producer stays even if it repeats an earlier node
+        const auto is_model_output = [](const TensorSymbol *output) { return output->isModelOutput(); };
+        if (std::any_of(outputs.begin(), outputs.end(), is_model_output))
+            continue;
+
+        const auto &representative = nodes_[table[slot]];
+        node_representatives_[node->getIndex()] = representative.getIndex();
+        for (size_t i = 0; i < outputs.size(); ++i)
         {
-            if (used_nodes.insert(producer).second)
+            values[outputs[i]->getIndex()] = values[representative.getOutputs()[i]->getIndex()];
+        }
+    }
+}
+
+auto SymbolTable::eliminateCommonSubexpressions() -> size_t
+{
+    detectCommonSubexpressions();
+
+    // In topological order, each duplicate reads from representatives by the time its own users are moved
+    size_t removed = 0;
+    merged_nodes_.assign(nodes_.size(), false);
+    for (const auto *node : topological_order_)
+    {
+        const auto representative = node_representatives_[node->getIndex()];
+        if (representative == node->getIndex())
+            continue;
+
+        merged_nodes_[node->getIndex()] = true;
+        removed += node->getOutputs().size();
+        const auto &outputs = node->getOutputs();
+        for (size_t i = 0; i < outputs.size(); ++i)
+        {
+            auto &duplicate = tensors_[outputs[i]->getIndex()];
+            auto &replacement = tensors_[nodes_[representative].getOutputs()[i]->getIndex()];
+            for (auto *user : duplicate.getUsers())
             {
-                for (const auto *input : producer->getInputs())
-                {
-                    if (used_tensors.insert(input).second)
-                    {
-                        work_queue.push(input);
-                    }
-                }
+                user->replaceInput(&duplicate, &replacement);
             }
+            duplicate.clearUsers();
         }
     }
 
-    // Any node not in used_nodes is dead code
+    // Keep the graph in step with the new edges; the topological order is still valid, levels computed before
+    // are not
+    if (removed > 0)
+    {
+        buildDAG();
+        levels_ = NodeLevels();
+    }
+    return removed;
 }
 
-void SymbolTable::detectCommonSubexpressions()
+auto SymbolTable::planMemory() -> MemoryPlanStats
 {
-    std::map<std::string, std::vector<NodeSymbol *>> operation_patterns;
+    memory_plan_ = MemoryPlanStats();
+    tensor_offsets_.assign(tensors_.size(), NO_OFFSET);
+    tensor_sizes_.assign(tensors_.size(), 0);
+    if (tensor_types_.size() != tensors_.size())
+    {
+        return memory_plan_;
+    }
 
-    for (auto *node : topological_order_)
+    // Steps are positions among the written operations, so an operation left out of the TAC extends no lifetime
+    std::vector<uint32_t> first_step(tensors_.size(), 0);
+    std::vector<uint32_t> last_step(tensors_.size(), 0);
+    std::vector<SymbolIndex> intermediates;
+    uint32_t step = 0;
+    for (const auto *node : topological_order_)
     {
-        // Create a signature for the operation
-        std::string op_signature = node->getOpType() + ":";
+        if (!isEmitted(*node))
+            continue;
+
         for (const auto *input : node->getInputs())
         {
-            op_signature += input->getName() + ",";
+            last_step[input->getIndex()] = step;
+        }
+        for (const auto *output : node->getOutputs())
+        {
+            if (output->isModelOutput())
+                continue;
+            first_step[output->getIndex()] = step;
+            last_step[output->getIndex()] = step;
+            intermediates.push_back(output->getIndex());
         }
-        operation_patterns[op_signature].push_back(node);
+        ++step;
     }
 
-    // Nodes with the same pattern could be optimized
-    for (const auto &[pattern, nodes] : operation_patterns)
+    // Bytes of each intermediate, where its type has a fixed element size and every dimension is a number
+    std::vector<MemoryPlanner::Buffer> buffers;
+    std::vector<SymbolIndex> planned;
+    for (const auto index : intermediates)
     {
-        if (nodes.size() > 1)
+        const auto &shape = tensor_shapes_[index];
+        uint64_t size = Constant::elementSize(tensor_types_[index]);
+        bool known = size > 0 && shape.has_value();
+        for (size_t i = 0; known && i < shape->size(); ++i)
         {
-            // These nodes perform the same operation on the same inputs
-            // Mark for potential CSE optimization
+            const auto &dim = (*shape)[i];
+            known = dim.kind == ShapeDim::Kind::VALUE &&
+                    (dim.value == 0 || size <= (UINT64_MAX - MemoryPlanner::ALIGNMENT) / dim.value);
+            size *= known ? dim.value : 1;
         }
+        if (!known)
+        {
+            ++memory_plan_.unplanned;
+            continue;
+        }
+        tensor_sizes_[index] = size;
+        buffers.push_back({size, first_step[index], last_step[index]});
+        planned.push_back(index);
     }
+
+    const MemoryPlanner planner(buffers);
+    for (size_t i = 0; i < planned.size(); ++i)
+    {
+        tensor_offsets_[planned[i]] = planner.offset(i);
+    }
+    memory_plan_.arena_bytes = planner.arenaSize();
+    memory_plan_.planned = planned.size();
+    return memory_plan_;
 }
 
 void SymbolTable::clear()
 {
-    symbols_.clear();
-    dag_edges_.clear();
-    reverse_dag_edges_.clear();
+    nodes_.clear();
+    tensors_.clear();
+    slots_.clear();
+    graph_ = NodeGraph();
     topological_order_.clear();
+    cycle_.clear();
     has_cycle_ = false;
+    levels_ = NodeLevels();
+    fold_candidates_.clear();
+    folded_values_.clear();
+    live_nodes_.clear();
+    live_tensors_.clear();
+    prune_dead_code_ = false;
+    node_representatives_.clear();
+    merged_nodes_.clear();
+    tensor_types_.clear();
+    tensor_shapes_.clear();
+    tensor_offsets_.clear();
+    tensor_sizes_.clear();
+    memory_plan_ = MemoryPlanStats();
+    t_variable_counter_ = 1;
+    t_variables_.clear();
 }
 
-std::string SymbolTable::generateTACode() const
+std::string SymbolTable::generateTACode(const bool annotate_levels, const bool annotate_shapes) const
 {
     std::ostringstream code;
+    writeTACode(code, annotate_levels, annotate_shapes);
+    return code.str();
+}
+
+void SymbolTable::writeTACode(std::ostream &code, const bool annotate_levels, const bool annotate_shapes) const
+{
+    const bool write_memory = tensor_offsets_.size() == tensors_.size() && !tensors_.empty();
+    if (write_memory)
+    {
+        code << "# arena_bytes=" << memory_plan_.arena_bytes << '\n';
+    }
 
     // Generate Input tensors
-    for (const auto *tensor : getAllTensorSymbols())
+    for (const auto &tensor : tensors_)
     {
-        if (tensor->isModelInput())
+        if (tensor.isModelInput())
         {
-            std::string t_var = getOrCreateTVariableName(tensor->getName());
-            code << t_var << " = Input(\"" << tensor->getName() << "\", " << dataTypeToString(tensor->getDataType())
-                 << ", " << tensor->getShapeString() << ")\n";
+            code << 'T' << getOrCreateTVariable(tensor.getId()) << " = Input(\"" << tensor.getName() << "\", "
+                 << dataTypeToString(tensor.getDataType()) << ", " << tensor.getShapeString() << ")\n";
         }
     }
 
     // Generate Initializer tensors
-    for (const auto *tensor : getAllTensorSymbols())
+    for (const auto &tensor : tensors_)
     {
-        if (tensor->isInitializer())
+        if (tensor.isInitializer() && isEmitted(tensor))
         {
-            std::string t_var = getOrCreateTVariableName(tensor->getName());
-            code << t_var << " = Initializer(\"" << tensor->getName() << "\", "
-                 << dataTypeToString(tensor->getDataType()) << ", " << tensor->getShapeString()
-                 << ", raw_data=" << tensor->getRawDataHex() << ")\n";
+            code << 'T' << getOrCreateTVariable(tensor.getId()) << " = Initializer(\"" << tensor.getName() << "\", "
+                 << dataTypeToString(tensor.getDataType()) << ", " << tensor.getShapeString() << ", raw_data=";
+            writeRawData(code, tensor);
+            code << ")\n";
+        }
+    }
+
+    // Generate folded tensors, named after the tensor they stand for
+    for (const auto &tensor : tensors_)
+    {
+        const auto *value = getFoldedValue(tensor);
+        if (value && isEmitted(tensor))
+        {
+            code << 'T' << getOrCreateTVariable(tensor.getId()) << " = Initializer(\"" << tensor.getName() << "\", "
+                 << dataTypeToString(value->type) << ", [";
+            for (size_t i = 0; i < value->dims.size(); ++i)
+            {
+                if (i > 0)
+                    code << ", ";
+                code << value->dims[i];
+            }
+            code << "], raw_data=";
+            writeFoldedData(code, *value);
+            code << ")\n";
         }
     }
 
     // Generate Operations
-    for (auto it = topological_order_.begin(); it != topological_order_.end(); ++it)
+    const bool write_levels = annotate_levels && levels_.nodeCount() == nodes_.size();
+    const bool write_shapes = annotate_shapes && tensor_types_.size() == tensors_.size();
+    for (const auto *node : topological_order_)
     {
-        auto &node = *it;
+        if (!isEmitted(*node))
+            continue;
+
         // For each output of this node
         for (const auto *output : node->getOutputs())
         {
-            std::string result_var = getOrCreateTVariableName(output->getName());
-
-            std::string op_line = result_var + " = " + node->getOpType() + "(";
+            code << 'T' << getOrCreateTVariable(output->getId()) << " = " << node->getOpType() << "(";
 
             // Add input operands
             const auto &inputs = node->getInputs();
             for (size_t i = 0; i < inputs.size(); ++i)
             {
                 if (i > 0)
-                    op_line += ", ";
-                op_line += getOrCreateTVariableName(inputs[i]->getName());
+                    code << ", ";
+                code << 'T' << getOrCreateTVariable(inputs[i]->getId());
             }
 
             // Add attributes
@@ -310,26 +786,132 @@ std::string SymbolTable::generateTACode() const
             if (!attrs.empty())
             {
                 if (!inputs.empty())
-                    op_line += ", ";
-                op_line += attrs;
+                    code << ", ";
+                code << attrs;
             }
 
-            op_line += ")";
-            code << op_line << "\n";
+            code << ')';
+            const auto offset = write_memory ? tensor_offsets_[output->getIndex()] : NO_OFFSET;
+            if (write_levels || write_shapes || offset != NO_OFFSET)
+            {
+                code << "  #";
+            }
+            if (write_levels)
+            {
+                code << " level=" << levels_.asap(node->getIndex()) << " slack=" << levels_.slack(node->getIndex());
+            }
+            if (write_shapes)
+            {
+                code << " type=" << dataTypeToString(getInferredType(*output)) << " shape=";
+                writeShape(code, getInferredShape(*output));
+            }
+            if (offset != NO_OFFSET)
+            {
+                code << " offset=" << offset << " size=" << tensor_sizes_[output->getIndex()];
+            }
+            code << '\n';
         }
     }
 
     // Generate Output tensors
-    for (const auto *tensor : getAllTensorSymbols())
+    for (const auto &tensor : tensors_)
     {
-        if (tensor->isModelOutput())
+        if (tensor.isModelOutput())
         {
-            std::string t_var = getOrCreateTVariableName(tensor->getName());
-            code << "Output(\"" << tensor->getName() << "\", " << t_var << ")\n";
+            code << "Output(\"" << tensor.getName() << "\", T" << getOrCreateTVariable(tensor.getId()) << ")\n";
         }
     }
+}
 
-    return code.str();
+void SymbolTable::writeRawData(std::ostream &out, const TensorSymbol &tensor)
+{
+    const auto digits = tensor.getRawDataDigits();
+    out << "0x";
+    if (!tensor.rawDataHasUpperCase())
+    {
+        out.write(digits.data(), static_cast<std::streamsize>(digits.size()));
+        return;
+    }
+
+    // Setting bit 5 lower-cases A-F and leaves 0-9 unchanged
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    std::array<char, CHUNK_SIZE> buffer;
+    for (size_t offset = 0; offset < digits.size(); offset += CHUNK_SIZE)
+    {
+        const auto count = std::min(CHUNK_SIZE, digits.size() - offset);
+        for (size_t i = 0; i < count; ++i)
+        {
+            buffer[i] = static_cast<char>(digits[offset + i] | 0x20);
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(count));
+    }
+}
+
+// Like the shape strings of the model, with "?" for what is unknown
+void SymbolTable::writeShape(std::ostream &out, const std::optional<Shape> &shape) const
+{
+    if (!shape)
+    {
+        out << '?';
+        return;
+    }
+    out << '[';
+    for (size_t i = 0; i < shape->size(); ++i)
+    {
+        if (i > 0)
+            out << ", ";
+        const auto &dim = (*shape)[i];
+        switch (dim.kind)
+        {
+        case ShapeDim::Kind::VALUE:
+            out << dim.value;
+            break;
+        case ShapeDim::Kind::PARAM:
+            out << '"' << names_.view(dim.param) << '"';
+            break;
+        default:
+            out << '?';
+            break;
+        }
+    }
+    out << ']';
+}
+
+void SymbolTable::collectAttributes(const NodeSymbol &node, Attributes::List &attributes) const
+{
+    attributes.clear();
+    for (const auto &attribute : node.getAttributes())
+    {
+        attributes.emplace_back(names_.view(attribute.name), names_.view(attribute.value));
+    }
+}
+
+auto SymbolTable::constantValue(const TensorSymbol &tensor,
+                                std::vector<std::unique_ptr<Constant>> &initializer_values) const -> const Constant *
+{
+    if (!tensor.isInitializer())
+    {
+        return getFoldedValue(tensor);
+    }
+    auto &value = initializer_values[tensor.getIndex()];
+    if (!value && tensor.getRawDataDigits().size() % 2 == 0)
+    {
+        value = std::make_unique<Constant>(Constant{tensor.getDataType(), tensor.getDims(), tensor.decodeRawData()});
+    }
+    return value.get();
+}
+
+void SymbolTable::writeFoldedData(std::ostream &out, const Constant &value)
+{
+    out << "0x";
+    static constexpr size_t CHUNK_SIZE = 8 * 1024;
+    std::array<char, 2 * CHUNK_SIZE> buffer;
+    for (size_t offset = 0; offset < value.bytes.size(); offset += CHUNK_SIZE)
+    {
+        const auto count = std::min(CHUNK_SIZE, value.bytes.size() - offset);
+        HexCodec::encode(value.bytes.data() + offset, count, buffer.data());
+        out.write(buffer.data(), static_cast<std::streamsize>(2 * count));
+    }
 }
 
 std::string SymbolTable::dataTypeToString(DataType dtype)
@@ -349,19 +931,20 @@ std::string SymbolTable::dataTypeToString(DataType dtype)
     }
 }
 
-std::string SymbolTable::getOrCreateTVariableName(const std::string &original_name) const
+uint32_t SymbolTable::getOrCreateTVariable(SymbolId tensor_name) const
 {
-    // Check if we already assigned a T-variable name
-    auto it = tensor_to_t_mapping_.find(original_name);
-    if (it != tensor_to_t_mapping_.end())
+    if (tensor_name >= t_variables_.size())
     {
-        return it->second;
+        t_variables_.resize(std::max<size_t>(tensor_name + 1, names_.size()), 0);
     }
 
-    // Create new T-variable name
-    std::string t_name = "T" + std::to_string(t_variable_counter_++);
-    tensor_to_t_mapping_[original_name] = t_name;
-    return t_name;
+    // Assign the next T-variable number on first use
+    auto &t_variable = t_variables_[tensor_name];
+    if (t_variable == 0)
+    {
+        t_variable = t_variable_counter_++;
+    }
+    return t_variable;
 }
 
 bool SymbolTable::isModelInputOrOutput(const TensorSymbol *tensor)
@@ -1,28 +1,88 @@
 #ifndef SYMBOL_TABLE_HPP
 #define SYMBOL_TABLE_HPP
 
+#include "ConstantFolder.hpp"
+#include "MemoryPlanner.hpp"
+#include "NodeGraph.hpp"
+#include "NodeLevels.hpp"
+#include "ShapeInference.hpp"
+#include "SmallVector.hpp"
+#include "StringInterner.hpp"
 #include "ast/AST.hpp"
-#include <map>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <ostream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
 namespace sonnx
 {
 
+// Position of a symbol among the table's nodes or among its tensors, in declaration order
+using SymbolIndex = uint32_t;
+
+// What a name refers to in the table: nothing, or the node or tensor at index
+struct SymbolSlot
+{
+    enum class Kind : uint8_t
+    {
+        NONE,
+        NODE,
+        TENSOR
+    };
+    Kind kind = Kind::NONE;
+    SymbolIndex index = 0;
+};
+
+// What SymbolTable::eliminateDeadCode() removed from the TAC
+struct DeadCodeStats
+{
+    // Operation lines, one per output of each dead node
+    size_t operations = 0;
+    // Initializer lines, including those of folded tensors
+    size_t initializers = 0;
+    // Raw data bytes of those initializers
+    uint64_t initializer_bytes = 0;
+};
+
+// What SymbolTable::planMemory() placed in the activation arena
+struct MemoryPlanStats
+{
+    // Bytes the arena needs, the peak of live intermediate tensors as placed
+    uint64_t arena_bytes = 0;
+    // Intermediate tensors placed, and those left out because their type or shape is not fully known
+    size_t planned = 0;
+    size_t unplanned = 0;
+};
+
+// Common part of node and tensor symbols; never used polymorphically, the table stores each kind on its own
 class BaseSymbol
 {
   protected:
-    const std::string name_;
+    const SymbolId id_;
+    // The interner's copy of the name
+    const std::string_view name_;
     const ASTNode *definition_;
-    BaseSymbol(std::string name, const ASTNode *def) : name_(std::move(name)), definition_(def)
+    const SymbolIndex index_;
+    BaseSymbol(SymbolId id, std::string_view name, const ASTNode *def, SymbolIndex index)
+        : id_(id), name_(name), definition_(def), index_(index)
     {
     }
+    ~BaseSymbol() = default;
 
   public:
-    virtual ~BaseSymbol() = default;
-    const std::string &getName() const
+    SymbolId getId() const
+    {
+        return id_;
+    }
+    SymbolIndex getIndex() const
+    {
+        return index_;
+    }
+    std::string_view getName() const
     {
         return name_;
     }
@@ -35,32 +95,62 @@ class BaseSymbol
 class TensorSymbol;
 class NodeSymbol final : public BaseSymbol
 {
-    std::string op_type_;
-    std::vector<const TensorSymbol *> inputs_;
-    std::vector<const TensorSymbol *> outputs_;
+  public:
+    // Most operators have at most four inputs and one or two outputs
+    using InputList = SmallVector<const TensorSymbol *, 4>;
+    using OutputList = SmallVector<const TensorSymbol *, 2>;
+    // An attribute as written in the model; both parts are interned
+    struct Attribute
+    {
+        SymbolId name;
+        SymbolId value;
+    };
+    using AttributeList = SmallVector<Attribute, 2>;
+
+  private:
+    SymbolId op_type_id_;
+    std::string_view op_type_;
+    InputList inputs_;
+    OutputList outputs_;
+    AttributeList attributes_;
 
     std::string attributes_string_; // For storing attributes as "kernel_shape=[3, 3], strides=[1, 1]"
 
   public:
-    NodeSymbol(std::string name, std::string op_type, const ASTNode *def)
-        : BaseSymbol(std::move(name), def), op_type_(std::move(op_type))
+    NodeSymbol(SymbolId id, std::string_view name, SymbolId op_type_id, std::string_view op_type, const ASTNode *def,
+               SymbolIndex index)
+        : BaseSymbol(id, name, def, index), op_type_id_(op_type_id), op_type_(op_type)
     {
     }
 
-    const std::string &getOpType() const
+    SymbolId getOpTypeId() const
+    {
+        return op_type_id_;
+    }
+    std::string_view getOpType() const
     {
         return op_type_;
     }
     void addInput(TensorSymbol *tensor);
     void addOutput(TensorSymbol *tensor);
-    const std::vector<const TensorSymbol *> &getInputs() const
+    // Reads to wherever it read from; to gains this node as a user, from keeps its user list
+    void replaceInput(const TensorSymbol *from, TensorSymbol *to);
+    const InputList &getInputs() const
     {
         return inputs_;
     }
-    const std::vector<const TensorSymbol *> &getOutputs() const
+    const OutputList &getOutputs() const
     {
         return outputs_;
     }
+    void addAttribute(Attribute attribute)
+    {
+        attributes_.push_back(attribute);
+    }
+    const AttributeList &getAttributes() const
+    {
+        return attributes_;
+    }
 
     void setAttributesString(const std::string &attrs)
     {
@@ -76,7 +166,7 @@ class TensorSymbol final : public BaseSymbol
 {
     DataType dtype_;
     NodeSymbol *producer_ = nullptr;
-    std::vector<NodeSymbol *> users_;
+    SmallVector<NodeSymbol *, 2> users_;
 
     // Tensor properties
     bool is_initializer_ = false;
@@ -84,10 +174,18 @@ class TensorSymbol final : public BaseSymbol
     bool is_model_output_ = false;
 
     std::string shape_string_; // For storing shape as "[1, 3, 224, 224]"
-    std::string raw_data_hex_; // For storing raw data as "0x..."
+    // Dimensions of an initializer, as numbers
+    std::vector<uint64_t> dims_;
+    // Declared shape of an input, output or value; empty where the model gives none
+    std::optional<Shape> shape_;
+
+    // Validated hex digits of the raw data, viewed in the model source and never copied
+    std::string_view raw_data_digits_;
+    bool raw_data_has_upper_case_ = false;
 
   public:
-    TensorSymbol(std::string name, DataType dtype, const ASTNode *def) : BaseSymbol(std::move(name), def), dtype_(dtype)
+    TensorSymbol(SymbolId id, std::string_view name, DataType dtype, const ASTNode *def, SymbolIndex index)
+        : BaseSymbol(id, name, def, index), dtype_(dtype)
     {
     }
 
@@ -107,10 +205,14 @@ class TensorSymbol final : public BaseSymbol
     {
         users_.push_back(node);
     }
-    const std::vector<NodeSymbol *> &getUsers() const
+    const SmallVector<NodeSymbol *, 2> &getUsers() const
     {
         return users_;
     }
+    void clearUsers()
+    {
+        users_.clear();
+    }
 
     bool isInitializer() const
     {
@@ -145,50 +247,148 @@ class TensorSymbol final : public BaseSymbol
     {
         return shape_string_;
     }
+    void setDims(std::vector<uint64_t> dims)
+    {
+        dims_ = std::move(dims);
+    }
+    const std::vector<uint64_t> &getDims() const
+    {
+        return dims_;
+    }
+    void setShape(std::optional<Shape> shape)
+    {
+        shape_ = std::move(shape);
+    }
+    const std::optional<Shape> &getShape() const
+    {
+        return shape_;
+    }
 
-    void setRawDataHex(const std::string &hex)
+    void setRawData(std::string_view hex_digits, bool has_upper_case)
+    {
+        raw_data_digits_ = hex_digits;
+        raw_data_has_upper_case_ = has_upper_case;
+    }
+    std::string_view getRawDataDigits() const
     {
-        raw_data_hex_ = hex;
+        return raw_data_digits_;
     }
-    const std::string &getRawDataHex() const
+    bool rawDataHasUpperCase() const
     {
-        return raw_data_hex_;
+        return raw_data_has_upper_case_;
     }
+    // Only for passes that need the actual bytes; TAC emission copies the digits through
+    std::vector<uint8_t> decodeRawData() const;
 };
 
 class SymbolTable
 {
   private:
-    std::unordered_map<std::string, std::unique_ptr<BaseSymbol>> symbols_;
+    const StringInterner &names_;
+    // Nodes and tensors in declaration order. Symbols point at each other, so they live in deques, which never
+    // move an element as they grow; the elements still sit in contiguous blocks.
+    std::deque<NodeSymbol> nodes_;
+    std::deque<TensorSymbol> tensors_;
+    // Where each name points, indexed by its SymbolId
+    std::vector<SymbolSlot> slots_;
 
-    // DAG structure
-    std::map<NodeSymbol *, std::vector<NodeSymbol *>> dag_edges_;
-    std::map<NodeSymbol *, std::vector<NodeSymbol *>> reverse_dag_edges_;
+    // DAG structure, over node indices
+    NodeGraph graph_;
     std::vector<NodeSymbol *> topological_order_;
     bool has_cycle_ = false;
+    // Nodes on cycles (or between two of them) left over by the topological sort, in source order; empty if the
+    // graph is acyclic
+    std::vector<const NodeSymbol *> cycle_;
+    NodeLevels levels_;
+    // Nodes computable from initializers alone, indexed by node position; set by detectConstantFolding()
+    std::vector<bool> fold_candidates_;
+    // Values computed by foldConstants(), indexed by tensor position; null where nothing was folded
+    std::vector<std::unique_ptr<Constant>> folded_values_;
+    // Nodes and tensors that reach a model output, indexed by position; set by detectDeadCode()
+    std::vector<bool> live_nodes_;
+    std::vector<bool> live_tensors_;
+    bool prune_dead_code_ = false;
+    // For each node, the earlier node computing the same values, or its own index; set by
+    // detectCommonSubexpressions()
+    std::vector<SymbolIndex> node_representatives_;
+    // Nodes whose users eliminateCommonSubexpressions() moved to their representative
+    std::vector<bool> merged_nodes_;
+    // Type and shape of every tensor, declared or inferred, indexed by position; set by inferShapes()
+    std::vector<DataType> tensor_types_;
+    std::vector<std::optional<Shape>> tensor_shapes_;
+    // Arena offset and byte size of every tensor, indexed by position; the offset is NO_OFFSET where the tensor
+    // is not planned. Set by planMemory().
+    static constexpr uint64_t NO_OFFSET = UINT64_MAX;
+    std::vector<uint64_t> tensor_offsets_;
+    std::vector<uint64_t> tensor_sizes_;
+    MemoryPlanStats memory_plan_;
 
-    // Helper for topological sort
-    bool topologicalSortDFS(NodeSymbol *node, std::unordered_set<NodeSymbol *> &visited,
-                            std::unordered_set<NodeSymbol *> &recursion_stack);
+    auto claimSlot(SymbolId name, SymbolSlot::Kind kind, SymbolIndex index) -> bool;
 
   public:
+    // Names are ids in names, which must outlive the table
+    explicit SymbolTable(const StringInterner &names) : names_(names)
+    {
+    }
+
     // Symbol management
-    bool insertNodeSymbol(const std::string &name, const std::string &op_type, const ASTNode *def);
-    bool insertTensorSymbol(const std::string &name, DataType dtype, const ASTNode *def);
-    BaseSymbol *lookup(const std::string &name);
-    NodeSymbol *getNodeSymbol(const std::string &name);
-    TensorSymbol *getTensorSymbol(const std::string &name);
+    bool insertNodeSymbol(SymbolId name, SymbolId op_type, const ASTNode *def);
+    bool insertTensorSymbol(SymbolId name, DataType dtype, const ASTNode *def);
+    SymbolSlot lookup(SymbolId name) const
+    {
+        return name < slots_.size() ? slots_[name] : SymbolSlot{};
+    }
+    // nullptr when the name is unknown or names the other kind of symbol
+    NodeSymbol *getNodeSymbol(SymbolId name);
+    const NodeSymbol *getNodeSymbol(SymbolId name) const;
+    TensorSymbol *getTensorSymbol(SymbolId name);
+    const TensorSymbol *getTensorSymbol(SymbolId name) const;
 
-    // Collection access
-    std::vector<NodeSymbol *> getAllNodeSymbols() const;
-    std::vector<TensorSymbol *> getAllTensorSymbols() const;
+    // Collection access, in declaration order
+    const std::deque<NodeSymbol> &getNodeSymbols() const
+    {
+        return nodes_;
+    }
+    const std::deque<TensorSymbol> &getTensorSymbols() const
+    {
+        return tensors_;
+    }
 
     // DAG construction and analysis
     void buildDAG();
+    // Orders the nodes so that producers come first and independent nodes stay in source order; on a cycle the
+    // order is left empty and getCycle() names the nodes on it. Linear when the source order is already
+    // topological, O(n log n) otherwise.
     void performTopologicalSort();
+    // Wavefront levels of every node; the graph must be acyclic. jobs bounds the threads used on wide frontiers.
+    // Run after the passes that change edges, as eliminateCommonSubexpressions() drops the levels.
+    void computeLevels(unsigned jobs = 1);
+    // Types and shapes of node outputs, derived in topological order from the declared ones. A declared type or
+    // shape is kept as it is; initializers and folded tensors have theirs from their data.
+    void inferShapes();
+    // Marks the nodes computable from initializers alone
     void detectConstantFolding();
-    void detectDeadCode() const;
+    // Runs detectConstantFolding() and evaluates its candidates in topological order. A node whose types, shapes
+    // or attributes the kernels do not handle is left in place, and so is everything that depends on it.
+    void foldConstants();
+    // Marks the nodes and tensors a model output depends on. A folded tensor is a constant, so the nodes it was
+    // computed from are only live if something else needs them.
+    void detectDeadCode();
+    // Runs detectDeadCode() and leaves everything it did not mark out of the TAC. Model inputs are always kept,
+    // as they are the model's interface.
+    auto eliminateDeadCode() -> DeadCodeStats;
+    // Finds nodes that apply the same operation, with the same attributes, to the same values as an earlier node.
+    // Values are numbered in topological order, so a node is matched through duplicates upstream of it as well.
+    // Linear in the size of the graph.
     void detectCommonSubexpressions();
+    // Runs detectCommonSubexpressions() and moves the users of every duplicate to its representative, leaving
+    // the duplicate out of the TAC. Returns the number of operations removed.
+    auto eliminateCommonSubexpressions() -> size_t;
+    // Places the intermediate tensors, the outputs of operations other than model outputs, in one arena. A tensor
+    // lives from the operation writing it to the last operation reading it, in the order of the TAC, and tensors
+    // whose lifetimes overlap get disjoint ranges. Sizes come from inferShapes(), so a tensor with a dim_param or
+    // an unknown dimension is left out. Run after the passes that change which operations are written.
+    auto planMemory() -> MemoryPlanStats;
 
     // DAG access
     const std::vector<NodeSymbol *> &getTopologicalOrder() const
@@ -199,21 +399,78 @@ class SymbolTable
     {
         return has_cycle_;
     }
-    const std::map<NodeSymbol *, std::vector<NodeSymbol *>> &getDAGEdges() const
+    const std::vector<const NodeSymbol *> &getCycle() const
+    {
+        return cycle_;
+    }
+    // Edges run from the producer of a tensor to each node that reads it; valid after buildDAG()
+    const NodeGraph &getGraph() const
     {
-        return dag_edges_;
+        return graph_;
+    }
+    // Indexed by node position; empty until computeLevels()
+    const NodeLevels &getLevels() const
+    {
+        return levels_;
+    }
+    // Declared or inferred; UNDEFINED and empty until inferShapes()
+    DataType getInferredType(const TensorSymbol &tensor) const
+    {
+        return tensor.getIndex() < tensor_types_.size() ? tensor_types_[tensor.getIndex()] : DataType::UNDEFINED;
+    }
+    const std::optional<Shape> &getInferredShape(const TensorSymbol &tensor) const
+    {
+        static const std::optional<Shape> NO_SHAPE;
+        return tensor.getIndex() < tensor_shapes_.size() ? tensor_shapes_[tensor.getIndex()] : NO_SHAPE;
+    }
+    // The value foldConstants() computed for tensor, or nullptr
+    const Constant *getFoldedValue(const TensorSymbol &tensor) const
+    {
+        return tensor.getIndex() < folded_values_.size() ? folded_values_[tensor.getIndex()].get() : nullptr;
     }
 
     void clear();
 
-    std::string generateTACode() const;
+    // With annotate_levels, each operation ends in a "# level=<ASAP> slack=<ALAP - ASAP>" comment, and with
+    // annotate_shapes in a "# type=<type> shape=<shape>" one, after inferShapes(); both share one comment. After
+    // planMemory(), the TAC starts with a "# arena_bytes=<bytes>" line and the operation of each planned tensor
+    // adds "offset=<bytes> size=<bytes>" to that comment. Tensors computed by foldConstants() are written as
+    // initializers in place of the operations producing them, and after eliminateDeadCode() only live operations
+    // and initializers are written.
+    std::string generateTACode(bool annotate_levels = false, bool annotate_shapes = false) const;
+    void writeTACode(std::ostream &out, bool annotate_levels = false, bool annotate_shapes = false) const;
 
 private:
     static std::string dataTypeToString(DataType dtype);
-    mutable int t_variable_counter_ = 1;
-    mutable std::unordered_map<std::string, std::string> tensor_to_t_mapping_;
-    std::string getOrCreateTVariableName(const std::string& original_name) const;
+    mutable uint32_t t_variable_counter_ = 1;
+    // T-variable number of each tensor, indexed by SymbolId; 0 until one is assigned
+    mutable std::vector<uint32_t> t_variables_;
+    uint32_t getOrCreateTVariable(SymbolId tensor_name) const;
     static bool isModelInputOrOutput(const TensorSymbol* tensor) ;
+    bool isFoldedNode(const NodeSymbol &node) const
+    {
+        return node.getOutputs().size() == 1 && getFoldedValue(*node.getOutputs()[0]);
+    }
+    bool isMergedNode(const NodeSymbol &node) const
+    {
+        return node.getIndex() < merged_nodes_.size() && merged_nodes_[node.getIndex()];
+    }
+    bool isEmitted(const NodeSymbol &node) const
+    {
+        return !isFoldedNode(node) && !isMergedNode(node) && (!prune_dead_code_ || live_nodes_[node.getIndex()]);
+    }
+    bool isEmitted(const TensorSymbol &tensor) const
+    {
+        return !prune_dead_code_ || live_tensors_[tensor.getIndex()];
+    }
+    static void writeRawData(std::ostream &out, const TensorSymbol &tensor);
+    static void writeFoldedData(std::ostream &out, const Constant &value);
+    void writeShape(std::ostream &out, const std::optional<Shape> &shape) const;
+    void collectAttributes(const NodeSymbol &node, Attributes::List &attributes) const;
+    // The compile-time value of tensor: what foldConstants() computed, or an initializer's raw_data, decoded
+    // into initializer_values (indexed by tensor position) on first use. Nothing if raw_data has an odd length.
+    auto constantValue(const TensorSymbol &tensor, std::vector<std::unique_ptr<Constant>> &initializer_values) const
+        -> const Constant *;
 };
 
 } // namespace sonnx
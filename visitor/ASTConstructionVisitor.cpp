@@ -1,8 +1,6 @@
 #include "ASTConstructionVisitor.hpp"
 #include "ast/AST.hpp"
 #include "utils/Literal2Cpp.hpp"
-#include <memory>
-#include <utility>
 
 namespace sonnx
 {
@@ -76,17 +74,17 @@ std::string nodeToString(const ASTNode *node)
     }
     case NodeType::U32_LITERAL: {
         type_string = "U32_LITERAL";
-        value_string = " = " + std::to_string(dynamic_cast<const U32LiteralNode *>(node)->getValue());
+        value_string = " = " + std::to_string(static_cast<const U32LiteralNode *>(node)->getValue());
         break;
     }
     case NodeType::U64_LITERAL: {
         type_string = "U64_LITERAL";
-        value_string = " = " + std::to_string(dynamic_cast<const U64LiteralNode *>(node)->getValue());
+        value_string = " = " + std::to_string(static_cast<const U64LiteralNode *>(node)->getValue());
         break;
     }
     case NodeType::STR_LITERAL: {
         type_string = "STR_LITERAL";
-        value_string = " = \"" + dynamic_cast<const StrLiteralNode *>(node)->getValue() + "\"";
+        value_string = " = \"" + std::string(static_cast<const StrLiteralNode *>(node)->getValue()) + "\"";
         break;
     }
     case NodeType::BYTES_LITERAL: {
@@ -109,18 +107,19 @@ std::string nodeToString(const ASTNode *node)
     return type_string + value_string;
 }
 
-void ASTConstructionVisitor::printStack() const
+template <typename Builder>
+void BasicASTConstructionVisitor<Builder>::printStack() const
 {
     auto stackOperation = [this]() {
-        auto &mutableStack = const_cast<std::stack<std::unique_ptr<ASTNode>> &>(this->stack_);
-        std::vector<std::unique_ptr<ASTNode>> temp;
+        auto &mutableStack = const_cast<std::stack<Ref> &>(this->stack_);
+        std::vector<Ref> temp;
         temp.reserve(mutableStack.size());
 
         while (!mutableStack.empty())
         {
-            auto top = std::move(mutableStack.top());
+            auto top = mutableStack.top();
             mutableStack.pop();
-            temp.emplace_back(std::move(top));
+            temp.emplace_back(top);
         }
 
         return temp;
@@ -138,19 +137,26 @@ void ASTConstructionVisitor::printStack() const
     constexpr bool kShowMemoryAddress = false;
     for (auto it = temp.rbegin(); it != temp.rend(); ++it)
     {
-        std::cout << "  ╰─ " << nodeToString(it->get());
+        if constexpr (std::is_same_v<Ref, ASTNode *>)
+        {
+            std::cout << "  ╰─ " << nodeToString(*it);
+        }
+        else
+        {
+            std::cout << "  ╰─ flat node " << *it;
+        }
         if constexpr (kShowMemoryAddress)
         {
-            std::cout << " [" << it->get() << "]";
+            std::cout << " [" << *it << "]";
         }
         std::cout << '\n';
     }
 
-    auto restoreStack = [this, temp = std::move(temp)]() mutable {
-        auto &mutableStack = const_cast<std::stack<std::unique_ptr<ASTNode>> &>(this->stack_);
+    auto restoreStack = [this, &temp]() {
+        auto &mutableStack = const_cast<std::stack<Ref> &>(this->stack_);
         for (auto it = temp.rbegin(); it != temp.rend(); ++it)
         {
-            mutableStack.push(std::move(*it));
+            mutableStack.push(*it);
         }
     };
     restoreStack();
@@ -159,7 +165,8 @@ void ASTConstructionVisitor::printStack() const
 }
 #endif
 
-void ASTConstructionVisitor::reportError(const antlr4::ParserRuleContext *ctx, const std::string &message)
+template <typename Builder>
+void BasicASTConstructionVisitor<Builder>::reportError(const antlr4::ParserRuleContext *ctx, const std::string &message)
 {
     if (ctx != nullptr && ctx->getStart() != nullptr)
     {
@@ -175,7 +182,9 @@ void ASTConstructionVisitor::reportError(const antlr4::ParserRuleContext *ctx, c
     }
 }
 
-template <typename CtxType> void ASTConstructionVisitor::processU32U64(CtxType ctx)
+template <typename Builder>
+template <typename CtxType>
+void BasicASTConstructionVisitor<Builder>::processU32U64(CtxType ctx)
 {
     try
     {
@@ -196,11 +205,11 @@ template <typename CtxType> void ASTConstructionVisitor::processU32U64(CtxType c
         auto integer = Literal2Cpp::integerLiteral2CppInteger(token->getText());
         if (std::holds_alternative<uint32_t>(integer))
         {
-            stack_.push(std::make_unique<U32LiteralNode>(std::get<uint32_t>(integer)));
+            stack_.push(builder_.template make<U32LiteralNode>(std::get<uint32_t>(integer)));
         }
         else
         {
-            stack_.push(std::make_unique<U64LiteralNode>(std::get<uint64_t>(integer)));
+            stack_.push(builder_.template make<U64LiteralNode>(std::get<uint64_t>(integer)));
         }
     }
     catch (const std::exception &e)
@@ -209,7 +218,9 @@ template <typename CtxType> void ASTConstructionVisitor::processU32U64(CtxType c
     }
 }
 
-template <typename CtxType> void ASTConstructionVisitor::processString(CtxType ctx)
+template <typename Builder>
+template <typename CtxType>
+void BasicASTConstructionVisitor<Builder>::processString(CtxType ctx)
 {
     try
     {
@@ -228,7 +239,7 @@ template <typename CtxType> void ASTConstructionVisitor::processString(CtxType c
 
         auto *token = terminal_node->getSymbol();
         auto string = Literal2Cpp::stringLiteral2CppString(token->getText());
-        stack_.push(std::make_unique<StrLiteralNode>(string));
+        stack_.push(makeStrLiteral(string));
     }
     catch (const std::exception &e)
     {
@@ -236,7 +247,9 @@ template <typename CtxType> void ASTConstructionVisitor::processString(CtxType c
     }
 }
 
-template <typename CtxType> void ASTConstructionVisitor::processTypeEnum(CtxType ctx)
+template <typename Builder>
+template <typename CtxType>
+void BasicASTConstructionVisitor<Builder>::processTypeEnum(CtxType ctx)
 {
     try
     {
@@ -262,7 +275,7 @@ template <typename CtxType> void ASTConstructionVisitor::processTypeEnum(CtxType
             reportError(ctx, "Unknown or invalid data type");
             return;
         }
-        stack_.push(std::make_unique<TypeEnumNode>(type));
+        stack_.push(builder_.template make<TypeEnumNode>(type));
     }
     catch (const std::exception &e)
     {
@@ -270,7 +283,15 @@ template <typename CtxType> void ASTConstructionVisitor::processTypeEnum(CtxType
     }
 }
 
-std::any ASTConstructionVisitor::visitModel(antlr_sonnx::S_ONNXParser::ModelContext *ctx)
+template <typename Builder>
+auto BasicASTConstructionVisitor<Builder>::makeStrLiteral(std::string_view text) -> Ref
+{
+    const auto id = names_.intern(text);
+    return builder_.template make<StrLiteralNode>(id, names_.view(id));
+}
+
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitModel(antlr_sonnx::S_ONNXParser::ModelContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -288,43 +309,41 @@ std::any ASTConstructionVisitor::visitModel(antlr_sonnx::S_ONNXParser::ModelCont
             return nullptr;
         }
 
-        auto opset_version = std::move(stack_.top());
+        auto opset_version = stack_.top();
         stack_.pop();
-        auto opset_domain = std::move(stack_.top());
+        auto opset_domain = stack_.top();
         stack_.pop();
-        auto initializer_list = has_initializer_list_ ? std::move(stack_.top()) : nullptr;
+        auto initializer_list = has_initializer_list_ ? stack_.top() : Builder::NONE;
         if (has_initializer_list_)
         {
             stack_.pop();
             has_initializer_list_ = false;
         }
-        auto output_list = std::move(stack_.top());
+        auto output_list = stack_.top();
         stack_.pop();
-        auto input_list = std::move(stack_.top());
+        auto input_list = stack_.top();
         stack_.pop();
-        auto node_list = std::move(stack_.top());
+        auto node_list = stack_.top();
         stack_.pop();
-        auto graph_name = std::move(stack_.top());
+        auto graph_name = stack_.top();
         stack_.pop();
-        auto doc_string = std::move(stack_.top());
+        auto doc_string = stack_.top();
         stack_.pop();
-        auto model_version = std::move(stack_.top());
+        auto model_version = stack_.top();
         stack_.pop();
-        auto model_domain = std::move(stack_.top());
+        auto model_domain = stack_.top();
         stack_.pop();
-        auto producer_version = std::move(stack_.top());
+        auto producer_version = stack_.top();
         stack_.pop();
-        auto producer_name = std::move(stack_.top());
+        auto producer_name = stack_.top();
         stack_.pop();
-        auto ir_version = std::move(stack_.top());
+        auto ir_version = stack_.top();
         stack_.pop();
 
-        auto model = std::make_unique<ModelNode>(
-            std::move(ir_version), std::move(producer_name), std::move(producer_version), std::move(model_domain),
-            std::move(model_version), std::move(doc_string), std::move(graph_name), std::move(node_list),
-            std::move(input_list), std::move(output_list), std::move(initializer_list), std::move(opset_domain),
-            std::move(opset_version));
-        stack_.push(std::move(model));
+        auto model = builder_.template make<ModelNode>(ir_version, producer_name, producer_version, model_domain,
+                                                       model_version, doc_string, graph_name, node_list, input_list,
+                                                       output_list, initializer_list, opset_domain, opset_version);
+        stack_.push(model);
     }
     catch (const std::exception &e)
     {
@@ -333,7 +352,9 @@ std::any ASTConstructionVisitor::visitModel(antlr_sonnx::S_ONNXParser::ModelCont
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitModel_body_def(antlr_sonnx::S_ONNXParser::Model_body_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitModel_body_def(
+    antlr_sonnx::S_ONNXParser::Model_body_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -342,7 +363,9 @@ std::any ASTConstructionVisitor::visitModel_body_def(antlr_sonnx::S_ONNXParser::
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitIr_version_def(antlr_sonnx::S_ONNXParser::Ir_version_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitIr_version_def(
+    antlr_sonnx::S_ONNXParser::Ir_version_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -356,7 +379,9 @@ std::any ASTConstructionVisitor::visitIr_version_def(antlr_sonnx::S_ONNXParser::
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitProducer_name_def(antlr_sonnx::S_ONNXParser::Producer_name_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitProducer_name_def(
+    antlr_sonnx::S_ONNXParser::Producer_name_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -370,7 +395,9 @@ std::any ASTConstructionVisitor::visitProducer_name_def(antlr_sonnx::S_ONNXParse
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitProducer_version_def(antlr_sonnx::S_ONNXParser::Producer_version_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitProducer_version_def(
+    antlr_sonnx::S_ONNXParser::Producer_version_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -384,7 +411,8 @@ std::any ASTConstructionVisitor::visitProducer_version_def(antlr_sonnx::S_ONNXPa
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitDomain_def(antlr_sonnx::S_ONNXParser::Domain_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitDomain_def(antlr_sonnx::S_ONNXParser::Domain_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -398,7 +426,9 @@ std::any ASTConstructionVisitor::visitDomain_def(antlr_sonnx::S_ONNXParser::Doma
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitModel_version_def(antlr_sonnx::S_ONNXParser::Model_version_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitModel_version_def(
+    antlr_sonnx::S_ONNXParser::Model_version_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -412,7 +442,9 @@ std::any ASTConstructionVisitor::visitModel_version_def(antlr_sonnx::S_ONNXParse
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitDoc_string_def(antlr_sonnx::S_ONNXParser::Doc_string_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitDoc_string_def(
+    antlr_sonnx::S_ONNXParser::Doc_string_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -426,7 +458,8 @@ std::any ASTConstructionVisitor::visitDoc_string_def(antlr_sonnx::S_ONNXParser::
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitGraph_def(antlr_sonnx::S_ONNXParser::Graph_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitGraph_def(antlr_sonnx::S_ONNXParser::Graph_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -435,7 +468,9 @@ std::any ASTConstructionVisitor::visitGraph_def(antlr_sonnx::S_ONNXParser::Graph
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitGraph_body_def(antlr_sonnx::S_ONNXParser::Graph_body_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitGraph_body_def(
+    antlr_sonnx::S_ONNXParser::Graph_body_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -444,7 +479,8 @@ std::any ASTConstructionVisitor::visitGraph_body_def(antlr_sonnx::S_ONNXParser::
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitName_def(antlr_sonnx::S_ONNXParser::Name_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitName_def(antlr_sonnx::S_ONNXParser::Name_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -458,7 +494,8 @@ std::any ASTConstructionVisitor::visitName_def(antlr_sonnx::S_ONNXParser::Name_d
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitNode_list(antlr_sonnx::S_ONNXParser::Node_listContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitNode_list(antlr_sonnx::S_ONNXParser::Node_listContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -470,7 +507,7 @@ std::any ASTConstructionVisitor::visitNode_list(antlr_sonnx::S_ONNXParser::Node_
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> nodes{};
+        std::vector<Ref> nodes{};
         nodes.reserve(ctx->NODE().size());
 
         if (stack_.size() < ctx->NODE().size())
@@ -481,14 +518,14 @@ std::any ASTConstructionVisitor::visitNode_list(antlr_sonnx::S_ONNXParser::Node_
 
         for (size_t i = 0; i < ctx->NODE().size(); ++i)
         {
-            nodes.push_back(std::move(stack_.top()));
+            nodes.push_back(stack_.top());
             stack_.pop();
         }
         // Reverse to maintain correct order
         std::reverse(nodes.begin(), nodes.end());
 
-        auto node_list = std::make_unique<NodeListNode>(std::move(nodes));
-        stack_.push(std::move(node_list));
+        auto node_list = builder_.template makeList<NodeListNode>(nodes);
+        stack_.push(node_list);
     }
     catch (const std::exception &e)
     {
@@ -497,7 +534,8 @@ std::any ASTConstructionVisitor::visitNode_list(antlr_sonnx::S_ONNXParser::Node_
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitInput_list(antlr_sonnx::S_ONNXParser::Input_listContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitInput_list(antlr_sonnx::S_ONNXParser::Input_listContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -509,7 +547,7 @@ std::any ASTConstructionVisitor::visitInput_list(antlr_sonnx::S_ONNXParser::Inpu
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> inputs{};
+        std::vector<Ref> inputs{};
         inputs.reserve(ctx->INPUT().size());
 
         if (stack_.size() < ctx->INPUT().size())
@@ -520,13 +558,13 @@ std::any ASTConstructionVisitor::visitInput_list(antlr_sonnx::S_ONNXParser::Inpu
 
         for (size_t i = 0; i < ctx->INPUT().size(); ++i)
         {
-            inputs.push_back(std::move(stack_.top()));
+            inputs.push_back(stack_.top());
             stack_.pop();
         }
         std::reverse(inputs.begin(), inputs.end());
 
-        auto input_list = std::make_unique<InputListNode>(std::move(inputs));
-        stack_.push(std::move(input_list));
+        auto input_list = builder_.template makeList<InputListNode>(inputs);
+        stack_.push(input_list);
     }
     catch (const std::exception &e)
     {
@@ -535,7 +573,8 @@ std::any ASTConstructionVisitor::visitInput_list(antlr_sonnx::S_ONNXParser::Inpu
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitOutput_list(antlr_sonnx::S_ONNXParser::Output_listContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitOutput_list(antlr_sonnx::S_ONNXParser::Output_listContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -547,7 +586,7 @@ std::any ASTConstructionVisitor::visitOutput_list(antlr_sonnx::S_ONNXParser::Out
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> outputs{};
+        std::vector<Ref> outputs{};
         outputs.reserve(ctx->OUTPUT().size());
 
         if (stack_.size() < ctx->OUTPUT().size())
@@ -558,13 +597,13 @@ std::any ASTConstructionVisitor::visitOutput_list(antlr_sonnx::S_ONNXParser::Out
 
         for (size_t i = 0; i < ctx->OUTPUT().size(); ++i)
         {
-            outputs.push_back(std::move(stack_.top()));
+            outputs.push_back(stack_.top());
             stack_.pop();
         }
         std::reverse(outputs.begin(), outputs.end());
 
-        auto output_list = std::make_unique<OutputListNode>(std::move(outputs));
-        stack_.push(std::move(output_list));
+        auto output_list = builder_.template makeList<OutputListNode>(outputs);
+        stack_.push(output_list);
     }
     catch (const std::exception &e)
     {
@@ -573,7 +612,9 @@ std::any ASTConstructionVisitor::visitOutput_list(antlr_sonnx::S_ONNXParser::Out
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitInitializer_list(antlr_sonnx::S_ONNXParser::Initializer_listContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitInitializer_list(
+    antlr_sonnx::S_ONNXParser::Initializer_listContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -585,7 +626,7 @@ std::any ASTConstructionVisitor::visitInitializer_list(antlr_sonnx::S_ONNXParser
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> initializers{};
+        std::vector<Ref> initializers{};
         initializers.reserve(ctx->INITIALIZER().size());
 
         if (stack_.size() < ctx->INITIALIZER().size())
@@ -596,13 +637,13 @@ std::any ASTConstructionVisitor::visitInitializer_list(antlr_sonnx::S_ONNXParser
 
         for (size_t i = 0; i < ctx->INITIALIZER().size(); ++i)
         {
-            initializers.push_back(std::move(stack_.top()));
+            initializers.push_back(stack_.top());
             stack_.pop();
         }
         std::reverse(initializers.begin(), initializers.end());
 
-        auto initializer_list = std::make_unique<InitializerListNode>(std::move(initializers));
-        stack_.push(std::move(initializer_list));
+        auto initializer_list = builder_.template makeList<InitializerListNode>(initializers);
+        stack_.push(initializer_list);
         has_initializer_list_ = true;
     }
     catch (const std::exception &e)
@@ -612,7 +653,8 @@ std::any ASTConstructionVisitor::visitInitializer_list(antlr_sonnx::S_ONNXParser
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitNode_def(antlr_sonnx::S_ONNXParser::Node_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitNode_def(antlr_sonnx::S_ONNXParser::Node_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -630,24 +672,23 @@ std::any ASTConstructionVisitor::visitNode_def(antlr_sonnx::S_ONNXParser::Node_d
             return nullptr;
         }
 
-        auto attribute_list = has_attribute_list_ ? std::move(stack_.top()) : nullptr;
+        auto attribute_list = has_attribute_list_ ? stack_.top() : Builder::NONE;
         if (has_attribute_list_)
         {
             stack_.pop();
             has_attribute_list_ = false;
         }
-        auto output = std::move(stack_.top());
+        auto output = stack_.top();
         stack_.pop();
-        auto input = std::move(stack_.top());
+        auto input = stack_.top();
         stack_.pop();
-        auto name = std::move(stack_.top());
+        auto name = stack_.top();
         stack_.pop();
-        auto op_type = std::move(stack_.top());
+        auto op_type = stack_.top();
         stack_.pop();
 
-        auto node = std::make_unique<NodeNode>(std::move(op_type), std::move(name), std::move(input), std::move(output),
-                                               std::move(attribute_list));
-        stack_.push(std::move(node));
+        auto node = builder_.template make<NodeNode>(op_type, name, input, output, attribute_list);
+        stack_.push(node);
     }
     catch (const std::exception &e)
     {
@@ -656,7 +697,8 @@ std::any ASTConstructionVisitor::visitNode_def(antlr_sonnx::S_ONNXParser::Node_d
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitOp_type_def(antlr_sonnx::S_ONNXParser::Op_type_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitOp_type_def(antlr_sonnx::S_ONNXParser::Op_type_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -670,7 +712,8 @@ std::any ASTConstructionVisitor::visitOp_type_def(antlr_sonnx::S_ONNXParser::Op_
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitInput_arr(antlr_sonnx::S_ONNXParser::Input_arrContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitInput_arr(antlr_sonnx::S_ONNXParser::Input_arrContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -682,16 +725,16 @@ std::any ASTConstructionVisitor::visitInput_arr(antlr_sonnx::S_ONNXParser::Input
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> input_elements{};
+        std::vector<Ref> input_elements{};
         input_elements.reserve(ctx->STRING_LITERAL().size());
         for (auto *elem : ctx->STRING_LITERAL())
         {
             auto *token = elem->getSymbol();
             auto string = Literal2Cpp::stringLiteral2CppString(token->getText());
-            input_elements.push_back(std::make_unique<StrLiteralNode>(string));
+            input_elements.push_back(makeStrLiteral(string));
         }
-        auto input_array = std::make_unique<InputArrNode>(std::move(input_elements));
-        stack_.push(std::move(input_array));
+        auto input_array = builder_.template makeList<InputArrNode>(input_elements);
+        stack_.push(input_array);
     }
     catch (const std::exception &e)
     {
@@ -700,7 +743,8 @@ std::any ASTConstructionVisitor::visitInput_arr(antlr_sonnx::S_ONNXParser::Input
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitOutput_arr(antlr_sonnx::S_ONNXParser::Output_arrContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitOutput_arr(antlr_sonnx::S_ONNXParser::Output_arrContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -712,16 +756,16 @@ std::any ASTConstructionVisitor::visitOutput_arr(antlr_sonnx::S_ONNXParser::Outp
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> output_elements{};
+        std::vector<Ref> output_elements{};
         output_elements.reserve(ctx->STRING_LITERAL().size());
         for (auto *elem : ctx->STRING_LITERAL())
         {
             auto *token = elem->getSymbol();
             auto string = Literal2Cpp::stringLiteral2CppString(token->getText());
-            output_elements.push_back(std::make_unique<StrLiteralNode>(string));
+            output_elements.push_back(makeStrLiteral(string));
         }
-        auto input_array = std::make_unique<OutputArrNode>(std::move(output_elements));
-        stack_.push(std::move(input_array));
+        auto input_array = builder_.template makeList<OutputArrNode>(output_elements);
+        stack_.push(input_array);
     }
     catch (const std::exception &e)
     {
@@ -730,7 +774,9 @@ std::any ASTConstructionVisitor::visitOutput_arr(antlr_sonnx::S_ONNXParser::Outp
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitAttribute_list(antlr_sonnx::S_ONNXParser::Attribute_listContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitAttribute_list(
+    antlr_sonnx::S_ONNXParser::Attribute_listContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -742,7 +788,7 @@ std::any ASTConstructionVisitor::visitAttribute_list(antlr_sonnx::S_ONNXParser::
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> attributes{};
+        std::vector<Ref> attributes{};
         attributes.reserve(ctx->ATTRIBUTE().size());
 
         if (stack_.size() < ctx->ATTRIBUTE().size())
@@ -753,13 +799,13 @@ std::any ASTConstructionVisitor::visitAttribute_list(antlr_sonnx::S_ONNXParser::
 
         for (size_t i = 0; i < ctx->ATTRIBUTE().size(); ++i)
         {
-            attributes.push_back(std::move(stack_.top()));
+            attributes.push_back(stack_.top());
             stack_.pop();
         }
         std::reverse(attributes.begin(), attributes.end());
 
-        auto attribute_list = std::make_unique<AttributeListNode>(std::move(attributes));
-        stack_.push(std::move(attribute_list));
+        auto attribute_list = builder_.template makeList<AttributeListNode>(attributes);
+        stack_.push(attribute_list);
         has_attribute_list_ = true;
     }
     catch (const std::exception &e)
@@ -769,7 +815,8 @@ std::any ASTConstructionVisitor::visitAttribute_list(antlr_sonnx::S_ONNXParser::
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitAttribute_def(antlr_sonnx::S_ONNXParser::Attribute_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitAttribute_def(antlr_sonnx::S_ONNXParser::Attribute_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -787,13 +834,13 @@ std::any ASTConstructionVisitor::visitAttribute_def(antlr_sonnx::S_ONNXParser::A
             return nullptr;
         }
 
-        auto value = std::move(stack_.top());
+        auto value = stack_.top();
         stack_.pop();
-        auto name = std::move(stack_.top());
+        auto name = stack_.top();
         stack_.pop();
 
-        auto attribute = std::make_unique<AttributeNode>(std::move(name), std::move(value));
-        stack_.push(std::move(attribute));
+        auto attribute = builder_.template make<AttributeNode>(name, value);
+        stack_.push(attribute);
     }
     catch (const std::exception &e)
     {
@@ -802,7 +849,8 @@ std::any ASTConstructionVisitor::visitAttribute_def(antlr_sonnx::S_ONNXParser::A
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitValue_def(antlr_sonnx::S_ONNXParser::Value_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitValue_def(antlr_sonnx::S_ONNXParser::Value_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -816,7 +864,9 @@ std::any ASTConstructionVisitor::visitValue_def(antlr_sonnx::S_ONNXParser::Value
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitValue_info_def(antlr_sonnx::S_ONNXParser::Value_info_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitValue_info_def(
+    antlr_sonnx::S_ONNXParser::Value_info_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -834,15 +884,15 @@ std::any ASTConstructionVisitor::visitValue_info_def(antlr_sonnx::S_ONNXParser::
             return nullptr;
         }
 
-        auto shape = std::move(stack_.top());
+        auto shape = stack_.top();
         stack_.pop();
-        auto type = std::move(stack_.top());
+        auto type = stack_.top();
         stack_.pop();
-        auto name = std::move(stack_.top());
+        auto name = stack_.top();
         stack_.pop();
 
-        auto io_tensor = std::make_unique<IOTensorNode>(std::move(name), std::move(type), std::move(shape));
-        stack_.push(std::move(io_tensor));
+        auto io_tensor = builder_.template make<IOTensorNode>(name, type, shape);
+        stack_.push(io_tensor);
     }
     catch (const std::exception &e)
     {
@@ -851,7 +901,8 @@ std::any ASTConstructionVisitor::visitValue_info_def(antlr_sonnx::S_ONNXParser::
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitType_def(antlr_sonnx::S_ONNXParser::Type_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitType_def(antlr_sonnx::S_ONNXParser::Type_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -860,7 +911,9 @@ std::any ASTConstructionVisitor::visitType_def(antlr_sonnx::S_ONNXParser::Type_d
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitTensor_type_def(antlr_sonnx::S_ONNXParser::Tensor_type_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitTensor_type_def(
+    antlr_sonnx::S_ONNXParser::Tensor_type_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -869,7 +922,8 @@ std::any ASTConstructionVisitor::visitTensor_type_def(antlr_sonnx::S_ONNXParser:
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitElem_type_def(antlr_sonnx::S_ONNXParser::Elem_type_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitElem_type_def(antlr_sonnx::S_ONNXParser::Elem_type_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -883,7 +937,8 @@ std::any ASTConstructionVisitor::visitElem_type_def(antlr_sonnx::S_ONNXParser::E
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitShape_def(antlr_sonnx::S_ONNXParser::Shape_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitShape_def(antlr_sonnx::S_ONNXParser::Shape_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -892,7 +947,8 @@ std::any ASTConstructionVisitor::visitShape_def(antlr_sonnx::S_ONNXParser::Shape
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitDim_list(antlr_sonnx::S_ONNXParser::Dim_listContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitDim_list(antlr_sonnx::S_ONNXParser::Dim_listContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -904,16 +960,16 @@ std::any ASTConstructionVisitor::visitDim_list(antlr_sonnx::S_ONNXParser::Dim_li
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> io_dims{};
+        std::vector<Ref> io_dims{};
         io_dims.reserve(ctx->DIM().size());
         for (size_t i = 0; i < ctx->DIM().size(); ++i)
         {
-            io_dims.push_back(std::move(stack_.top()));
+            io_dims.push_back(stack_.top());
             stack_.pop();
         }
         std::reverse(io_dims.begin(), io_dims.end());
-        auto input_list = std::make_unique<IOShapeNode>(std::move(io_dims));
-        stack_.push(std::move(input_list));
+        auto input_list = builder_.template makeList<IOShapeNode>(io_dims);
+        stack_.push(input_list);
     }
     catch (const std::exception &e)
     {
@@ -922,7 +978,8 @@ std::any ASTConstructionVisitor::visitDim_list(antlr_sonnx::S_ONNXParser::Dim_li
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitDim_def(antlr_sonnx::S_ONNXParser::Dim_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitDim_def(antlr_sonnx::S_ONNXParser::Dim_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -950,7 +1007,8 @@ std::any ASTConstructionVisitor::visitDim_def(antlr_sonnx::S_ONNXParser::Dim_def
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitTensor_def(antlr_sonnx::S_ONNXParser::Tensor_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitTensor_def(antlr_sonnx::S_ONNXParser::Tensor_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -969,18 +1027,17 @@ std::any ASTConstructionVisitor::visitTensor_def(antlr_sonnx::S_ONNXParser::Tens
             return nullptr;
         }
 
-        auto raw_data = std::move(stack_.top());
+        auto raw_data = stack_.top();
         stack_.pop();
-        auto shape = std::move(stack_.top());
+        auto shape = stack_.top();
         stack_.pop();
-        auto type = std::move(stack_.top());
+        auto type = stack_.top();
         stack_.pop();
-        auto name = std::move(stack_.top());
+        auto name = stack_.top();
         stack_.pop();
 
-        auto tensor =
-            std::make_unique<InitTensorNode>(std::move(name), std::move(type), std::move(shape), std::move(raw_data));
-        stack_.push(std::move(tensor));
+        auto tensor = builder_.template make<InitTensorNode>(name, type, shape, raw_data);
+        stack_.push(tensor);
     }
     catch (const std::exception &e)
     {
@@ -989,7 +1046,8 @@ std::any ASTConstructionVisitor::visitTensor_def(antlr_sonnx::S_ONNXParser::Tens
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitData_type_def(antlr_sonnx::S_ONNXParser::Data_type_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitData_type_def(antlr_sonnx::S_ONNXParser::Data_type_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -1003,7 +1061,8 @@ std::any ASTConstructionVisitor::visitData_type_def(antlr_sonnx::S_ONNXParser::D
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitDims_def(antlr_sonnx::S_ONNXParser::Dims_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitDims_def(antlr_sonnx::S_ONNXParser::Dims_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -1015,7 +1074,7 @@ std::any ASTConstructionVisitor::visitDims_def(antlr_sonnx::S_ONNXParser::Dims_d
 #endif
     try
     {
-        std::vector<std::unique_ptr<ASTNode>> dim_values{};
+        std::vector<Ref> dim_values{};
         dim_values.reserve(ctx->INTEGER_LITERAL().size());
         for (auto *dim : ctx->INTEGER_LITERAL())
         {
@@ -1025,20 +1084,20 @@ std::any ASTConstructionVisitor::visitDims_def(antlr_sonnx::S_ONNXParser::Dims_d
                 auto integer = Literal2Cpp::integerLiteral2CppInteger(token->getText());
                 if (std::holds_alternative<uint32_t>(integer))
                 {
-                    dim_values.push_back(std::make_unique<U32LiteralNode>(std::get<uint32_t>(integer)));
+                    dim_values.push_back(builder_.template make<U32LiteralNode>(std::get<uint32_t>(integer)));
                 }
                 else
                 {
-                    dim_values.push_back(std::make_unique<U64LiteralNode>(std::get<uint64_t>(integer)));
+                    dim_values.push_back(builder_.template make<U64LiteralNode>(std::get<uint64_t>(integer)));
                 }
             }
             catch (const std::out_of_range &)
             {
-                dim_values.push_back(std::make_unique<ErrorNode>());
+                dim_values.push_back(builder_.template make<ErrorNode>());
             }
         }
-        auto init_shape = std::make_unique<InitShapeNode>(std::move(dim_values));
-        stack_.push(std::move(init_shape));
+        auto init_shape = builder_.template makeList<InitShapeNode>(dim_values);
+        stack_.push(init_shape);
     }
     catch (const std::exception &e)
     {
@@ -1047,7 +1106,8 @@ std::any ASTConstructionVisitor::visitDims_def(antlr_sonnx::S_ONNXParser::Dims_d
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitRaw_data_def(antlr_sonnx::S_ONNXParser::Raw_data_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitRaw_data_def(antlr_sonnx::S_ONNXParser::Raw_data_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -1072,9 +1132,10 @@ std::any ASTConstructionVisitor::visitRaw_data_def(antlr_sonnx::S_ONNXParser::Ra
             return nullptr;
         }
 
+        // Slice the literal out of the source instead of materialising the token text
         auto *token = terminal_node->getSymbol();
-        auto bytes = Literal2Cpp::bytesLiteral2CppBytes(token->getText());
-        stack_.push(std::make_unique<BytesLiteralNode>(std::move(bytes)));
+        auto literal = source_.substr(token->getStartIndex(), token->getStopIndex() - token->getStartIndex() + 1);
+        stack_.push(builder_.template make<BytesLiteralNode>(Literal2Cpp::bytesLiteral2HexDigits(literal)));
     }
     catch (const std::exception &e)
     {
@@ -1083,7 +1144,9 @@ std::any ASTConstructionVisitor::visitRaw_data_def(antlr_sonnx::S_ONNXParser::Ra
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitOpset_import_def(antlr_sonnx::S_ONNXParser::Opset_import_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitOpset_import_def(
+    antlr_sonnx::S_ONNXParser::Opset_import_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -1092,7 +1155,8 @@ std::any ASTConstructionVisitor::visitOpset_import_def(antlr_sonnx::S_ONNXParser
     return nullptr;
 }
 
-std::any ASTConstructionVisitor::visitVersion_def(antlr_sonnx::S_ONNXParser::Version_defContext *ctx)
+template <typename Builder>
+std::any BasicASTConstructionVisitor<Builder>::visitVersion_def(antlr_sonnx::S_ONNXParser::Version_defContext *ctx)
 {
     for (auto child : ctx->children)
     {
@@ -1106,4 +1170,7 @@ std::any ASTConstructionVisitor::visitVersion_def(antlr_sonnx::S_ONNXParser::Ver
     return nullptr;
 }
 
+template class BasicASTConstructionVisitor<TreeBuilder>;
+template class BasicASTConstructionVisitor<FlatBuilder>;
+
 } // namespace sonnx
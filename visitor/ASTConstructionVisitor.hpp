@@ -3,25 +3,36 @@
 
 #include "S_ONNXBaseVisitor.h"
 #include "S_ONNXParser.h"
-#include "ast/AST.hpp"
-#include <memory>
+#include "ast/ASTBuilder.hpp"
+#include "utils/StringInterner.hpp"
 #include <stack>
+#include <string_view>
 
 // #define DEBUG_AST_CONSTRUCTION
 
 namespace sonnx
 {
 
-class ASTConstructionVisitor final : public antlr_sonnx::S_ONNXBaseVisitor
+// Builds the AST from the ANTLR parse tree. Builder is TreeBuilder or FlatBuilder (see ast/ASTBuilder.hpp) and
+// decides which form the AST takes.
+template <typename Builder> class BasicASTConstructionVisitor final : public antlr_sonnx::S_ONNXBaseVisitor
 {
+  public:
+    using Ref = typename Builder::Ref;
+
   private:
-    std::stack<std::unique_ptr<ASTNode>> stack_;
+    Builder &builder_;
+    StringInterner &names_;
+    std::stack<Ref> stack_;
+    // Model source the token offsets refer to; bytes literals are kept as views into it
+    std::string_view source_;
     bool has_initializer_list_ = false;
     bool has_attribute_list_ = false;
 
     template <typename CtxType> void processU32U64(CtxType ctx);
     template <typename CtxType> void processString(CtxType ctx);
     template <typename CtxType> void processTypeEnum(CtxType ctx);
+    auto makeStrLiteral(std::string_view text) -> Ref;
 
     // Error reporting helper method
     static void reportError(const antlr4::ParserRuleContext *ctx, const std::string &message);
@@ -30,13 +41,19 @@ class ASTConstructionVisitor final : public antlr_sonnx::S_ONNXBaseVisitor
 #endif
 
   public:
-    auto getTop() -> std::unique_ptr<ASTNode>
+    // String literals are interned in names; it must outlive the AST, as must whatever builder writes to
+    BasicASTConstructionVisitor(Builder &builder, StringInterner &names, std::string_view source)
+        : builder_(builder), names_(names), source_(source)
+    {
+    }
+
+    auto getTop() -> Ref
     {
         if (stack_.empty())
         {
             throw std::runtime_error("AST construction failed: empty stack");
         }
-        auto result = std::move(stack_.top());
+        auto result = stack_.top();
         stack_.pop();
         return result;
     }
@@ -78,6 +95,9 @@ class ASTConstructionVisitor final : public antlr_sonnx::S_ONNXBaseVisitor
     std::any visitVersion_def(antlr_sonnx::S_ONNXParser::Version_defContext *ctx) override;
 };
 
+using ASTConstructionVisitor = BasicASTConstructionVisitor<TreeBuilder>;
+using FlatASTConstructionVisitor = BasicASTConstructionVisitor<FlatBuilder>;
+
 } // namespace sonnx
 
 #endif // AST_CONSTRUCTION_VISITOR_HPP
@@ -1,5 +1,6 @@
 #include "ASTOutputVisitor.hpp"
 #include "ast/AST.hpp"
+#include "utils/HexCodec.hpp"
 #include <cstddef>
 #include <string>
 
@@ -81,55 +82,55 @@ void ASTOutputVisitor::visit(const ModelNode &node)
     ++m_indent_level;
     if (node.getIrVersion() != nullptr)
     {
-        node.getIrVersion()->accept(*this);
+        dispatch(*node.getIrVersion());
     }
     if (node.getProducerName() != nullptr)
     {
-        node.getProducerName()->accept(*this);
+        dispatch(*node.getProducerName());
     }
     if (node.getProducerVersion() != nullptr)
     {
-        node.getProducerVersion()->accept(*this);
+        dispatch(*node.getProducerVersion());
     }
     if (node.getDomain() != nullptr)
     {
-        node.getDomain()->accept(*this);
+        dispatch(*node.getDomain());
     }
     if (node.getModelVersion() != nullptr)
     {
-        node.getModelVersion()->accept(*this);
+        dispatch(*node.getModelVersion());
     }
     if (node.getDocString() != nullptr)
     {
-        node.getDocString()->accept(*this);
+        dispatch(*node.getDocString());
     }
     if (node.getGraphName() != nullptr)
     {
-        node.getGraphName()->accept(*this);
+        dispatch(*node.getGraphName());
     }
     if (node.getNodeList() != nullptr)
     {
-        node.getNodeList()->accept(*this);
+        dispatch(*node.getNodeList());
     }
     if (node.getInputList() != nullptr)
     {
-        node.getInputList()->accept(*this);
+        dispatch(*node.getInputList());
     }
     if (node.getOutputList() != nullptr)
     {
-        node.getOutputList()->accept(*this);
+        dispatch(*node.getOutputList());
     }
     if (node.getInitializerList() != nullptr)
     {
-        node.getInitializerList()->accept(*this);
+        dispatch(*node.getInitializerList());
     }
     if (node.getOpsetDomain() != nullptr)
     {
-        node.getOpsetDomain()->accept(*this);
+        dispatch(*node.getOpsetDomain());
     }
     if (node.getOpsetVersion() != nullptr)
     {
-        node.getOpsetVersion()->accept(*this);
+        dispatch(*node.getOpsetVersion());
     }
     --m_indent_level;
     addIndent();
@@ -143,7 +144,7 @@ void ASTOutputVisitor::visit(const NodeListNode &node)
     ++m_indent_level;
     for (const auto &node_in_list : node.getNodes())
     {
-        node_in_list->accept(*this);
+        dispatch(*node_in_list);
     }
     --m_indent_level;
     addIndent();
@@ -157,7 +158,7 @@ void ASTOutputVisitor::visit(const InputListNode &node)
     ++m_indent_level;
     for (const auto &input : node.getIOTensors())
     {
-        input->accept(*this);
+        dispatch(*input);
     }
     --m_indent_level;
     addIndent();
@@ -171,7 +172,7 @@ void ASTOutputVisitor::visit(const OutputListNode &node)
     ++m_indent_level;
     for (const auto &output : node.getIOTensors())
     {
-        output->accept(*this);
+        dispatch(*output);
     }
     --m_indent_level;
     addIndent();
@@ -185,7 +186,7 @@ void ASTOutputVisitor::visit(const InitializerListNode &node)
     ++m_indent_level;
     for (const auto &initializer : node.getInitTensors())
     {
-        initializer->accept(*this);
+        dispatch(*initializer);
     }
     --m_indent_level;
     addIndent();
@@ -199,23 +200,23 @@ void ASTOutputVisitor::visit(const NodeNode &node)
     ++m_indent_level;
     if (node.getOpType() != nullptr)
     {
-        node.getOpType()->accept(*this);
+        dispatch(*node.getOpType());
     }
     if (node.getName() != nullptr)
     {
-        node.getName()->accept(*this);
+        dispatch(*node.getName());
     }
     if (node.getInputListOrArray() != nullptr)
     {
-        node.getInputListOrArray()->accept(*this);
+        dispatch(*node.getInputListOrArray());
     }
     if (node.getOutputListOrArray() != nullptr)
     {
-        node.getOutputListOrArray()->accept(*this);
+        dispatch(*node.getOutputListOrArray());
     }
     if (node.getAttributeList() != nullptr)
     {
-        node.getAttributeList()->accept(*this);
+        dispatch(*node.getAttributeList());
     }
     --m_indent_level;
     addIndent();
@@ -229,7 +230,7 @@ void ASTOutputVisitor::visit(const InputArrNode &node)
     ++m_indent_level;
     for (const auto &elem : node.getInputElements())
     {
-        elem->accept(*this);
+        dispatch(*elem);
     }
     --m_indent_level;
     addIndent();
@@ -243,7 +244,7 @@ void ASTOutputVisitor::visit(const OutputArrNode &node)
     ++m_indent_level;
     for (const auto &elem : node.getOutputElements())
     {
-        elem->accept(*this);
+        dispatch(*elem);
     }
     --m_indent_level;
     addIndent();
@@ -257,7 +258,7 @@ void ASTOutputVisitor::visit(const AttributeListNode &node)
     ++m_indent_level;
     for (const auto &attr : node.getAttributes())
     {
-        attr->accept(*this);
+        dispatch(*attr);
     }
     --m_indent_level;
     addIndent();
@@ -271,11 +272,11 @@ void ASTOutputVisitor::visit(const AttributeNode &node)
     ++m_indent_level;
     if (node.getName() != nullptr)
     {
-        node.getName()->accept(*this);
+        dispatch(*node.getName());
     }
     if (node.getValue() != nullptr)
     {
-        node.getValue()->accept(*this);
+        dispatch(*node.getValue());
     }
     --m_indent_level;
     addIndent();
@@ -289,15 +290,15 @@ void ASTOutputVisitor::visit(const IOTensorNode &node)
     ++m_indent_level;
     if (node.getName() != nullptr)
     {
-        node.getName()->accept(*this);
+        dispatch(*node.getName());
     }
     if (node.getType() != nullptr)
     {
-        node.getType()->accept(*this);
+        dispatch(*node.getType());
     }
     if (node.getIOShape() != nullptr)
     {
-        node.getIOShape()->accept(*this);
+        dispatch(*node.getIOShape());
     }
     --m_indent_level;
     addIndent();
@@ -311,7 +312,7 @@ void ASTOutputVisitor::visit(const IOShapeNode &node)
     ++m_indent_level;
     for (const auto &elem : node.getIODims())
     {
-        elem->accept(*this);
+        dispatch(*elem);
     }
     --m_indent_level;
     addIndent();
@@ -325,19 +326,19 @@ void ASTOutputVisitor::visit(const InitTensorNode &node)
     ++m_indent_level;
     if (node.getName() != nullptr)
     {
-        node.getName()->accept(*this);
+        dispatch(*node.getName());
     }
     if (node.getType() != nullptr)
     {
-        node.getType()->accept(*this);
+        dispatch(*node.getType());
     }
     if (node.getInitShape() != nullptr)
     {
-        node.getInitShape()->accept(*this);
+        dispatch(*node.getInitShape());
     }
     if (node.getRawData() != nullptr)
     {
-        node.getRawData()->accept(*this);
+        dispatch(*node.getRawData());
     }
     --m_indent_level;
     addIndent();
@@ -346,6 +347,16 @@ void ASTOutputVisitor::visit(const InitTensorNode &node)
 
 void ASTOutputVisitor::visit(const InitShapeNode &node)
 {
+    addIndent();
+    m_ss << "(" << nodeTypeToString(node.getASTNodeType()) << "\n";
+    ++m_indent_level;
+    for (const auto &elem : node.getDimValues())
+    {
+        dispatch(*elem);
+    }
+    --m_indent_level;
+    addIndent();
+    m_ss << ")\n";
 }
 
 void ASTOutputVisitor::visit(const U32LiteralNode &node)
@@ -369,17 +380,10 @@ void ASTOutputVisitor::visit(const StrLiteralNode &node)
 void ASTOutputVisitor::visit(const BytesLiteralNode &node)
 {
     addIndent();
-    m_ss << "(" << nodeTypeToString(node.getASTNodeType()) << " [";
-    const auto &bytes = node.getValue();
-    for (size_t i = 0; i < bytes.size(); ++i)
-    {
-        m_ss << static_cast<int>(bytes[i]);
-        if (i < bytes.size() - 1)
-        {
-            m_ss << ", ";
-        }
-    }
-    m_ss << "])\n";
+    const auto bytes = node.decode();
+    std::string hex(bytes.size() * 2, '0');
+    HexCodec::encode(bytes.data(), bytes.size(), hex.data());
+    m_ss << "(" << nodeTypeToString(node.getASTNodeType()) << " 0x" << hex << ")\n";
 }
 
 void ASTOutputVisitor::visit(const TypeEnumNode &node)
@@ -1,7 +1,7 @@
 #ifndef AST_OUTPUT_VISITOR_HPP
 #define AST_OUTPUT_VISITOR_HPP
 
-#include "ASTBaseVisitor.hpp"
+#include "ASTStaticVisitor.hpp"
 #include <sstream>
 
 #define SPACE_1 " "
@@ -12,7 +12,7 @@
 namespace sonnx
 {
 
-class ASTOutputVisitor final : public ASTBaseVisitor
+class ASTOutputVisitor final : public ASTStaticVisitor<ASTOutputVisitor>
 {
   private:
     std::stringstream m_ss;
@@ -40,26 +40,26 @@ class ASTOutputVisitor final : public ASTBaseVisitor
         return m_ss.str();
     }
 
-    void visit(const U32LiteralNode &node) override;
-    void visit(const U64LiteralNode &node) override;
-    void visit(const StrLiteralNode &node) override;
-    void visit(const BytesLiteralNode &node) override;
-    void visit(const TypeEnumNode &node) override;
-    void visit(const ModelNode &node) override;
-    void visit(const NodeListNode &node) override;
-    void visit(const InputListNode &node) override;
-    void visit(const OutputListNode &node) override;
-    void visit(const InitializerListNode &node) override;
-    void visit(const NodeNode &node) override;
-    void visit(const InputArrNode &node) override;
-    void visit(const OutputArrNode &node) override;
-    void visit(const AttributeListNode &node) override;
-    void visit(const AttributeNode &node) override;
-    void visit(const IOTensorNode &node) override;
-    void visit(const IOShapeNode &node) override;
-    void visit(const InitTensorNode &node) override;
-    void visit(const InitShapeNode &node) override;
-    void visit(const ErrorNode &node) override;
+    void visit(const U32LiteralNode &node);
+    void visit(const U64LiteralNode &node);
+    void visit(const StrLiteralNode &node);
+    void visit(const BytesLiteralNode &node);
+    void visit(const TypeEnumNode &node);
+    void visit(const ModelNode &node);
+    void visit(const NodeListNode &node);
+    void visit(const InputListNode &node);
+    void visit(const OutputListNode &node);
+    void visit(const InitializerListNode &node);
+    void visit(const NodeNode &node);
+    void visit(const InputArrNode &node);
+    void visit(const OutputArrNode &node);
+    void visit(const AttributeListNode &node);
+    void visit(const AttributeNode &node);
+    void visit(const IOTensorNode &node);
+    void visit(const IOShapeNode &node);
+    void visit(const InitTensorNode &node);
+    void visit(const InitShapeNode &node);
+    void visit(const ErrorNode &node);
 };
 
 } // namespace sonnx
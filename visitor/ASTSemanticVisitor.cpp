@@ -1,7 +1,7 @@
 #include "ASTSemanticVisitor.hpp"
-
-#include <iomanip>
-#include <sstream>
+#include "utils/HexCodec.hpp"
+#include "utils/ParallelFor.hpp"
+#include <algorithm>
 
 // #define DEBUG_IO_CONSISTENCY
 
@@ -17,42 +17,36 @@ void ASTSemanticVisitor::visit(const ModelNode &node)
     if (should_terminate_analysis_)
         return;
 
-    // Pass 1: Collect all declarations from nodes
-    is_declaration_pass_ = true;
+    // Register nodes and collect their tensor references as fixups
     if (node.getNodeList())
     {
-        node.getNodeList()->accept(*this);
+        dispatch(*node.getNodeList());
     }
 
-    // Pass 2: Process all definitions and validate references
-    is_declaration_pass_ = false;
+    // Define the model's tensors, then link the nodes to them
     if (node.getInitializerList())
     {
         processing_initializers_ = true;
-        node.getInitializerList()->accept(*this);
+        dispatch(*node.getInitializerList());
         processing_initializers_ = false;
     }
 
     if (node.getInputList())
     {
         processing_model_inputs_ = true;
-        node.getInputList()->accept(*this);
+        dispatch(*node.getInputList());
         processing_model_inputs_ = false;
     }
 
     if (node.getOutputList())
     {
         processing_model_outputs_ = true;
-        node.getOutputList()->accept(*this);
+        dispatch(*node.getOutputList());
         processing_model_outputs_ = false;
     }
 
-    if (node.getNodeList())
-    {
-        node.getNodeList()->accept(*this);
-    }
+    resolveNodeFixups();
 
-    // Perform semantic analysis after both passes
     performSemanticAnalysis();
 }
 
@@ -65,7 +59,7 @@ void ASTSemanticVisitor::visit(const NodeListNode &node)
     {
         if (n)
         {
-            n->accept(*this);
+            dispatch(*n);
         }
     }
 }
@@ -79,7 +73,7 @@ void ASTSemanticVisitor::visit(const InputListNode &node)
     {
         if (tensor)
         {
-            tensor->accept(*this);
+            dispatch(*tensor);
         }
     }
 }
@@ -93,7 +87,7 @@ void ASTSemanticVisitor::visit(const OutputListNode &node)
     {
         if (tensor)
         {
-            tensor->accept(*this);
+            dispatch(*tensor);
         }
     }
 }
@@ -107,7 +101,7 @@ void ASTSemanticVisitor::visit(const InitializerListNode &node)
     {
         if (tensor)
         {
-            tensor->accept(*this);
+            dispatch(*tensor);
         }
     }
 }
@@ -117,140 +111,260 @@ void ASTSemanticVisitor::visit(const NodeNode &node)
     if (should_terminate_analysis_)
         return;
 
-    std::string node_name = extractStringFromNode(node.getName());
-    std::string op_type = extractStringFromNode(node.getOpType());
+    const auto node_name = extractSymbolFromNode(node.getName());
+    const auto op_type = extractSymbolFromNode(node.getOpType());
+    if (!beginNode(node_name))
+        return;
 
-    if (node_name.empty())
+    // Collect references and the tensors of inline lists
+    processing_node_tensors_ = true;
+    if (node.getInputListOrArray())
+    {
+        dispatch(*node.getInputListOrArray());
+    }
+
+    if (node.getOutputListOrArray())
+    {
+        dispatch(*node.getOutputListOrArray());
+    }
+    processing_node_tensors_ = false;
+
+    if (node.getAttributeList())
+    {
+        dispatch(*node.getAttributeList());
+    }
+
+    finishNode(node_name, op_type, &node);
+}
+
+bool ASTSemanticVisitor::beginNode(SymbolId node_name)
+{
+    if (node_name == StringInterner::EMPTY)
     {
         reportError("Empty node name");
+        return false;
+    }
+
+    NodeFixup fixup{};
+    fixup.name = node_name;
+    fixup.inputs_begin = static_cast<uint32_t>(input_refs_.size());
+    fixup.outputs_begin = static_cast<uint32_t>(output_refs_.size());
+    fixup.tensors_begin = static_cast<uint32_t>(node_tensors_.size());
+    node_fixups_.push_back(fixup);
+    node_attributes_.clear();
+    return true;
+}
+
+void ASTSemanticVisitor::finishNode(SymbolId node_name, SymbolId op_type, const ASTNode *def)
+{
+    auto &fixup = node_fixups_.back();
+    fixup.op_type = op_type;
+    fixup.def = def;
+    fixup.inputs_end = static_cast<uint32_t>(input_refs_.size());
+    fixup.outputs_end = static_cast<uint32_t>(output_refs_.size());
+    fixup.tensors_end = static_cast<uint32_t>(node_tensors_.size());
+
+    if (!symbol_table_.insertNodeSymbol(node_name, op_type, def))
+    {
+        reportError("Duplicate node definition: " + nameOf(node_name));
         return;
     }
 
-    node_input_refs_.insert({node_name, {}});
-    node_output_refs_.insert({node_name, {}});
-    current_node_name_ = node_name;
+    auto *node_sym = symbol_table_.getNodeSymbol(node_name);
+    for (const auto &attribute : node_attributes_)
+    {
+        node_sym->addAttribute(attribute);
+    }
+}
 
-    // Process inputs and outputs to collect references
-    if (node.getInputListOrArray())
+void ASTSemanticVisitor::resolveNodeFixups()
+{
+    if (should_terminate_analysis_)
+        return;
+
+    // Link in node order, so an input can only name the output of an earlier node unless a tensor list defines it.
+    // Names and producers are claimed here, serially, but the links are only attached once the type checks up to
+    // that node have passed. Stops after the first node with an error, whose errors are held back for now.
+    input_tensors_.assign(input_refs_.size(), nullptr);
+    output_tensors_.assign(output_refs_.size(), nullptr);
+    std::vector<const NodeSymbol *> producers;
+    std::vector<std::string> link_errors;
+    size_t linked = 0;
+    for (auto &fixup : node_fixups_)
     {
-        node.getInputListOrArray()->accept(*this);
+        const auto error_count = errors_.size();
+        for (auto i = fixup.tensors_begin; i < fixup.tensors_end && !should_terminate_analysis_; ++i)
+        {
+            const auto &tensor = node_tensors_[i];
+            defineTensor(tensor.name, tensor.data_type, tensor.shape, tensor.dims, tensor.def);
+        }
+        resolveNodeLinks(fixup, producers);
+        fixup.tensor_count = static_cast<uint32_t>(symbol_table_.getTensorSymbols().size());
+        ++linked;
+
+        if (errors_.size() != error_count)
+        {
+            link_errors.assign(errors_.begin() + static_cast<ptrdiff_t>(error_count), errors_.end());
+            errors_.resize(error_count);
+            break;
+        }
     }
+    if (linked == 0)
+        return;
 
-    if (node.getOutputListOrArray())
+    // Type checks only read the table; each chunk keeps its first failing node, the earliest of which wins
+    static constexpr size_t CHUNK_SIZE = 1024;
+    const auto chunk_count = (linked + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<std::pair<size_t, std::string>> mismatches(chunk_count, {linked, std::string()});
+    parallelFor(chunk_count, linked >= PARALLEL_NODE_COUNT ? jobs_ : 1, [&](const size_t chunk) {
+        const auto end = std::min(linked, (chunk + 1) * CHUNK_SIZE);
+        for (auto i = chunk * CHUNK_SIZE; i < end; ++i)
+        {
+            auto message = checkNodeIOTypeConsistency(node_fixups_[i]);
+            if (!message.empty())
+            {
+                mismatches[chunk] = {i, std::move(message)};
+                return;
+            }
+        }
+    });
+    auto first_mismatch = std::pair<size_t, std::string>(linked, std::string());
+    for (auto &mismatch : mismatches)
     {
-        node.getOutputListOrArray()->accept(*this);
+        if (mismatch.first < first_mismatch.first)
+        {
+            first_mismatch = std::move(mismatch);
+        }
     }
 
-    if (is_declaration_pass_)
+    // Attach the links up to the first node that failed, then report in the order a serial run would
+    const auto last = std::min(first_mismatch.first, linked - 1);
+    for (size_t i = 0; i < linked && i <= last; ++i)
+    {
+        attachNodeLinks(node_fixups_[i]);
+    }
+    if (last == linked - 1)
     {
-        // First pass: register the node
-        if (!symbol_table_.insertNodeSymbol(node_name, op_type, &node))
+        for (const auto &error : link_errors)
         {
-            reportError("Duplicate node definition: " + node_name);
+            reportError(error);
         }
     }
-    else
+    if (first_mismatch.first == last)
     {
-        // Second pass: validate and link inputs/outputs
+        reportError(first_mismatch.second);
+    }
+}
+
+void ASTSemanticVisitor::resolveNodeLinks(NodeFixup &fixup, std::vector<const NodeSymbol *> &producers)
+{
+    const auto node_name = fixup.name;
+    fixup.symbol = symbol_table_.getNodeSymbol(node_name);
+    if (!fixup.symbol)
+    {
+        reportError("Node symbol not found for: " + nameOf(node_name));
+        return;
+    }
 
-        // IMPORTANT: Get the node symbol first
-        NodeSymbol *node_symbol = symbol_table_.getNodeSymbol(node_name);
-        if (!node_symbol)
+    // Validate inputs
+    for (auto i = fixup.inputs_begin; i < fixup.inputs_end; ++i)
+    {
+        const auto input_ref = input_refs_[i];
+        if (input_ref == StringInterner::EMPTY)
         {
-            reportError("Node symbol not found for: " + node_name);
-            return;
+            // Empty string is allowed for optional inputs
+            continue;
         }
 
-        // Validate and link inputs
-        for (const auto &input_ref : node_input_refs_.at(node_name))
+        if (auto *tensor = symbol_table_.getTensorSymbol(input_ref))
         {
-            if (input_ref.empty())
-            {
-                // Empty string is allowed for optional inputs
-                continue;
-            }
+            input_tensors_[i] = tensor;
+        }
+        else
+        {
+            reportError("Node '" + nameOf(node_name) + "' references undefined input: " + nameOf(input_ref));
+        }
+    }
 
-            if (auto *tensor = symbol_table_.getTensorSymbol(input_ref))
-            {
-                // FIX: Actually add the input to the node
-                node_symbol->addInput(tensor);
-                tensor->addUser(node_symbol);
-            }
-            else
-            {
-                reportError("Node '" + node_name + "' references undefined input: " + input_ref);
-            }
+    // Validate outputs, creating the ones no list defines
+    for (auto i = fixup.outputs_begin; i < fixup.outputs_end; ++i)
+    {
+        const auto output_ref = output_refs_[i];
+        if (output_ref == StringInterner::EMPTY)
+        {
+            reportError("Empty output reference in node: " + nameOf(node_name));
+            continue;
         }
 
-        // Validate and link outputs
-        for (const auto &output_ref : node_output_refs_.at(node_name))
+        auto *tensor = symbol_table_.getTensorSymbol(output_ref);
+        if (!tensor)
         {
-            if (output_ref.empty())
+            if (!symbol_table_.insertTensorSymbol(output_ref, DataType::UNDEFINED, fixup.def))
             {
-                reportError("Empty output reference in node: " + node_name);
+                reportError("Failed to create output tensor: " + nameOf(output_ref));
                 continue;
             }
-
-            if (auto *tensor = symbol_table_.getTensorSymbol(output_ref))
-            {
-                // Check if this tensor already has a producer
-                if (tensor->getProducer() && tensor->getProducer() != node_symbol)
-                {
-                    reportError("Tensor '" + output_ref + "' is already produced by node '" +
-                                tensor->getProducer()->getName() + "', cannot be produced by '" + node_name + "'");
-                }
-                else
-                {
-                    // FIX: Actually add the output to the node and set producer
-                    node_symbol->addOutput(tensor);
-                    tensor->setProducer(node_symbol);
-                }
-            }
-            else
-            {
-                // Output tensor doesn't exist, create it
-                if (symbol_table_.insertTensorSymbol(output_ref, DataType::UNDEFINED, &node))
-                {
-                    if (auto *tensor_symbol = symbol_table_.getTensorSymbol(output_ref))
-                    {
-                        // FIX: Add the newly created tensor as output
-                        node_symbol->addOutput(tensor_symbol);
-                        tensor_symbol->setProducer(node_symbol);
-                    }
-                }
-                else
-                {
-                    reportError("Failed to create output tensor: " + output_ref);
-                }
-            }
+            tensor = symbol_table_.getTensorSymbol(output_ref);
         }
 
-        // Process attributes if any
-        if (node.getAttributeList())
+        // Check if this tensor already has a producer
+        if (tensor->getIndex() >= producers.size())
+        {
+            producers.resize(symbol_table_.getTensorSymbols().size(), nullptr);
+        }
+        auto &producer = producers[tensor->getIndex()];
+        if (producer && producer != fixup.symbol)
+        {
+            reportError("Tensor '" + nameOf(output_ref) + "' is already produced by node '" +
+                        std::string(producer->getName()) + "', cannot be produced by '" + nameOf(node_name) + "'");
+        }
+        else
         {
-            node.getAttributeList()->accept(*this);
+            producer = fixup.symbol;
+            output_tensors_[i] = tensor;
         }
     }
+}
 
-    // Validate I/O consistency
-    validateNodeIOTypeConsistency(node_name, op_type);
+void ASTSemanticVisitor::attachNodeLinks(const NodeFixup &fixup)
+{
+    auto *node_symbol = fixup.symbol;
+    if (!node_symbol)
+        return;
 
-    current_node_name_ = "";
+    for (auto i = fixup.inputs_begin; i < fixup.inputs_end; ++i)
+    {
+        if (auto *tensor = input_tensors_[i])
+        {
+            // FIX: Actually add the input to the node
+            node_symbol->addInput(tensor);
+            tensor->addUser(node_symbol);
+        }
+    }
+    for (auto i = fixup.outputs_begin; i < fixup.outputs_end; ++i)
+    {
+        if (auto *tensor = output_tensors_[i])
+        {
+            // FIX: Actually add the output to the node and set producer
+            node_symbol->addOutput(tensor);
+            tensor->setProducer(node_symbol);
+        }
+    }
 }
 
 void ASTSemanticVisitor::visit(const InputArrNode &node)
 {
-    if (should_terminate_analysis_ | !is_declaration_pass_)
+    if (should_terminate_analysis_)
         return;
 
     for (const auto &input : node.getInputElements())
     {
         if (input)
         {
-            std::string input_name = extractStringFromNode(input.get());
-            if (!input_name.empty())
+            const auto input_name = extractSymbolFromNode(input);
+            if (input_name != StringInterner::EMPTY)
             {
-                node_input_refs_.at(current_node_name_).push_back(input_name);
+                input_refs_.push_back(input_name);
             }
         }
     }
@@ -258,17 +372,17 @@ void ASTSemanticVisitor::visit(const InputArrNode &node)
 
 void ASTSemanticVisitor::visit(const OutputArrNode &node)
 {
-    if (should_terminate_analysis_ | !is_declaration_pass_)
+    if (should_terminate_analysis_)
         return;
 
     for (const auto &output : node.getOutputElements())
     {
         if (output)
         {
-            std::string output_name = extractStringFromNode(output.get());
-            if (!output_name.empty())
+            const auto output_name = extractSymbolFromNode(output);
+            if (output_name != StringInterner::EMPTY)
             {
-                node_output_refs_.at(current_node_name_).push_back(output_name);
+                output_refs_.push_back(output_name);
             }
         }
     }
@@ -283,23 +397,41 @@ void ASTSemanticVisitor::visit(const AttributeListNode &node)
     {
         if (attr)
         {
-            attr->accept(*this);
+            dispatch(*attr);
         }
     }
 }
 
-void ASTSemanticVisitor::visit(const IOTensorNode &node)
+void ASTSemanticVisitor::visit(const AttributeNode &node)
 {
     if (should_terminate_analysis_)
         return;
 
-    if (is_declaration_pass_ && !processing_node_tensors_)
+    node_attributes_.push_back({extractSymbolFromNode(node.getName()), extractSymbolFromNode(node.getValue())});
+}
+
+void ASTSemanticVisitor::visit(const IOTensorNode &node)
+{
+    if (should_terminate_analysis_)
         return;
 
-    std::string tensor_name = extractStringFromNode(node.getName());
-    DataType data_type = extractDataTypeFromNode(node.getType());
+    const auto tensor_name = extractSymbolFromNode(node.getName());
+    const auto data_type = extractDataTypeFromNode(node.getType());
+    const auto *shape_node = astCast<IOShapeNode>(node.getIOShape());
+    auto shape = convertIOShapeToString(shape_node);
+    auto dims = convertIOShapeToDims(shape_node);
+    if (processing_node_tensors_)
+    {
+        node_tensors_.push_back({tensor_name, data_type, std::move(shape), std::move(dims), &node});
+        return;
+    }
+    defineTensor(tensor_name, data_type, shape, std::move(dims), &node);
+}
 
-    if (tensor_name.empty())
+void ASTSemanticVisitor::defineTensor(SymbolId tensor_name, DataType data_type, const std::string &shape,
+                                      std::optional<Shape> dims, const ASTNode *def)
+{
+    if (tensor_name == StringInterner::EMPTY)
     {
         reportError("Empty tensor name in IOTensor");
         return;
@@ -309,7 +441,7 @@ void ASTSemanticVisitor::visit(const IOTensorNode &node)
     auto *existing_tensor = symbol_table_.getTensorSymbol(tensor_name);
     if (existing_tensor && existing_tensor->getDataType() != DataType::UNDEFINED)
     {
-        reportError("Duplicate tensor definition: '" + tensor_name + "'");
+        reportError("Duplicate tensor definition: '" + nameOf(tensor_name) + "'");
         return;
     }
 
@@ -319,9 +451,9 @@ void ASTSemanticVisitor::visit(const IOTensorNode &node)
         // Update existing placeholder with actual type
         // Note: This requires adding an update method to SymbolTable
     }
-    else if (!symbol_table_.insertTensorSymbol(tensor_name, data_type, &node))
+    else if (!symbol_table_.insertTensorSymbol(tensor_name, data_type, def))
     {
-        reportError("Failed to insert tensor: '" + tensor_name + "'");
+        reportError("Failed to insert tensor: '" + nameOf(tensor_name) + "'");
         return;
     }
 
@@ -330,8 +462,8 @@ void ASTSemanticVisitor::visit(const IOTensorNode &node)
     // Store shape string for TACode generation
     if (auto *tensor_sym = symbol_table_.getTensorSymbol(tensor_name))
     {
-        std::string shape_str = convertIOShapeToString(dynamic_cast<const IOShapeNode *>(node.getIOShape()));
-        tensor_sym->setShapeString(shape_str);
+        tensor_sym->setShapeString(shape);
+        tensor_sym->setShape(std::move(dims));
 
         if (processing_model_inputs_)
         {
@@ -351,13 +483,21 @@ void ASTSemanticVisitor::visit(const InitTensorNode &node)
     if (should_terminate_analysis_)
         return;
 
-    if (is_declaration_pass_)
-        return;
-
-    std::string tensor_name = extractStringFromNode(node.getName());
-    DataType data_type = extractDataTypeFromNode(node.getType());
+    std::optional<std::string_view> raw_data;
+    if (const auto *bytes_node = astCast<BytesLiteralNode>(node.getRawData()))
+    {
+        raw_data = bytes_node->getHexDigits();
+    }
+    const auto *shape_node = astCast<InitShapeNode>(node.getInitShape());
+    defineInitializer(extractSymbolFromNode(node.getName()), extractDataTypeFromNode(node.getType()),
+                      convertInitShapeToString(shape_node), convertInitShapeToDims(shape_node), raw_data, &node);
+}
 
-    if (tensor_name.empty())
+void ASTSemanticVisitor::defineInitializer(SymbolId tensor_name, DataType data_type, const std::string &shape,
+                                           std::vector<uint64_t> dims, std::optional<std::string_view> raw_data,
+                                           const ASTNode *def)
+{
+    if (tensor_name == StringInterner::EMPTY)
     {
         reportError("Empty tensor name in InitTensor");
         return;
@@ -365,13 +505,13 @@ void ASTSemanticVisitor::visit(const InitTensorNode &node)
 
     if (initializer_defined_.find(tensor_name) != initializer_defined_.end())
     {
-        reportError("Duplicate initializer: '" + tensor_name + "'");
+        reportError("Duplicate initializer: '" + nameOf(tensor_name) + "'");
         return;
     }
 
-    if (!symbol_table_.insertTensorSymbol(tensor_name, data_type, &node))
+    if (!symbol_table_.insertTensorSymbol(tensor_name, data_type, def))
     {
-        reportError("Failed to insert initializer: '" + tensor_name + "'");
+        reportError("Failed to insert initializer: '" + nameOf(tensor_name) + "'");
     }
     else
     {
@@ -382,38 +522,175 @@ void ASTSemanticVisitor::visit(const InitTensorNode &node)
         {
             tensor_sym->setIsInitializer(true);
 
-            // Convert and store shape
-            std::string shape_str = convertInitShapeToString(dynamic_cast<const InitShapeNode *>(node.getInitShape()));
-            tensor_sym->setShapeString(shape_str);
+            tensor_sym->setShapeString(shape);
+            tensor_sym->setDims(std::move(dims));
 
-            // Convert and store raw data as hex
-            if (auto *bytes_node = dynamic_cast<const BytesLiteralNode *>(node.getRawData()))
+            // Validate the raw data once; TAC generation writes the source digits through unchanged
+            if (raw_data)
             {
-                std::string hex_str = convertBytesToHexString(bytes_node);
-                tensor_sym->setRawDataHex(hex_str);
+                const auto hex_digits = *raw_data;
+                bool has_upper_case = false;
+                const auto checked = HexCodec::validate(hex_digits, has_upper_case);
+                if (checked != hex_digits.size())
+                {
+                    reportError("Invalid raw data in initializer '" + nameOf(tensor_name) +
+                                "': invalid hex digit at offset " + std::to_string(checked));
+                    return;
+                }
+                tensor_sym->setRawData(hex_digits, has_upper_case);
             }
         }
     }
 }
 
+void ASTSemanticVisitor::analyze(const FlatAST &ast)
+{
+    const auto model = ast.getRoot();
+    if (should_terminate_analysis_ || ast.getKind(model) != NodeType::MODEL)
+        return;
+
+    // Same ordering as visit(const ModelNode &)
+    analyzeFlatNodes(ast, ast.getChild(model, FlatAST::MODEL_NODE_LIST));
+
+    processing_initializers_ = true;
+    analyzeFlatTensors(ast, ast.getChild(model, FlatAST::MODEL_INITIALIZER_LIST));
+    processing_initializers_ = false;
+
+    processing_model_inputs_ = true;
+    analyzeFlatTensors(ast, ast.getChild(model, FlatAST::MODEL_INPUT_LIST));
+    processing_model_inputs_ = false;
+
+    processing_model_outputs_ = true;
+    analyzeFlatTensors(ast, ast.getChild(model, FlatAST::MODEL_OUTPUT_LIST));
+    processing_model_outputs_ = false;
+
+    resolveNodeFixups();
+
+    performSemanticAnalysis();
+}
+
+void ASTSemanticVisitor::analyzeFlatNodes(const FlatAST &ast, FlatAST::Index node_list)
+{
+    if (should_terminate_analysis_ || ast.getKind(node_list) != NodeType::NODE_LIST)
+        return;
+
+    for (const auto node : ast.getChildren(node_list))
+    {
+        if (should_terminate_analysis_ || ast.getKind(node) != NodeType::NODE)
+            continue;
+
+        const auto node_name = flatSymbol(ast, ast.getChild(node, FlatAST::NODE_NAME));
+        const auto op_type = flatSymbol(ast, ast.getChild(node, FlatAST::NODE_OP_TYPE));
+        if (!beginNode(node_name))
+            continue;
+
+        processing_node_tensors_ = true;
+        analyzeFlatNodeIO(ast, ast.getChild(node, FlatAST::NODE_INPUT), input_refs_);
+        analyzeFlatNodeIO(ast, ast.getChild(node, FlatAST::NODE_OUTPUT), output_refs_);
+        processing_node_tensors_ = false;
+        analyzeFlatAttributes(ast, ast.getChild(node, FlatAST::NODE_ATTRIBUTE_LIST));
+
+        finishNode(node_name, op_type, nullptr);
+    }
+}
+
+void ASTSemanticVisitor::analyzeFlatNodeIO(const FlatAST &ast, FlatAST::Index io, std::vector<SymbolId> &refs)
+{
+    const auto kind = ast.getKind(io);
+    if (kind == NodeType::INPUT_LIST || kind == NodeType::OUTPUT_LIST)
+    {
+        analyzeFlatTensors(ast, io);
+        return;
+    }
+    if (should_terminate_analysis_ || (kind != NodeType::INPUT_ARR && kind != NodeType::OUTPUT_ARR))
+        return;
+
+    for (const auto element : ast.getChildren(io))
+    {
+        const auto name = flatSymbol(ast, element);
+        if (name != StringInterner::EMPTY)
+        {
+            refs.push_back(name);
+        }
+    }
+}
+
+void ASTSemanticVisitor::analyzeFlatTensors(const FlatAST &ast, FlatAST::Index tensor_list)
+{
+    if (should_terminate_analysis_)
+        return;
+
+    for (const auto tensor : ast.getChildren(tensor_list))
+    {
+        if (should_terminate_analysis_)
+            return;
+
+        const auto name = flatSymbol(ast, ast.getChild(tensor, FlatAST::TENSOR_NAME));
+        const auto type_node = ast.getChild(tensor, FlatAST::TENSOR_TYPE);
+        const auto data_type =
+            ast.getKind(type_node) == NodeType::TYPE_ENUM ? ast.getDataType(type_node) : DataType::UNDEFINED;
+        const auto shape = ast.getChild(tensor, FlatAST::TENSOR_SHAPE);
+
+        if (ast.getKind(tensor) == NodeType::IO_TENSOR)
+        {
+            auto shape_string = convertFlatShapeToString(ast, shape, NodeType::IO_SHAPE);
+            auto dims = convertFlatIOShapeToDims(ast, shape);
+            if (processing_node_tensors_)
+            {
+                node_tensors_.push_back({name, data_type, std::move(shape_string), std::move(dims), nullptr});
+            }
+            else
+            {
+                defineTensor(name, data_type, shape_string, std::move(dims), nullptr);
+            }
+        }
+        else if (ast.getKind(tensor) == NodeType::INIT_TENSOR)
+        {
+            std::optional<std::string_view> raw_data;
+            const auto bytes = ast.getChild(tensor, FlatAST::TENSOR_RAW_DATA);
+            if (ast.getKind(bytes) == NodeType::BYTES_LITERAL)
+            {
+                raw_data = ast.getHexDigits(bytes);
+            }
+            defineInitializer(name, data_type, convertFlatShapeToString(ast, shape, NodeType::INIT_SHAPE),
+                              convertFlatInitShapeToDims(ast, shape), raw_data, nullptr);
+        }
+    }
+}
+
+void ASTSemanticVisitor::analyzeFlatAttributes(const FlatAST &ast, FlatAST::Index attribute_list)
+{
+    if (should_terminate_analysis_ || ast.getKind(attribute_list) != NodeType::ATTRIBUTE_LIST)
+        return;
+
+    for (const auto attribute : ast.getChildren(attribute_list))
+    {
+        if (ast.getKind(attribute) == NodeType::ATTRIBUTE)
+        {
+            node_attributes_.push_back({flatSymbol(ast, ast.getChild(attribute, FlatAST::ATTRIBUTE_NAME)),
+                                        flatSymbol(ast, ast.getChild(attribute, FlatAST::ATTRIBUTE_VALUE))});
+        }
+    }
+}
+
 void ASTSemanticVisitor::performSemanticAnalysis()
 {
     // Check that all pre-declared tensors were eventually defined
-    for (const auto &tensor_name : pre_declared_tensors_)
+    for (const auto tensor_name : pre_declared_tensors_)
     {
         if (defined_tensors_.find(tensor_name) == defined_tensors_.end() &&
             initializer_defined_.find(tensor_name) == initializer_defined_.end())
         {
-            reportError("Tensor '" + tensor_name + "' was declared but never defined");
+            reportError("Tensor '" + nameOf(tensor_name) + "' was declared but never defined");
         }
     }
 
     // Validate model outputs exist
-    for (const auto &output_name : model_output_names_)
+    for (const auto output_name : model_output_names_)
     {
         if (symbol_table_.getTensorSymbol(output_name) == nullptr)
         {
-            reportError("Model output tensor not found: '" + output_name + "'");
+            reportError("Model output tensor not found: '" + nameOf(output_name) + "'");
         }
     }
 
@@ -425,13 +702,15 @@ void ASTSemanticVisitor::performSemanticAnalysis()
 
     if (symbol_table_.hasCycle())
     {
-        reportError("Cycle detected in computation graph");
+        // Name the nodes on the cycle, in source order
+        std::string names;
+        for (const auto *node : symbol_table_.getCycle())
+        {
+            names += names.empty() ? "" : ", ";
+            names += node->getName();
+        }
+        reportError("Cycle detected in computation graph between nodes: " + names);
     }
-
-    // Run optimization detection
-    symbol_table_.detectConstantFolding();
-    symbol_table_.detectDeadCode();
-    symbol_table_.detectCommonSubexpressions();
 }
 
 void ASTSemanticVisitor::reportError(const std::string &message, bool terminate)
@@ -443,16 +722,28 @@ void ASTSemanticVisitor::reportError(const std::string &message, bool terminate)
     }
 }
 
-std::string ASTSemanticVisitor::extractStringFromNode(const ASTNode *node)
+SymbolId ASTSemanticVisitor::extractSymbolFromNode(const ASTNode *node)
 {
     if (!node)
-        return "";
+        return StringInterner::EMPTY;
 
-    if (auto *str_node = dynamic_cast<const StrLiteralNode *>(node))
+    if (auto *str_node = astCast<StrLiteralNode>(node))
+    {
+        return str_node->getId();
+    }
+    return StringInterner::EMPTY;
+}
+
+std::string_view ASTSemanticVisitor::extractStringFromNode(const ASTNode *node)
+{
+    if (!node)
+        return {};
+
+    if (auto *str_node = astCast<StrLiteralNode>(node))
     {
         return str_node->getValue();
     }
-    return "";
+    return {};
 }
 
 DataType ASTSemanticVisitor::extractDataTypeFromNode(const ASTNode *node)
@@ -460,7 +751,7 @@ DataType ASTSemanticVisitor::extractDataTypeFromNode(const ASTNode *node)
     if (!node)
         return DataType::UNDEFINED;
 
-    if (auto *type_node = dynamic_cast<const TypeEnumNode *>(node))
+    if (auto *type_node = astCast<TypeEnumNode>(node))
     {
         return type_node->getValue();
     }
@@ -524,7 +815,7 @@ std::string ASTSemanticVisitor::convertIOShapeToString(const IOShapeNode *shape_
         return "[]";
 
     std::string result = "[";
-    const auto &dims = shape_node->getIODims();
+    const auto dims = shape_node->getIODims();
 
     for (size_t i = 0; i < dims.size(); ++i)
     {
@@ -533,18 +824,20 @@ std::string ASTSemanticVisitor::convertIOShapeToString(const IOShapeNode *shape_
 
         if (dims[i]->getASTNodeType() == NodeType::U32_LITERAL)
         {
-            auto *u32_node = dynamic_cast<const U32LiteralNode *>(dims[i].get());
+            auto *u32_node = static_cast<const U32LiteralNode *>(dims[i]);
             result += std::to_string(u32_node->getValue());
         }
         else if (dims[i]->getASTNodeType() == NodeType::U64_LITERAL)
         {
-            auto *u64_node = dynamic_cast<const U64LiteralNode *>(dims[i].get());
+            auto *u64_node = static_cast<const U64LiteralNode *>(dims[i]);
             result += std::to_string(u64_node->getValue());
         }
         else if (dims[i]->getASTNodeType() == NodeType::STR_LITERAL)
         {
-            auto *str_node = dynamic_cast<const StrLiteralNode *>(dims[i].get());
-            result += "\"" + str_node->getValue() + "\"";
+            auto *str_node = static_cast<const StrLiteralNode *>(dims[i]);
+            result += '"';
+            result += str_node->getValue();
+            result += '"';
         }
     }
 
@@ -558,7 +851,7 @@ std::string ASTSemanticVisitor::convertInitShapeToString(const InitShapeNode *sh
         return "[]";
 
     std::string result = "[";
-    const auto &dims = shape_node->getDimValues();
+    const auto dims = shape_node->getDimValues();
 
     for (size_t i = 0; i < dims.size(); ++i)
     {
@@ -567,12 +860,12 @@ std::string ASTSemanticVisitor::convertInitShapeToString(const InitShapeNode *sh
 
         if (dims[i]->getASTNodeType() == NodeType::U32_LITERAL)
         {
-            auto *u32_node = dynamic_cast<const U32LiteralNode *>(dims[i].get());
+            auto *u32_node = static_cast<const U32LiteralNode *>(dims[i]);
             result += std::to_string(u32_node->getValue());
         }
         else if (dims[i]->getASTNodeType() == NodeType::U64_LITERAL)
         {
-            auto *u64_node = dynamic_cast<const U64LiteralNode *>(dims[i].get());
+            auto *u64_node = static_cast<const U64LiteralNode *>(dims[i]);
             result += std::to_string(u64_node->getValue());
         }
     }
@@ -582,21 +875,128 @@ std::string ASTSemanticVisitor::convertInitShapeToString(const InitShapeNode *sh
     return result;
 }
 
-std::string ASTSemanticVisitor::convertBytesToHexString(const BytesLiteralNode *bytes_node)
+// An absent shape leaves the rank unknown; a dim_param becomes a symbolic dimension
+std::optional<Shape> ASTSemanticVisitor::convertIOShapeToDims(const IOShapeNode *shape_node)
 {
-    if (!bytes_node)
-        return "0x";
+    if (!shape_node)
+        return std::nullopt;
 
-    std::stringstream ss;
-    ss << "0x";
+    Shape result;
+    for (const auto *dim : shape_node->getIODims())
+    {
+        if (dim->getASTNodeType() == NodeType::U32_LITERAL)
+        {
+            result.push_back(ShapeDim::of(static_cast<const U32LiteralNode *>(dim)->getValue()));
+        }
+        else if (dim->getASTNodeType() == NodeType::U64_LITERAL)
+        {
+            result.push_back(ShapeDim::of(static_cast<const U64LiteralNode *>(dim)->getValue()));
+        }
+        else
+        {
+            const auto param = extractSymbolFromNode(dim);
+            result.push_back(param != StringInterner::EMPTY ? ShapeDim::named(param) : ShapeDim::unknown());
+        }
+    }
+    return result;
+}
+
+std::vector<uint64_t> ASTSemanticVisitor::convertInitShapeToDims(const InitShapeNode *shape_node)
+{
+    std::vector<uint64_t> result;
+    if (!shape_node)
+        return result;
 
-    const auto &bytes = bytes_node->getValue();
-    for (uint8_t byte : bytes)
+    for (const auto *dim : shape_node->getDimValues())
     {
-        ss << std::hex << std::setfill('0') << std::setw(2) << static_cast<int>(byte);
+        if (dim->getASTNodeType() == NodeType::U32_LITERAL)
+        {
+            result.push_back(static_cast<const U32LiteralNode *>(dim)->getValue());
+        }
+        else if (dim->getASTNodeType() == NodeType::U64_LITERAL)
+        {
+            result.push_back(static_cast<const U64LiteralNode *>(dim)->getValue());
+        }
     }
+    return result;
+}
 
-    return ss.str();
+SymbolId ASTSemanticVisitor::flatSymbol(const FlatAST &ast, FlatAST::Index node)
+{
+    return ast.getKind(node) == NodeType::STR_LITERAL ? ast.getSymbol(node) : StringInterner::EMPTY;
+}
+
+// Matches convertIOShapeToString for IO_SHAPE and convertInitShapeToString for INIT_SHAPE, which drops dim_params
+std::string ASTSemanticVisitor::convertFlatShapeToString(const FlatAST &ast, FlatAST::Index shape,
+                                                         NodeType shape_kind) const
+{
+    if (ast.getKind(shape) != shape_kind)
+        return "[]";
+
+    std::string result = "[";
+    const auto dims = ast.getChildren(shape);
+
+    for (size_t i = 0; i < dims.size(); ++i)
+    {
+        if (i > 0)
+            result += ", ";
+
+        const auto kind = ast.getKind(dims[i]);
+        if (kind == NodeType::U32_LITERAL || kind == NodeType::U64_LITERAL)
+        {
+            result += std::to_string(ast.getInteger(dims[i]));
+        }
+        else if (kind == NodeType::STR_LITERAL && shape_kind == NodeType::IO_SHAPE)
+        {
+            result += '"';
+            result += names_.view(ast.getSymbol(dims[i]));
+            result += '"';
+        }
+    }
+
+    result += "]";
+    return result;
+}
+
+// Matches convertIOShapeToDims
+std::optional<Shape> ASTSemanticVisitor::convertFlatIOShapeToDims(const FlatAST &ast, FlatAST::Index shape)
+{
+    if (ast.getKind(shape) != NodeType::IO_SHAPE)
+        return std::nullopt;
+
+    Shape result;
+    for (const auto dim : ast.getChildren(shape))
+    {
+        const auto kind = ast.getKind(dim);
+        if (kind == NodeType::U32_LITERAL || kind == NodeType::U64_LITERAL)
+        {
+            result.push_back(ShapeDim::of(ast.getInteger(dim)));
+        }
+        else
+        {
+            const auto param = flatSymbol(ast, dim);
+            result.push_back(param != StringInterner::EMPTY ? ShapeDim::named(param) : ShapeDim::unknown());
+        }
+    }
+    return result;
+}
+
+// Matches convertInitShapeToDims
+std::vector<uint64_t> ASTSemanticVisitor::convertFlatInitShapeToDims(const FlatAST &ast, FlatAST::Index shape)
+{
+    std::vector<uint64_t> result;
+    if (ast.getKind(shape) != NodeType::INIT_SHAPE)
+        return result;
+
+    for (const auto dim : ast.getChildren(shape))
+    {
+        const auto kind = ast.getKind(dim);
+        if (kind == NodeType::U32_LITERAL || kind == NodeType::U64_LITERAL)
+        {
+            result.push_back(ast.getInteger(dim));
+        }
+    }
+    return result;
 }
 
 std::string ASTSemanticVisitor::convertAttributesToString(const AttributeListNode *attr_list)
@@ -605,30 +1005,33 @@ std::string ASTSemanticVisitor::convertAttributesToString(const AttributeListNod
         return "";
 
     std::string result;
-    const auto &attrs = attr_list->getAttributes();
+    const auto attrs = attr_list->getAttributes();
 
     for (size_t i = 0; i < attrs.size(); ++i)
     {
         if (i > 0)
             result += ", ";
 
-        if (auto *attr = dynamic_cast<const AttributeNode *>(attrs[i].get()))
+        if (auto *attr = astCast<AttributeNode>(attrs[i]))
         {
-            std::string name = extractStringFromNode(attr->getName());
-            std::string value = extractStringFromNode(attr->getValue());
-            result += name + "=" + value;
+            result += extractStringFromNode(attr->getName());
+            result += '=';
+            result += extractStringFromNode(attr->getValue());
         }
     }
 
     return result;
 }
 
-void ASTSemanticVisitor::validateNodeIOTypeConsistency(const std::string &node_name, const std::string &op_type)
+std::string ASTSemanticVisitor::checkNodeIOTypeConsistency(const NodeFixup &fixup) const
 {
+    const auto node_name = fixup.name;
+    const auto op_type = fixup.op_type;
 #ifdef DEBUG_IO_CONSISTENCY
-    std::cout << "DEBUG: validateNodeIOTypeConsistency - Node: " << node_name << ", op_type: " << op_type << std::endl;
-    std::cout << "DEBUG: Input refs count: " << node_input_refs_.size() << std::endl;
-    std::cout << "DEBUG: Output refs count: " << node_output_refs_.size() << std::endl;
+    std::cout << "DEBUG: checkNodeIOTypeConsistency - Node: " << names_.view(node_name)
+              << ", op_type: " << names_.view(op_type) << std::endl;
+    std::cout << "DEBUG: Input refs count: " << fixup.inputs_end - fixup.inputs_begin << std::endl;
+    std::cout << "DEBUG: Output refs count: " << fixup.outputs_end - fixup.outputs_begin << std::endl;
 #endif
 
     // Collect all tensor types from inputs and outputs
@@ -640,13 +1043,14 @@ void ASTSemanticVisitor::validateNodeIOTypeConsistency(const std::string &node_n
 #endif
 
     // Check input types
-    for (const auto &input_ref : node_input_refs_.at(node_name))
+    for (auto i = fixup.inputs_begin; i < fixup.inputs_end; ++i)
     {
-        if (auto *tensor = symbol_table_.getTensorSymbol(input_ref))
+        const auto input_ref = input_refs_[i];
+        if (const auto *tensor = tensorAt(input_ref, fixup.tensor_count))
         {
 #ifdef DEBUG_IO_CONSISTENCY
-            std::cout << "DEBUG: Input tensor '" << input_ref << "' type: " << static_cast<int>(tensor->getDataType())
-                      << std::endl;
+            std::cout << "DEBUG: Input tensor '" << names_.view(input_ref)
+                      << "' type: " << static_cast<int>(tensor->getDataType()) << std::endl;
 #endif
             if (!type_set)
             {
@@ -662,9 +1066,8 @@ void ASTSemanticVisitor::validateNodeIOTypeConsistency(const std::string &node_n
                 std::cout << "DEBUG: Type mismatch detected - expected: " << static_cast<int>(node_type)
                           << ", found: " << static_cast<int>(tensor->getDataType()) << std::endl;
 #endif
-                reportError("Type mismatch in node '" + node_name + "' (op_type: " + op_type + "): input tensor '" +
-                            input_ref + "' has different type than other tensors in this node");
-                return;
+                return "Type mismatch in node '" + nameOf(node_name) + "' (op_type: " + nameOf(op_type) +
+                       "): input tensor '" + nameOf(input_ref) + "' has different type than other tensors in this node";
             }
         }
     }
@@ -674,13 +1077,14 @@ void ASTSemanticVisitor::validateNodeIOTypeConsistency(const std::string &node_n
 #endif
 
     // Check output types
-    for (const auto &output_ref : node_output_refs_.at(node_name))
+    for (auto i = fixup.outputs_begin; i < fixup.outputs_end; ++i)
     {
-        if (auto *tensor = symbol_table_.getTensorSymbol(output_ref))
+        const auto output_ref = output_refs_[i];
+        if (const auto *tensor = tensorAt(output_ref, fixup.tensor_count))
         {
 #ifdef DEBUG_IO_CONSISTENCY
-            std::cout << "DEBUG: Output tensor '" << output_ref << "' type: " << static_cast<int>(tensor->getDataType())
-                      << std::endl;
+            std::cout << "DEBUG: Output tensor '" << names_.view(output_ref)
+                      << "' type: " << static_cast<int>(tensor->getDataType()) << std::endl;
 #endif
             if (!type_set)
             {
@@ -696,16 +1100,17 @@ void ASTSemanticVisitor::validateNodeIOTypeConsistency(const std::string &node_n
                 std::cout << "DEBUG: Type mismatch detected - expected: " << static_cast<int>(node_type)
                           << ", found: " << static_cast<int>(tensor->getDataType()) << std::endl;
 #endif
-                reportError("Type mismatch in node '" + node_name + "' (op_type: " + op_type + "): output tensor '" +
-                            output_ref + "' has different type than other tensors in this node");
-                return;
+                return "Type mismatch in node '" + nameOf(node_name) + "' (op_type: " + nameOf(op_type) +
+                       "): output tensor '" + nameOf(output_ref) +
+                       "' has different type than other tensors in this node";
             }
         }
     }
 
 #ifdef DEBUG_IO_CONSISTENCY
-    std::cout << "DEBUG: Type consistency check passed for node: " << node_name << std::endl;
+    std::cout << "DEBUG: Type consistency check passed for node: " << names_.view(node_name) << std::endl;
 #endif
+    return {};
 }
 
 } // namespace sonnx
@@ -1,65 +1,72 @@
 #ifndef AST_SEMANTIC_VISITOR_HPP
 #define AST_SEMANTIC_VISITOR_HPP
 
-#include "ASTBaseVisitor.hpp"
+#include "ASTStaticVisitor.hpp"
+#include "ast/FlatAST.hpp"
 #include "utils/SymbolTable.hpp"
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace sonnx
 {
 
-class ASTSemanticVisitor final : public ASTBaseVisitor
+class ASTSemanticVisitor final : public ASTStaticVisitor<ASTSemanticVisitor>
 {
   public:
-    ASTSemanticVisitor()
-        : processing_model_inputs_(false), processing_model_outputs_(false), processing_initializers_(false),
-          is_declaration_pass_(false), processing_node_tensors_(false), should_terminate_analysis_(false)
+    // Names in the AST are ids in names, which must outlive the visitor. jobs bounds the threads that check
+    // nodes once they are linked; diagnostics do not depend on it.
+    explicit ASTSemanticVisitor(const StringInterner &names, unsigned jobs = 1)
+        : symbol_table_(names), names_(names), jobs_(jobs), processing_model_inputs_(false),
+          processing_model_outputs_(false), processing_initializers_(false), processing_node_tensors_(false),
+          should_terminate_analysis_(false)
     {
     }
 
-    ~ASTSemanticVisitor() override = default;
+    // Analyzes the structure-of-arrays form; same checks, diagnostics and symbol table as visiting the tree,
+    // except that symbols carry no definition node
+    void analyze(const FlatAST &ast);
 
     // Main visiting methods
-    void visit(const ModelNode &node) override;
-    void visit(const NodeListNode &node) override;
-    void visit(const InputListNode &node) override;
-    void visit(const OutputListNode &node) override;
-    void visit(const InitializerListNode &node) override;
-    void visit(const NodeNode &node) override;
-    void visit(const InputArrNode &node) override;
-    void visit(const OutputArrNode &node) override;
-    void visit(const AttributeListNode &node) override;
-    void visit(const IOTensorNode &node) override;
-    void visit(const InitTensorNode &node) override;
-
-    // Other required visit methods (from base class)
-    void visit(const U32LiteralNode &node) override
+    void visit(const ModelNode &node);
+    void visit(const NodeListNode &node);
+    void visit(const InputListNode &node);
+    void visit(const OutputListNode &node);
+    void visit(const InitializerListNode &node);
+    void visit(const NodeNode &node);
+    void visit(const InputArrNode &node);
+    void visit(const OutputArrNode &node);
+    void visit(const AttributeListNode &node);
+    void visit(const AttributeNode &node);
+    void visit(const IOTensorNode &node);
+    void visit(const InitTensorNode &node);
+
+    // Node classes this pass does not look into
+    void visit(const U32LiteralNode &node)
     {
     }
-    void visit(const U64LiteralNode &node) override
+    void visit(const U64LiteralNode &node)
     {
     }
-    void visit(const StrLiteralNode &node) override
+    void visit(const StrLiteralNode &node)
     {
     }
-    void visit(const BytesLiteralNode &node) override
+    void visit(const BytesLiteralNode &node)
     {
     }
-    void visit(const TypeEnumNode &node) override
+    void visit(const TypeEnumNode &node)
     {
     }
-    void visit(const AttributeNode &node) override
+    void visit(const IOShapeNode &node)
     {
     }
-    void visit(const IOShapeNode &node) override
+    void visit(const InitShapeNode &node)
     {
     }
-    void visit(const InitShapeNode &node) override
-    {
-    }
-    void visit(const ErrorNode &node) override
+    void visit(const ErrorNode &node)
     {
     }
 
@@ -84,6 +91,10 @@ class ASTSemanticVisitor final : public ASTBaseVisitor
   private:
     // Symbol table
     SymbolTable symbol_table_;
+    const StringInterner &names_;
+    unsigned jobs_;
+    // Node checks are split across workers from this many nodes on
+    static constexpr size_t PARALLEL_NODE_COUNT = 16 * 1024;
 
     // Error tracking
     std::vector<std::string> errors_;
@@ -92,39 +103,100 @@ class ASTSemanticVisitor final : public ASTBaseVisitor
     bool processing_model_inputs_;
     bool processing_model_outputs_;
     bool processing_initializers_;
-    bool is_declaration_pass_;
+    // Set while inside a node's own input or output list, whose tensors are defined by resolveNodeFixups()
     bool processing_node_tensors_;
     bool should_terminate_analysis_;
 
     // Tracking sets
-    std::unordered_set<std::string> defined_tensors_;
-    std::unordered_set<std::string> model_input_names_;
-    std::unordered_set<std::string> model_output_names_;
-    std::unordered_set<std::string> initializer_defined_;
-    std::unordered_map<std::string, std::string> output_tensor_producers_;
+    std::unordered_set<SymbolId> defined_tensors_;
+    std::unordered_set<SymbolId> model_input_names_;
+    std::unordered_set<SymbolId> model_output_names_;
+    std::unordered_set<SymbolId> initializer_defined_;
+    std::unordered_map<SymbolId, SymbolId> output_tensor_producers_;
 
     // FIX: Add pre-declared tensor tracking
-    std::unordered_set<std::string> pre_declared_tensors_;
+    std::unordered_set<SymbolId> pre_declared_tensors_;
 
-    // Temporary storage for current node
-    std::string current_node_name_;
-    std::unordered_map<std::string, std::vector<std::string>> node_input_refs_;
-    std::unordered_map<std::string, std::vector<std::string>> node_output_refs_;
+    // A tensor defined in a node's own input or output list
+    struct TensorFixup
+    {
+        SymbolId name;
+        DataType data_type;
+        std::string shape;
+        std::optional<Shape> dims;
+        const ASTNode *def;
+    };
+    // A node registered while walking the node list. Its references may name tensors that are only defined by
+    // the model's tensor lists, which come later, so they are resolved after those; ranges index the arrays below.
+    struct NodeFixup
+    {
+        SymbolId name;
+        SymbolId op_type;
+        const ASTNode *def;
+        uint32_t inputs_begin, inputs_end;
+        uint32_t outputs_begin, outputs_end;
+        uint32_t tensors_begin, tensors_end;
+        // Set while linking: the node's symbol, and how many tensors existed once it was linked
+        NodeSymbol *symbol;
+        uint32_t tensor_count;
+    };
+    std::vector<NodeFixup> node_fixups_;
+    std::vector<SymbolId> input_refs_;
+    std::vector<SymbolId> output_refs_;
+    std::vector<TensorFixup> node_tensors_;
+    // What each reference resolved to, parallel to input_refs_ and output_refs_; nullptr where it did not
+    std::vector<TensorSymbol *> input_tensors_;
+    std::vector<TensorSymbol *> output_tensors_;
+    // Attributes of the node being visited, recorded on its symbol by finishNode()
+    std::vector<NodeSymbol::Attribute> node_attributes_;
+
+    // Representation-neutral core shared by the tree visitor and analyze(const FlatAST &)
+    void defineTensor(SymbolId tensor_name, DataType data_type, const std::string &shape, std::optional<Shape> dims,
+                      const ASTNode *def);
+    void defineInitializer(SymbolId tensor_name, DataType data_type, const std::string &shape,
+                           std::vector<uint64_t> dims, std::optional<std::string_view> raw_data, const ASTNode *def);
+    bool beginNode(SymbolId node_name);
+    void finishNode(SymbolId node_name, SymbolId op_type, const ASTNode *def);
+    void resolveNodeFixups();
+    void resolveNodeLinks(NodeFixup &fixup, std::vector<const NodeSymbol *> &producers);
+    void attachNodeLinks(const NodeFixup &fixup);
+
+    // Flat front end
+    void analyzeFlatNodes(const FlatAST &ast, FlatAST::Index node_list);
+    void analyzeFlatNodeIO(const FlatAST &ast, FlatAST::Index io, std::vector<SymbolId> &refs);
+    void analyzeFlatTensors(const FlatAST &ast, FlatAST::Index tensor_list);
+    void analyzeFlatAttributes(const FlatAST &ast, FlatAST::Index attribute_list);
+    static SymbolId flatSymbol(const FlatAST &ast, FlatAST::Index node);
+    std::string convertFlatShapeToString(const FlatAST &ast, FlatAST::Index shape, NodeType shape_kind) const;
+    static std::vector<uint64_t> convertFlatInitShapeToDims(const FlatAST &ast, FlatAST::Index shape);
+    static std::optional<Shape> convertFlatIOShapeToDims(const FlatAST &ast, FlatAST::Index shape);
 
     // Helper methods
     void reportError(const std::string &message, bool terminate = true);
     void performSemanticAnalysis();
-    static std::string extractStringFromNode(const ASTNode *node);
+    std::string nameOf(SymbolId id) const
+    {
+        return std::string(names_.view(id));
+    }
+    static SymbolId extractSymbolFromNode(const ASTNode *node);
+    static std::string_view extractStringFromNode(const ASTNode *node);
     static DataType extractDataTypeFromNode(const ASTNode *node);
 
     // Helper methods for TACode generation
     static std::string convertIOShapeToString(const IOShapeNode *shape_node);
+    static std::optional<Shape> convertIOShapeToDims(const IOShapeNode *shape_node);
     static std::string convertInitShapeToString(const InitShapeNode *shape_node);
-    static std::string convertBytesToHexString(const BytesLiteralNode *bytes_node);
+    static std::vector<uint64_t> convertInitShapeToDims(const InitShapeNode *shape_node);
     static std::string convertAttributesToString(const AttributeListNode *attr_list);
 
-    // Type consistency check
-    void validateNodeIOTypeConsistency(const std::string &node_name, const std::string &op_type);
+    // Type consistency check; returns the error, or an empty string. Reads the table only, as it stood once the
+    // node was linked, so nodes can be checked concurrently.
+    std::string checkNodeIOTypeConsistency(const NodeFixup &fixup) const;
+    const TensorSymbol *tensorAt(SymbolId name, uint32_t tensor_count) const
+    {
+        const auto *tensor = symbol_table_.getTensorSymbol(name);
+        return tensor && tensor->getIndex() < tensor_count ? tensor : nullptr;
+    }
 };
 
 } // namespace sonnx
@@ -0,0 +1,40 @@
+#ifndef AST_STATIC_VISITOR_HPP
+#define AST_STATIC_VISITOR_HPP
+
+#include "ast/AST.hpp"
+#include <stdexcept>
+
+namespace sonnx
+{
+
+// Compile-time counterpart of ASTBaseVisitor. Derived declares visit(const XNode &) for every node class in
+// SONNX_AST_NODE_CLASSES, and dispatch() selects the overload with a switch on the node's tag, so a visit is a
+// direct (and inlinable) call instead of accept() plus a virtual visit(). accept()/ASTBaseVisitor remain for
+// visitors that are only known at run time.
+template <typename Derived> class ASTStaticVisitor
+{
+  public:
+    void dispatch(const ASTNode &node)
+    {
+        auto &self = static_cast<Derived &>(*this);
+        switch (node.getASTNodeType())
+        {
+#define SONNX_DISPATCH_CASE(TAG, CLASS)                                                                                \
+    case NodeType::TAG:                                                                                                \
+        self.visit(static_cast<const CLASS &>(node));                                                                  \
+        return;
+            SONNX_AST_NODE_CLASSES(SONNX_DISPATCH_CASE)
+#undef SONNX_DISPATCH_CASE
+        default:
+            throw std::logic_error("AST node with a tag that has no node class");
+        }
+    }
+
+  protected:
+    ASTStaticVisitor() = default;
+    ~ASTStaticVisitor() = default;
+};
+
+} // namespace sonnx
+
+#endif // AST_STATIC_VISITOR_HPP